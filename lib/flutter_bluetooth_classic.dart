@@ -15,6 +15,15 @@ class FlutterBluetoothClassic {
   final _dataStreamController = StreamController<BluetoothData>.broadcast();
   final _discoveredDevicesController =
       StreamController<BluetoothDevice>.broadcast();
+  final _batchedDevicesController =
+      StreamController<List<BluetoothDevice>>.broadcast();
+  final _updatedDevicesController =
+      StreamController<BluetoothDevice>.broadcast();
+  final _lostDevicesController = StreamController<BluetoothDevice>.broadcast();
+  final _flowControlController =
+      StreamController<BluetoothFlowControlEvent>.broadcast();
+  final _pairedDevicesController =
+      StreamController<BluetoothPairedDevicesUpdate>.broadcast();
 
   // Public streams that can be subscribed to
   Stream<BluetoothState> get onStateChanged => _stateStreamController.stream;
@@ -24,6 +33,28 @@ class FlutterBluetoothClassic {
   Stream<BluetoothDevice> get onDeviceDiscovered =>
       _discoveredDevicesController.stream;
 
+  /// Devices found during discovery, delivered as one list per batch when
+  /// discovery was started with [BluetoothDiscoveryOptions] (Windows).
+  Stream<List<BluetoothDevice>> get onDevicesDiscovered =>
+      _batchedDevicesController.stream;
+
+  /// A discovered device changed (name, pairing) during discovery (Windows).
+  Stream<BluetoothDevice> get onDeviceUpdated =>
+      _updatedDevicesController.stream;
+
+  /// A discovered device went away or was not seen for a while (Windows).
+  Stream<BluetoothDevice> get onDeviceLost => _lostDevicesController.stream;
+
+  /// Send-queue pressure changes (Windows). Pause producing on
+  /// `writable == false` and resume once a `writable == true` event arrives.
+  Stream<BluetoothFlowControlEvent> get onFlowControl =>
+      _flowControlController.stream;
+
+  /// Paired-device changes after `getPairedDevices(progressive: true)`
+  /// (Windows).
+  Stream<BluetoothPairedDevicesUpdate> get onPairedDevicesUpdated =>
+      _pairedDevicesController.stream;
+
   String _appName = "";
 
   /// Factory constructor to maintain a single instance of the class
@@ -49,6 +80,25 @@ class FlutterBluetoothClassic {
             final device = BluetoothDevice.fromMap(deviceMap);
             _discoveredDevicesController.add(device);
           }
+        } else if (eventType == 'devicesFound') {
+          final List<dynamic> deviceList = event['devices'] ?? [];
+          _batchedDevicesController.add(deviceList
+              .map((device) => BluetoothDevice.fromMap(device))
+              .toList());
+        } else if (eventType == 'deviceUpdated' ||
+            eventType == 'deviceLost') {
+          final deviceMap = event['device'];
+          if (deviceMap != null) {
+            final device = BluetoothDevice.fromMap(deviceMap);
+            if (eventType == 'deviceUpdated') {
+              _updatedDevicesController.add(device);
+            } else {
+              _lostDevicesController.add(device);
+            }
+          }
+        } else if (eventType == 'devicesUpdated') {
+          _pairedDevicesController
+              .add(BluetoothPairedDevicesUpdate.fromMap(event));
         } else if (eventType == 'discoveryError') {
           // Handle discovery errors (e.g., web user gesture requirement)
           // For now, we can add this as a state change or handle it in the future
@@ -67,7 +117,13 @@ class FlutterBluetoothClassic {
 
     // Listen for connection changes
     FlutterBluetoothClassicPlatform.instance.connectionStream.listen((event) {
-      _connectionStreamController.add(BluetoothConnectionState.fromMap(event));
+      final eventType = event['event'];
+      if (eventType == 'backpressure' || eventType == 'writable') {
+        _flowControlController.add(BluetoothFlowControlEvent.fromMap(event));
+      } else {
+        _connectionStreamController
+            .add(BluetoothConnectionState.fromMap(event));
+      }
     });
 
     // Listen for data received
@@ -106,10 +162,17 @@ class FlutterBluetoothClassic {
   }
 
   /// Get paired devices
-  Future<List<BluetoothDevice>> getPairedDevices() async {
+  ///
+  /// With [progressive] (Windows) this returns at once with the devices known
+  /// so far; devices resolved later, and later pairing changes, arrive on
+  /// [onPairedDevicesUpdated]. An update with `complete` set follows once
+  /// the list is whole, right after this returns if it already was.
+  Future<List<BluetoothDevice>> getPairedDevices(
+      {bool progressive = false}) async {
     try {
       final List<Map<String, dynamic>> devices =
-          await FlutterBluetoothClassicPlatform.instance.getPairedDevices();
+          await FlutterBluetoothClassicPlatform.instance
+              .getPairedDevices(progressive: progressive);
       return devices.map((device) => BluetoothDevice.fromMap(device)).toList();
     } catch (e) {
       throw BluetoothException('Failed to get paired devices: $e');
@@ -117,9 +180,14 @@ class FlutterBluetoothClassic {
   }
 
   /// Start discovery for nearby Bluetooth devices
-  Future<bool> startDiscovery() async {
+  ///
+  /// With [options] (Windows), found devices are collected and sent on
+  /// [onDevicesDiscovered] in batches instead of one by one on
+  /// [onDeviceDiscovered].
+  Future<bool> startDiscovery({BluetoothDiscoveryOptions? options}) async {
     try {
-      return await FlutterBluetoothClassicPlatform.instance.startDiscovery();
+      return await FlutterBluetoothClassicPlatform.instance
+          .startDiscovery(options: options?.toMap());
     } catch (e) {
       throw BluetoothException('Failed to start discovery: $e');
     }
@@ -135,17 +203,56 @@ class FlutterBluetoothClassic {
   }
 
   /// Connect to a device
-  Future<bool> connect(String address) async {
+  ///
+  /// [options] tunes the native transport for this connection only
+  /// (Windows); unset fields fall back to the values given to [configure].
+  ///
+  /// On Windows a second call for the same device and options while the
+  /// first is still connecting waits for it and gets the same result; any
+  /// other call makes the pending one fail with CONNECTION_SUPERSEDED.
+  /// [BluetoothConnectionOptions.connectTimeoutMs] bounds the attempt, and
+  /// a failed attempt's PlatformException details hold its phase timings
+  /// (see [getConnectionStats]).
+  Future<bool> connect(String address,
+      {BluetoothConnectionOptions? options}) async {
     try {
-      return await FlutterBluetoothClassicPlatform.instance.connect(address);
+      return await FlutterBluetoothClassicPlatform.instance
+          .connect(address, options: options?.toMap());
     } catch (e) {
       throw BluetoothException('Failed to connect to device: $e');
     }
   }
 
-  Future<bool> listen() async {
+  /// Open an additional connection without closing existing ones (Windows)
+  ///
+  /// Returns a handle to pass as `connectionId` to [sendData], [disconnect]
+  /// and [getConnectionStats]; events of this link carry the same id. The
+  /// number of open connections is capped by [configure]'s
+  /// `maxConnections`. Identical calls made while one is still connecting
+  /// share its handle.
+  Future<int> openConnection(String address,
+      {BluetoothConnectionOptions? options}) async {
+    try {
+      return await FlutterBluetoothClassicPlatform.instance
+          .openConnection(address, options: options?.toMap());
+    } catch (e) {
+      throw BluetoothException('Failed to open connection: $e');
+    }
+  }
+
+  /// Accept incoming connections
+  ///
+  /// On Windows every accepted peer becomes its own connection whose events
+  /// carry a `connectionId`. At most [maxPeers] (default 7) are kept; when
+  /// another peer arrives [admissionPolicy] either turns it away or closes
+  /// the longest-connected peer to make room.
+  Future<bool> listen(
+      {int? maxPeers, BluetoothAdmissionPolicy? admissionPolicy}) async {
     try {
-      return await FlutterBluetoothClassicPlatform.instance.listen();
+      return await FlutterBluetoothClassicPlatform.instance.listen(options: {
+        if (maxPeers != null) 'maxPeers': maxPeers,
+        if (admissionPolicy != null) 'admissionPolicy': admissionPolicy.name,
+      });
     } catch (e) {
       throw BluetoothException('Failed to listen for incoming connections: $e');
     }
@@ -159,45 +266,244 @@ class FlutterBluetoothClassic {
     }
   }
 
+  /// Abort connects still in progress (Windows)
+  ///
+  /// Only those to [address] if given, otherwise all of them; each fails
+  /// with CONNECTION_CANCELLED. Returns whether there was any.
+  Future<bool> cancelConnect({String? address}) async {
+    try {
+      return await FlutterBluetoothClassicPlatform.instance
+          .cancelConnect(address: address);
+    } catch (e) {
+      throw BluetoothException('Failed to cancel connect: $e');
+    }
+  }
+
   /// Disconnect from a device
-  Future<bool> disconnect() async {
+  ///
+  /// Without [connectionId] every open connection is closed.
+  Future<bool> disconnect({int? connectionId}) async {
     try {
-      return await FlutterBluetoothClassicPlatform.instance.disconnect();
+      return await FlutterBluetoothClassicPlatform.instance
+          .disconnect(connectionId: connectionId);
     } catch (e) {
       throw BluetoothException('Failed to disconnect: $e');
     }
   }
 
   /// Send data to the connected device
-  Future<bool> sendData(Uint8List data) async {
+  ///
+  /// Without [connectionId] the data goes to the connection opened by
+  /// [connect], or else to the most recently opened one.
+  Future<bool> sendData(Uint8List data, {int? connectionId}) async {
     try {
-      return await FlutterBluetoothClassicPlatform.instance.sendData(data);
+      return await FlutterBluetoothClassicPlatform.instance
+          .sendData(data, connectionId: connectionId);
     } catch (e) {
       throw BluetoothException('Failed to send data: $e');
     }
   }
 
   /// Send string data to the connected device
-  Future<bool> sendString(String message) async {
+  Future<bool> sendString(String message, {int? connectionId}) async {
     try {
       final Uint8List data = Uint8List.fromList(utf8.encode(message));
-      return await sendData(data);
+      return await sendData(data, connectionId: connectionId);
     } catch (e) {
       throw BluetoothException('Failed to send string: $e');
     }
   }
 
+  /// Configure native transport settings (Windows only)
+  ///
+  /// [dataEventFormat] selects how received bytes are delivered on
+  /// [onDataReceived]. [BluetoothDataFormat.bytes] (the default) ships a
+  /// single Uint8List per event; [BluetoothDataFormat.list] restores the
+  /// legacy list of boxed ints. Applies to connections opened afterwards.
+  ///
+  /// [maxConnections] caps how many connections may be open at once
+  /// (default 8); further opens fail with CONNECTION_LIMIT.
+  Future<bool> configure(
+      {BluetoothDataFormat? dataEventFormat, int? maxConnections}) async {
+    try {
+      final options = <String, dynamic>{};
+      if (dataEventFormat != null) {
+        options['dataEventFormat'] = dataEventFormat.name;
+      }
+      if (maxConnections != null) {
+        options['maxConnections'] = maxConnections;
+      }
+      return await FlutterBluetoothClassicPlatform.instance.configure(options);
+    } catch (e) {
+      throw BluetoothException('Failed to configure: $e');
+    }
+  }
+
+  /// Transport counters of a connection (Windows)
+  ///
+  /// COM links report writeBatches, writePayloads, writeBytes,
+  /// maxBatchPayloads and maxBatchBytes, which show how well queued writes
+  /// are being batched.
+  /// Both transports report rxEvents and rxBufferAllocations; the latter
+  /// stays flat once the receive buffer pool has warmed up.
+  ///
+  /// connectMs is how long the connect took and connectPhases where that
+  /// time went: enumerationMs, deviceLookupMs, sdpMs, socketConnectMs,
+  /// comOpenMs and totalMs (raced paths overlap). WinRT links also report
+  /// sdpCacheHit, true when the RFCOMM service came from cached SDP records
+  /// instead of a live query; sdpCacheHits and sdpCacheMisses count this
+  /// over all WinRT connects so far.
+  ///
+  /// connectHistory lists recently connected devices with the path tried
+  /// first next time (preferred: COM or WINRT) and, per path, successes,
+  /// failures, latencyMs and whether it is skipped after recent failures.
+  Future<Map<String, dynamic>> getConnectionStats({int? connectionId}) async {
+    try {
+      return await FlutterBluetoothClassicPlatform.instance
+          .getConnectionStats(connectionId: connectionId);
+    } catch (e) {
+      throw BluetoothException('Failed to get connection stats: $e');
+    }
+  }
+
   /// Dispose of resources
   void dispose() {
     _stateStreamController.close();
     _connectionStreamController.close();
     _dataStreamController.close();
     _discoveredDevicesController.close();
+    _batchedDevicesController.close();
+    _updatedDevicesController.close();
+    _lostDevicesController.close();
+    _flowControlController.close();
+    _pairedDevicesController.close();
   }
 }
 
 // Data Models
 
+/// Wire format of received data events.
+enum BluetoothDataFormat { bytes, list }
+
+/// What a listening server does with a peer that arrives while it is full.
+enum BluetoothAdmissionPolicy { reject, evictOldest }
+
+/// Native discovery settings (Windows).
+class BluetoothDiscoveryOptions {
+  /// Send found devices at most this often, as one list per batch; batching
+  /// is off unless this is above 0.
+  final int? batchIntervalMs;
+
+  /// Send a batch early once it holds this many devices.
+  final int? batchMaxDevices;
+
+  const BluetoothDiscoveryOptions({
+    this.batchIntervalMs,
+    this.batchMaxDevices,
+  });
+
+  Map<String, dynamic> toMap() {
+    return {
+      if (batchIntervalMs != null) 'batchIntervalMs': batchIntervalMs,
+      if (batchMaxDevices != null) 'batchMaxDevices': batchMaxDevices,
+    };
+  }
+}
+
+/// Per-connection native transport settings.
+class BluetoothConnectionOptions {
+  /// Merge queued writes into one write of at most this many bytes
+  /// (0 disables coalescing).
+  final int? coalesceMaxBytes;
+
+  /// How long the writer may wait for more payloads before flushing a
+  /// batch that is still below [coalesceMaxBytes].
+  final int? coalesceLatencyUs;
+
+  /// Hard byte limit of the send queue; sendData fails beyond it. At most
+  /// 16 MiB; COM links clamp it to 1 MiB.
+  final int? sendQueueMaxBytes;
+
+  /// Queue size at which a `backpressure` flow-control event is sent.
+  final int? highWatermarkBytes;
+
+  /// Queue size at which a `writable` flow-control event is sent again.
+  final int? lowWatermarkBytes;
+
+  /// Give up connecting after this many milliseconds (connect and
+  /// openConnection only; unset or 0 waits as long as the system does).
+  final int? connectTimeoutMs;
+
+  const BluetoothConnectionOptions({
+    this.coalesceMaxBytes,
+    this.coalesceLatencyUs,
+    this.sendQueueMaxBytes,
+    this.highWatermarkBytes,
+    this.lowWatermarkBytes,
+    this.connectTimeoutMs,
+  });
+
+  Map<String, dynamic> toMap() {
+    return {
+      if (coalesceMaxBytes != null) 'coalesceMaxBytes': coalesceMaxBytes,
+      if (coalesceLatencyUs != null) 'coalesceLatencyUs': coalesceLatencyUs,
+      if (sendQueueMaxBytes != null) 'sendQueueMaxBytes': sendQueueMaxBytes,
+      if (highWatermarkBytes != null) 'highWatermarkBytes': highWatermarkBytes,
+      if (lowWatermarkBytes != null) 'lowWatermarkBytes': lowWatermarkBytes,
+      if (connectTimeoutMs != null) 'connectTimeoutMs': connectTimeoutMs,
+    };
+  }
+}
+
+class BluetoothFlowControlEvent {
+  final String deviceAddress;
+  final bool writable;
+  final int queuedBytes;
+  final int? connectionId;
+
+  BluetoothFlowControlEvent({
+    required this.deviceAddress,
+    required this.writable,
+    required this.queuedBytes,
+    this.connectionId,
+  });
+
+  factory BluetoothFlowControlEvent.fromMap(dynamic map) {
+    return BluetoothFlowControlEvent(
+      deviceAddress: map['deviceAddress'] ?? '',
+      connectionId: map['connectionId'],
+      writable: map['event'] == 'writable',
+      queuedBytes: map['queuedBytes'] ?? 0,
+    );
+  }
+}
+
+/// Incremental paired-device list change. [devices] are new or changed
+/// entries, [removed] holds the addresses of entries that went away, and
+/// [complete] marks the end of the initial enumeration.
+class BluetoothPairedDevicesUpdate {
+  final List<BluetoothDevice> devices;
+  final List<String> removed;
+  final bool complete;
+
+  BluetoothPairedDevicesUpdate({
+    required this.devices,
+    required this.removed,
+    required this.complete,
+  });
+
+  factory BluetoothPairedDevicesUpdate.fromMap(dynamic map) {
+    final List<dynamic> devices = map['devices'] ?? [];
+    final List<dynamic> removed = map['removed'] ?? [];
+    return BluetoothPairedDevicesUpdate(
+      devices:
+          devices.map((device) => BluetoothDevice.fromMap(device)).toList(),
+      removed: removed.cast<String>(),
+      complete: map['complete'] ?? false,
+    );
+  }
+}
+
 class BluetoothException implements Exception {
   final String message;
 
@@ -266,18 +572,22 @@ class BluetoothConnectionState {
   final String deviceAddress;
   final String status;
 
+  /// Handle of the connection this event belongs to (Windows), or null.
+  final int? connectionId;
+
   BluetoothConnectionState({
     required this.isConnected,
     required this.deviceAddress,
     required this.status,
+    this.connectionId,
   });
 
   factory BluetoothConnectionState.fromMap(dynamic map) {
-    print(map);
     return BluetoothConnectionState(
       isConnected: map['isConnected'],
       deviceAddress: map['deviceAddress'],
       status: map['status'],
+      connectionId: map['connectionId'],
     );
   }
 }
@@ -286,9 +596,13 @@ class BluetoothData {
   final String deviceAddress;
   final List<int> data;
 
+  /// Handle of the connection the bytes arrived on (Windows), or null.
+  final int? connectionId;
+
   BluetoothData({
     required this.deviceAddress,
     required this.data,
+    this.connectionId,
   });
 
   String asString() {
@@ -296,10 +610,13 @@ class BluetoothData {
   }
 
   factory BluetoothData.fromMap(dynamic map) {
-    print(map);
     return BluetoothData(
       deviceAddress: map['deviceAddress'],
-      data: List<int>.from(map['data']),
+      connectionId: map['connectionId'],
+      // Uint8List payloads are used as-is; only legacy int lists are copied
+      data: map['data'] is Uint8List
+          ? map['data'] as Uint8List
+          : List<int>.from(map['data']),
     );
   }
 }
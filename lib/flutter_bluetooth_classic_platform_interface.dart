@@ -25,14 +25,19 @@ abstract class FlutterBluetoothClassicPlatform extends PlatformInterface {
   Future<bool> isBluetoothSupported();
   Future<bool> isBluetoothEnabled();
   Future<bool> enableBluetooth();
-  Future<List<Map<String, dynamic>>> getPairedDevices();
-  Future<bool> startDiscovery();
+  Future<List<Map<String, dynamic>>> getPairedDevices(
+      {bool progressive = false});
+  Future<bool> startDiscovery({Map<String, dynamic>? options});
   Future<bool> stopDiscovery();
-  Future<bool> connect(String address);
-  Future<bool> listen();
-  Future<bool> disconnect();
+  Future<bool> connect(String address, {Map<String, dynamic>? options});
+  Future<int> openConnection(String address, {Map<String, dynamic>? options});
+  Future<bool> listen({Map<String, dynamic>? options});
+  Future<bool> cancelConnect({String? address});
+  Future<bool> disconnect({int? connectionId});
   Future<bool> stopListen();
-  Future<bool> sendData(Uint8List data);
+  Future<bool> sendData(Uint8List data, {int? connectionId});
+  Future<bool> configure(Map<String, dynamic> options);
+  Future<Map<String, dynamic>> getConnectionStats({int? connectionId});
 }
 
 class _DefaultPlatform extends FlutterBluetoothClassicPlatform {
@@ -90,8 +95,11 @@ class _DefaultPlatform extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<List<Map<String, dynamic>>> getPairedDevices() async {
-    final result = await _channel.invokeMethod('getPairedDevices');
+  Future<List<Map<String, dynamic>>> getPairedDevices(
+      {bool progressive = false}) async {
+    final result = await _channel.invokeMethod('getPairedDevices', {
+      if (progressive) 'progressive': true,
+    });
     if (result == null) {
       return [];
     }
@@ -112,8 +120,8 @@ class _DefaultPlatform extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> startDiscovery() async {
-    return await _channel.invokeMethod('startDiscovery') ?? false;
+  Future<bool> startDiscovery({Map<String, dynamic>? options}) async {
+    return await _channel.invokeMethod('startDiscovery', options) ?? false;
   }
 
   @override
@@ -122,19 +130,47 @@ class _DefaultPlatform extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> connect(String address) async {
-    return await _channel.invokeMethod('connect', {'address': address}) ??
+  Future<bool> connect(String address, {Map<String, dynamic>? options}) async {
+    return await _channel.invokeMethod('connect', {
+          'address': address,
+          if (options != null) 'options': options,
+        }) ??
         false;
   }
 
   @override
-  Future<bool> listen() async {
-    return await _channel.invokeMethod('listen') ?? false;
+  Future<int> openConnection(String address,
+      {Map<String, dynamic>? options}) async {
+    final int? handle = await _channel.invokeMethod('openConnection', {
+      'address': address,
+      if (options != null) 'options': options,
+    });
+    if (handle == null) {
+      throw PlatformException(
+          code: 'CONNECTION_FAILED', message: 'No connection handle returned');
+    }
+    return handle;
+  }
+
+  @override
+  Future<bool> listen({Map<String, dynamic>? options}) async {
+    return await _channel.invokeMethod('listen', options) ?? false;
   }
 
   @override
-  Future<bool> disconnect() async {
-    return await _channel.invokeMethod('disconnect') ?? false;
+  Future<bool> cancelConnect({String? address}) async {
+    return await _channel.invokeMethod('cancelConnect', {
+          if (address != null) 'address': address,
+        }) ??
+        false;
+  }
+
+  @override
+  Future<bool> disconnect({int? connectionId}) async {
+    return await _channel.invokeMethod('disconnect', {
+          if (connectionId != null) 'connectionId': connectionId,
+        }) ??
+        false;
   }
 
   @override
@@ -143,7 +179,27 @@ class _DefaultPlatform extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> sendData(Uint8List data) async {
-    return await _channel.invokeMethod('sendData', {'data': data}) ?? false;
+  Future<bool> sendData(Uint8List data, {int? connectionId}) async {
+    return await _channel.invokeMethod('sendData', {
+          'data': data,
+          if (connectionId != null) 'connectionId': connectionId,
+        }) ??
+        false;
+  }
+
+  @override
+  Future<bool> configure(Map<String, dynamic> options) async {
+    return await _channel.invokeMethod('configure', options) ?? false;
+  }
+
+  @override
+  Future<Map<String, dynamic>> getConnectionStats({int? connectionId}) async {
+    final result = await _channel.invokeMethod('getConnectionStats', {
+      if (connectionId != null) 'connectionId': connectionId,
+    });
+    if (result == null) {
+      return {};
+    }
+    return _convertMapKeysToString(result as Map<dynamic, dynamic>);
   }
 }
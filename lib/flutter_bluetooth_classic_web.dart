@@ -215,7 +215,8 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<List<Map<String, dynamic>>> getPairedDevices() async {
+  Future<List<Map<String, dynamic>>> getPairedDevices(
+      {bool progressive = false}) async {
     try {
       // Get already granted serial ports (previously paired Bluetooth Classic devices)
       final ports = await serial.getPorts().toDart;
@@ -244,7 +245,7 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> startDiscovery() async {
+  Future<bool> startDiscovery({Map<String, dynamic>? options}) async {
     try {
       // Request a serial port filtered by SPP UUID
       // This will show a picker for Bluetooth devices with Serial Port Profile (SPP)
@@ -287,7 +288,7 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> connect(String address) async {
+  Future<bool> connect(String address, {Map<String, dynamic>? options}) async {
     final port = _discoveredPorts[address];
     if (port == null) {
       print(
@@ -364,7 +365,7 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> listen() async {
+  Future<bool> listen({Map<String, dynamic>? options}) async {
     // Web Serial API cannot act as a Bluetooth server/listener
     // This is a limitation of the Web Serial API
     return false;
@@ -377,7 +378,20 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> disconnect() async {
+  Future<int> openConnection(String address,
+      {Map<String, dynamic>? options}) async {
+    // Web Serial exposes a single user-selected port at a time
+    throw UnsupportedError('openConnection is not supported on web');
+  }
+
+  @override
+  Future<bool> cancelConnect({String? address}) async {
+    // requestPort() has no pending connect to abort
+    return false;
+  }
+
+  @override
+  Future<bool> disconnect({int? connectionId}) async {
     if (_port != null) {
       try {
         await _port!.close().toDart;
@@ -393,7 +407,7 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
   }
 
   @override
-  Future<bool> sendData(Uint8List data) async {
+  Future<bool> sendData(Uint8List data, {int? connectionId}) async {
     if (_port == null) return false;
     final writable = _port!.writable;
     if (writable == null) {
@@ -418,4 +432,15 @@ class FlutterBluetoothClassicWeb extends FlutterBluetoothClassicPlatform {
       return false;
     }
   }
+
+  @override
+  Future<bool> configure(Map<String, dynamic> options) async {
+    // Web Serial has no native transport settings to apply
+    return true;
+  }
+
+  @override
+  Future<Map<String, dynamic>> getConnectionStats({int? connectionId}) async {
+    return {};
+  }
 }
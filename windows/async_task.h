@@ -0,0 +1,364 @@
+#ifndef FLUTTER_PLUGIN_ASYNC_TASK_H_
+#define FLUTTER_PLUGIN_ASYNC_TASK_H_
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+
+// Thrown out of an awaited step once its token is cancelled. what() is the
+// reason passed to CancellationSource::Cancel ("CANCELLED", "TIMEOUT", ...).
+class OperationCancelled : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+namespace internal {
+
+class CancellationState {
+ public:
+  bool IsCancelled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_;
+  }
+
+  std::string reason() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reason_;
+  }
+
+  // Runs the registered callbacks outside the lock. False if already
+  // cancelled.
+  bool Cancel(const std::string& reason) {
+    std::map<uint64_t, std::function<void()>> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cancelled_) {
+        return false;
+      }
+      cancelled_ = true;
+      reason_ = reason;
+      callbacks.swap(callbacks_);
+    }
+    for (auto& entry : callbacks) {
+      entry.second();
+    }
+    return true;
+  }
+
+  // Returns 0 and runs callback at once when already cancelled.
+  uint64_t Register(std::function<void()> callback) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!cancelled_) {
+        const uint64_t id = next_id_++;
+        callbacks_.emplace(id, std::move(callback));
+        return id;
+      }
+    }
+    callback();
+    return 0;
+  }
+
+  void Unregister(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callbacks_.erase(id);
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  bool cancelled_ = false;
+  std::string reason_;
+  uint64_t next_id_ = 1;
+  std::map<uint64_t, std::function<void()>> callbacks_;
+};
+
+}  // namespace internal
+
+// Drops a cancellation callback when it goes out of scope. A callback that
+// is already running may still finish afterwards.
+class CancellationRegistration {
+ public:
+  CancellationRegistration() = default;
+  CancellationRegistration(std::shared_ptr<internal::CancellationState> state, uint64_t id)
+      : state_(std::move(state)), id_(id) {}
+  CancellationRegistration(CancellationRegistration&& other) noexcept
+      : state_(std::move(other.state_)), id_(std::exchange(other.id_, 0)) {}
+  CancellationRegistration& operator=(CancellationRegistration&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      state_ = std::move(other.state_);
+      id_ = std::exchange(other.id_, 0);
+    }
+    return *this;
+  }
+  ~CancellationRegistration() { Reset(); }
+
+  void Reset() {
+    if (state_ && id_ != 0) {
+      state_->Unregister(id_);
+    }
+    state_.reset();
+    id_ = 0;
+  }
+
+ private:
+  std::shared_ptr<internal::CancellationState> state_;
+  uint64_t id_ = 0;
+};
+
+// Observes a CancellationSource. A default-constructed token never fires.
+class CancellationToken {
+ public:
+  CancellationToken() = default;
+
+  bool IsCancelled() const { return state_ && state_->IsCancelled(); }
+
+  // What Cancel was given; empty until then.
+  std::string reason() const { return state_ ? state_->reason() : std::string(); }
+
+  void ThrowIfCancelled() const {
+    if (IsCancelled()) {
+      throw OperationCancelled(state_->reason());
+    }
+  }
+
+  // callback runs once on the cancelling thread (or now, if already
+  // cancelled) unless the registration is dropped first.
+  CancellationRegistration OnCancel(std::function<void()> callback) const {
+    if (!state_) {
+      return CancellationRegistration();
+    }
+    return CancellationRegistration(state_, state_->Register(std::move(callback)));
+  }
+
+ private:
+  friend class CancellationSource;
+  explicit CancellationToken(std::shared_ptr<internal::CancellationState> state)
+      : state_(std::move(state)) {}
+
+  std::shared_ptr<internal::CancellationState> state_;
+};
+
+class CancellationSource {
+ public:
+  CancellationSource() : state_(std::make_shared<internal::CancellationState>()) {}
+
+  CancellationToken token() const { return CancellationToken(state_); }
+
+  // False if the source was already cancelled.
+  bool Cancel(const std::string& reason = "CANCELLED") { return state_->Cancel(reason); }
+
+  // Cancels with "TIMEOUT" once delay has elapsed, unless cancelled first.
+  // The timer does not keep the source alive.
+  void CancelAfter(WorkerPool* workers, WorkerPool::Clock::duration delay) {
+    std::weak_ptr<internal::CancellationState> weak_state = state_;
+    workers->PostAfter(delay, [weak_state]() {
+      if (auto state = weak_state.lock()) {
+        state->Cancel("TIMEOUT");
+      }
+    });
+  }
+
+ private:
+  std::shared_ptr<internal::CancellationState> state_;
+};
+
+template <typename T = void>
+class Task;
+
+namespace internal {
+
+struct TaskPromiseBase {
+  // Hands control straight back to whoever awaited the task.
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+      std::coroutine_handle<> continuation = handle.promise().continuation;
+      return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+  void RethrowIfFailed() const {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+  Task<T> get_return_object() noexcept;
+
+  template <typename U>
+  void return_value(U&& value) {
+    result.emplace(std::forward<U>(value));
+  }
+
+  T TakeResult() {
+    RethrowIfFailed();
+    return std::move(*result);
+  }
+
+  std::optional<T> result;
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object() noexcept;
+  void return_void() const noexcept {}
+  void TakeResult() const { RethrowIfFailed(); }
+};
+
+// Fire-and-forget frame used by Spawn; it frees itself when done.
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+}  // namespace internal
+
+// Lazily started coroutine producing T.
+//
+// Nothing runs until the task is co_awaited or passed to Spawn. The awaiting
+// coroutine resumes on whichever thread the task finishes on; steps that
+// must not block (WinRT operations, timers) suspend instead of parking the
+// thread.
+template <typename T>
+class [[nodiscard]] Task {
+ public:
+  using promise_type = internal::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+  ~Task() { Destroy(); }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      Handle handle;
+      bool await_ready() const noexcept { return false; }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() { return handle.promise().TakeResult(); }
+    };
+    return Awaiter{handle_};
+  }
+
+ private:
+  friend promise_type;
+  explicit Task(Handle handle) : handle_(handle) {}
+
+  void Destroy() {
+    if (handle_) {
+      handle_.destroy();
+      handle_ = {};
+    }
+  }
+
+  Handle handle_;
+};
+
+namespace internal {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>(Task<T>::Handle::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>(Task<void>::Handle::from_promise(*this));
+}
+
+}  // namespace internal
+
+// Starts task on the calling thread and, once it finishes, runs
+// on_done(std::future<T>) on the thread it finished on. get() on the future
+// rethrows whatever the task threw.
+template <typename T, typename C>
+internal::DetachedTask Spawn(Task<T> task, C on_done) {
+  std::promise<T> promise;
+  try {
+    if constexpr (std::is_void_v<T>) {
+      co_await std::move(task);
+      promise.set_value();
+    } else {
+      promise.set_value(co_await std::move(task));
+    }
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+  }
+  try {
+    on_done(promise.get_future());
+  } catch (...) {
+    // Continuations report their own errors; nothing can be rethrown here.
+  }
+}
+
+// co_await ResumeOn(workers) continues the coroutine on a pool worker. Once
+// the pool is shutting down the coroutine carries on where it is instead and
+// the co_await throws OperationCancelled("SHUTDOWN"), so the task still
+// completes.
+inline auto ResumeOn(WorkerPool* workers) {
+  struct Awaiter {
+    WorkerPool* workers;
+    bool rejected = false;
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      // On success the worker may already be running the coroutine, which
+      // owns this awaiter; nothing here may be touched after Post.
+      if (workers->Post([handle]() { handle.resume(); })) {
+        return true;
+      }
+      rejected = true;
+      return false;
+    }
+    void await_resume() const {
+      if (rejected) {
+        throw OperationCancelled("SHUTDOWN");
+      }
+    }
+  };
+  return Awaiter{workers};
+}
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_ASYNC_TASK_H_
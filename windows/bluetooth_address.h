@@ -0,0 +1,130 @@
+#ifndef FLUTTER_PLUGIN_BLUETOOTH_ADDRESS_H_
+#define FLUTTER_PLUGIN_BLUETOOTH_ADDRESS_H_
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace flutter_bluetooth_classic {
+
+// 48-bit Bluetooth device address held as an integer, the form WinRT uses.
+// Parsing and formatting work on fixed buffers and never allocate, so it is
+// cheap to use as a map key where a normalized string was used before.
+class BdAddr {
+ public:
+  static constexpr uint64_t kMask = 0xFFFFFFFFFFFFull;
+  // "XX:XX:XX:XX:XX:XX"
+  static constexpr size_t kFormattedLength = 17;
+
+  constexpr BdAddr() = default;
+  constexpr explicit BdAddr(uint64_t value) : value_(value & kMask) {}
+
+  // Any spelling with exactly 12 hex digits; every other character is
+  // skipped, so "001122AABBCC", "00:11:22:aa:bb:cc" and "(00-11-22-AA-BB-CC)"
+  // all parse. Fails on more or fewer digits.
+  static constexpr bool TryParse(std::string_view text, BdAddr* out) {
+    uint64_t value = 0;
+    int digits = 0;
+    for (char c : text) {
+      const int nibble = HexValue(c);
+      if (nibble < 0) {
+        continue;
+      }
+      if (++digits > 12) {
+        return false;
+      }
+      value = (value << 4) | static_cast<uint64_t>(nibble);
+    }
+    if (digits != 12) {
+      return false;
+    }
+    *out = BdAddr(value);
+    return true;
+  }
+
+  constexpr uint64_t value() const { return value_; }
+
+  // Writes the upper-case XX:XX:XX:XX:XX:XX form (no terminator).
+  constexpr void Format(char* out) const {
+    constexpr char kHexDigits[] = "0123456789ABCDEF";
+    for (int i = 0; i < 6; ++i) {
+      const unsigned byte = static_cast<unsigned>(value_ >> ((5 - i) * 8)) & 0xFF;
+      out[i * 3] = kHexDigits[byte >> 4];
+      out[i * 3 + 1] = kHexDigits[byte & 0x0F];
+      if (i < 5) {
+        out[i * 3 + 2] = ':';
+      }
+    }
+  }
+
+  std::string ToString() const {
+    std::string text(kFormattedLength, '\0');
+    Format(text.data());
+    return text;
+  }
+
+  friend constexpr bool operator==(BdAddr a, BdAddr b) { return a.value_ == b.value_; }
+  friend constexpr bool operator!=(BdAddr a, BdAddr b) { return a.value_ != b.value_; }
+  friend constexpr bool operator<(BdAddr a, BdAddr b) { return a.value_ < b.value_; }
+
+ private:
+  static constexpr int HexValue(char c) {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    }
+    if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+    return -1;
+  }
+
+  uint64_t value_ = 0;
+};
+
+struct BdAddrHash {
+  size_t operator()(BdAddr address) const noexcept {
+    // Mix the high bytes (vendor OUI) into the low ones most tables index by
+    const uint64_t v = address.value();
+    return static_cast<size_t>(v ^ (v >> 24));
+  }
+};
+
+// Formats a 48-bit address as XX:XX:XX:XX:XX:XX.
+inline std::string BluetoothAddressToString(uint64_t address) {
+  return BdAddr(address).ToString();
+}
+
+// Canonical XX:XX:XX:XX:XX:XX form of any spelling with 12 hex digits;
+// empty when the input is not an address.
+inline std::string NormalizeAddress(const std::string& address) {
+  BdAddr parsed;
+  if (!BdAddr::TryParse(address, &parsed)) {
+    return "";
+  }
+  return parsed.ToString();
+}
+
+// Upper-case port name without a "COM:" or "\\.\" prefix.
+inline std::string NormalizeComPort(const std::string& com_port) {
+  std::string normalized = com_port;
+  if (normalized.rfind("COM:", 0) == 0) {
+    normalized = normalized.substr(4);
+  }
+  if (normalized.rfind("\\\\.\\", 0) == 0) {
+    normalized = normalized.substr(4);
+  }
+  std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) {
+    return static_cast<char>(std::toupper(c));
+  });
+  return normalized;
+}
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_BLUETOOTH_ADDRESS_H_
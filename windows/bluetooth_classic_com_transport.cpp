@@ -1,302 +1,438 @@
 #include "bluetooth_classic_com_transport.h"
 
-#include <windows.h>
-
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "flutter_bluetooth_classic_plugin.h"
+#ifdef _WIN32
+#include "bluetooth_classic_win32_serial_port.h"
+#endif
+#include "event_stream_handler.h"
+#include "worker_pool.h"
 
 namespace flutter_bluetooth_classic {
 namespace {
 
-std::string LastErrorMessage(const std::string& prefix) {
-  const DWORD error = GetLastError();
-  char* buffer = nullptr;
-  FormatMessageA(
-      FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-      nullptr,
-      error,
-      MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-      reinterpret_cast<LPSTR>(&buffer),
-      0,
-      nullptr);
-
-  std::string result = prefix + " (error=" + std::to_string(error) + ")";
-  if (buffer != nullptr) {
-    result += ": ";
-    result += buffer;
-    LocalFree(buffer);
-  }
-  return result;
+constexpr size_t kReadChunkSize = 4096;
+constexpr size_t kPooledReadBuffers = 4;
+// Reads per job before re-arming, so a busy port yields its worker to the
+// other connections between bursts.
+constexpr int kMaxReadsPerJob = 16;
+// The send ring is allocated up front, so its size does not follow
+// sendQueueMaxBytes past this; a payload larger than the ring still goes
+// out on its own through the oversize path.
+constexpr size_t kMaxSendRingBytes = 1024 * 1024;
+
+// The COM queue holds at most what fits in the ring; the budget and the
+// watermarks are clamped to that so flow control still fires.
+TransportOptions ClampToSendRing(TransportOptions options) {
+  options.send_queue_max_bytes = std::min(options.send_queue_max_bytes, kMaxSendRingBytes);
+  options.send_queue_high_watermark_bytes =
+      std::min(options.send_queue_high_watermark_bytes, options.send_queue_max_bytes);
+  options.send_queue_low_watermark_bytes =
+      std::min(options.send_queue_low_watermark_bytes, options.send_queue_high_watermark_bytes);
+  return options;
 }
 
 }  // namespace
 
+#ifdef _WIN32
+BluetoothClassicComTransport::BluetoothClassicComTransport(
+    const std::string& com_port,
+    const std::string& device_address,
+    int64_t connection_id,
+    IoReactor* reactor,
+    WorkerPool* workers,
+    EventStreamHandler<flutter::EncodableValue>* connection_handler,
+    EventStreamHandler<flutter::EncodableValue>* data_handler,
+    const TransportOptions& options)
+    : BluetoothClassicComTransport(std::make_unique<Win32SerialPort>(com_port, reactor),
+                                   com_port,
+                                   device_address,
+                                   connection_id,
+                                   workers,
+                                   connection_handler,
+                                   data_handler,
+                                   options) {}
+#endif
+
 BluetoothClassicComTransport::BluetoothClassicComTransport(
+    std::unique_ptr<SerialPort> serial_port,
     const std::string& com_port,
     const std::string& device_address,
+    int64_t connection_id,
+    WorkerPool* workers,
     EventStreamHandler<flutter::EncodableValue>* connection_handler,
-    EventStreamHandler<flutter::EncodableValue>* data_handler)
-    : com_port_(com_port),
+    EventStreamHandler<flutter::EncodableValue>* data_handler,
+    const TransportOptions& options)
+    : serial_port_(std::move(serial_port)),
+      com_port_(com_port),
       device_address_(device_address),
+      connection_id_(connection_id),
+      workers_(workers),
+      options_(ClampToSendRing(options)),
+      send_ring_(options_.send_queue_max_bytes, /*count_writes=*/true),
+      receive_pool_(kReadChunkSize, kPooledReadBuffers),
       connection_handler_(connection_handler),
-      data_handler_(data_handler) {}
+      data_handler_(data_handler) {
+  flutter::EncodableMap data_map;
+  data_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
+  data_map[flutter::EncodableValue("comPort")] = flutter::EncodableValue(com_port_);
+  data_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(connection_id_);
+  data_map[flutter::EncodableValue("data")] = flutter::EncodableValue(std::vector<uint8_t>());
+  data_event_ = flutter::EncodableValue(std::move(data_map));
+  data_slot_ = &std::get<flutter::EncodableMap>(data_event_)[flutter::EncodableValue("data")];
+}
 
 BluetoothClassicComTransport::~BluetoothClassicComTransport() {
   Close();
 }
 
 bool BluetoothClassicComTransport::Open(std::string* error_message) {
-  if (is_connected_) {
-    return true;
-  }
-
-  const std::string com_path = ToWindowsComPath(com_port_);
-  HANDLE handle = CreateFileA(
-      com_path.c_str(),
-      GENERIC_READ | GENERIC_WRITE,
-      0,
-      nullptr,
-      OPEN_EXISTING,
-      FILE_ATTRIBUTE_NORMAL,
-      nullptr);
-
-  if (handle == INVALID_HANDLE_VALUE) {
-    if (error_message != nullptr) {
-      *error_message = LastErrorMessage("COM_OPEN_FAILED");
-    }
+  if (!OpenPort(error_message)) {
     return false;
   }
+  Start();
+  return true;
+}
 
-  DCB dcb;
-  SecureZeroMemory(&dcb, sizeof(dcb));
-  dcb.DCBlength = sizeof(dcb);
-  if (!GetCommState(handle, &dcb)) {
-    if (error_message != nullptr) {
-      *error_message = LastErrorMessage("COM_GET_STATE_FAILED");
-    }
-    CloseHandle(handle);
-    return false;
+bool BluetoothClassicComTransport::OpenPort(std::string* error_message) {
+  if (is_connected_ || port_ready_) {
+    return true;
   }
-
-  dcb.BaudRate = CBR_115200;
-  dcb.ByteSize = 8;
-  dcb.StopBits = ONESTOPBIT;
-  dcb.Parity = NOPARITY;
-  dcb.fOutxCtsFlow = FALSE;
-  dcb.fOutxDsrFlow = FALSE;
-  dcb.fDtrControl = DTR_CONTROL_ENABLE;
-  dcb.fRtsControl = RTS_CONTROL_ENABLE;
-  dcb.fOutX = FALSE;
-  dcb.fInX = FALSE;
-
-  if (!SetCommState(handle, &dcb)) {
-    if (error_message != nullptr) {
-      *error_message = LastErrorMessage("COM_SET_STATE_FAILED");
-    }
-    CloseHandle(handle);
+  if (!serial_port_->Open(error_message)) {
     return false;
   }
+  port_ready_ = true;
+  return true;
+}
 
-  COMMTIMEOUTS timeouts;
-  SecureZeroMemory(&timeouts, sizeof(timeouts));
-  // Read settings optimized for low-latency non-blocking polling.
-  timeouts.ReadIntervalTimeout = MAXDWORD;
-  timeouts.ReadTotalTimeoutConstant = 0;
-  timeouts.ReadTotalTimeoutMultiplier = 0;
-  timeouts.WriteTotalTimeoutConstant = 100;
-  timeouts.WriteTotalTimeoutMultiplier = 0;
-  SetupComm(handle, 65536, 65536);
-  SetCommTimeouts(handle, &timeouts);
-
-  PurgeComm(handle, PURGE_RXCLEAR | PURGE_TXCLEAR);
+void BluetoothClassicComTransport::Start() {
+  if (!port_ready_ || is_connected_) {
+    return;
+  }
 
-  serial_handle_ = handle;
   should_stop_ = false;
   is_connected_ = true;
   disconnect_reported_ = false;
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    port_opened_ = true;
+    port_closed_ = false;
+  }
+  io_refs_ = 1;
+  io_open_ = true;
   SendConnectionState(true, "CONNECTED: COM(" + com_port_ + ")");
-  StartReadLoop();
-  StartWriteLoop();
-  return true;
+  AcquireIo();
+  ArmRead();
 }
 
 void BluetoothClassicComTransport::WriteData(const std::vector<uint8_t>& data) {
-  if (!is_connected_ || serial_handle_ == nullptr) {
+  if (!is_connected_) {
     throw std::runtime_error("COM transport not connected");
   }
+  if (data.empty()) {
+    return;
+  }
 
-  {
-    std::lock_guard<std::mutex> lock(write_mutex_);
-    constexpr size_t kMaxPendingWrites = 256;
-    if (pending_writes_.size() >= kMaxPendingWrites) {
-      throw std::runtime_error("COM send queue is full");
+  // Same admission rule as SendQueueBudget: the hard limit applies to a
+  // non-empty queue, so an oversized payload still goes out on its own.
+  const size_t max_bytes = options_.send_queue_max_bytes;
+  const size_t queued_bytes = QueuedBytes();
+  if (queued_bytes > 0 && (queued_bytes >= max_bytes || data.size() > max_bytes - queued_bytes)) {
+    throw std::runtime_error("COM send queue is full");
+  }
+  if (data.size() > send_ring_.capacity()) {
+    // queued_bytes is 0 here, and only this thread adds bytes.
+    oversize_payload_ = data;
+    oversize_bytes_.store(data.size(), std::memory_order_release);
+  } else if (!send_ring_.TryWrite(data.data(), data.size())) {
+    throw std::runtime_error("COM send queue is full");
+  }
+  write_payloads_.fetch_add(1, std::memory_order_relaxed);
+  ScheduleDrain();
+
+  // A full batch is waiting on the coalescing timer: take over the drain
+  // role now instead of letting the timer fire. The stale timer only
+  // releases its reference.
+  if (coalesce_pending_.load(std::memory_order_acquire) &&
+      send_ring_.Size() >= options_.write_coalesce_max_bytes &&
+      coalesce_pending_.exchange(false, std::memory_order_acq_rel)) {
+    AcquireIo();
+    auto self = shared_from_this();
+    if (!workers_->Post([self]() { self->Drain(); })) {
+      ReleaseIo();
     }
-    pending_writes_.push_back(data);
   }
-  write_cv_.notify_one();
+  UpdateFlowControl();
 }
 
 void BluetoothClassicComTransport::Close() {
   should_stop_ = true;
-  write_cv_.notify_all();
-  {
-    std::lock_guard<std::mutex> lock(write_mutex_);
-    pending_writes_.clear();
-  }
 
-  HANDLE handle = reinterpret_cast<HANDLE>(serial_handle_);
-  if (read_thread_.joinable()) {
-    CancelSynchronousIo(reinterpret_cast<HANDLE>(read_thread_.native_handle()));
-  }
-  if (write_thread_.joinable()) {
-    CancelSynchronousIo(reinterpret_cast<HANDLE>(write_thread_.native_handle()));
-  }
-  if (handle != nullptr && handle != INVALID_HANDLE_VALUE) {
-    PurgeComm(handle, PURGE_RXABORT | PURGE_TXABORT | PURGE_RXCLEAR | PURGE_TXCLEAR);
-    CloseHandle(handle);
-  }
-  serial_handle_ = nullptr;
+  // Completes the armed WaitCommEvent and aborts any in-flight write; the
+  // jobs see should_stop_ and drop their references.
+  serial_port_->Cancel();
 
-  if (read_thread_.joinable()) {
-    if (std::this_thread::get_id() != read_thread_.get_id()) {
-      read_thread_.join();
-    } else {
-      read_thread_.detach();
-    }
+  if (io_open_.exchange(false)) {
+    ReleaseIo();
   }
-  if (write_thread_.joinable()) {
-    if (std::this_thread::get_id() != write_thread_.get_id()) {
-      write_thread_.join();
-    } else {
-      write_thread_.detach();
-    }
+  // A job queued behind this worker could never run if it blocked here.
+  if (!workers_->IsWorkerThread()) {
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    io_cv_.wait(lock, [this]() { return port_closed_ || !port_opened_; });
   }
 
   if (is_connected_) {
     is_connected_ = false;
     ReportDisconnected("DISCONNECTED");
   }
-}
 
-std::string BluetoothClassicComTransport::ToWindowsComPath(const std::string& com_port) const {
-  if (com_port.rfind("\\\\.\\", 0) == 0) {
-    return com_port;
+  // Opened but never started: no job owns the port
+  bool started = false;
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    started = port_opened_;
+  }
+  if (port_ready_.exchange(false) && !started) {
+    serial_port_->Close();
   }
-  return "\\\\.\\" + com_port;
 }
 
-void BluetoothClassicComTransport::StartReadLoop() {
-  read_thread_ = std::thread([this]() {
-    ReadLoop();
-  });
+void BluetoothClassicComTransport::AcquireIo() {
+  io_refs_.fetch_add(1, std::memory_order_relaxed);
 }
 
-void BluetoothClassicComTransport::StartWriteLoop() {
-  write_thread_ = std::thread([this]() {
-    WriteLoop();
+void BluetoothClassicComTransport::ReleaseIo() {
+  if (io_refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  serial_port_->Close();
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    port_closed_ = true;
+  }
+  io_cv_.notify_all();
+}
+
+void BluetoothClassicComTransport::ArmRead() {
+  auto self = shared_from_this();
+  serial_port_->BeginWaitForData([self](SerialPort::WaitResult result, const std::string& error) {
+    self->OnDataReady(result, error);
   });
 }
 
-void BluetoothClassicComTransport::ReadLoop() {
-  std::vector<uint8_t> buffer(4096);
-  while (!should_stop_ && is_connected_) {
-    HANDLE handle = reinterpret_cast<HANDLE>(serial_handle_);
-    if (handle == nullptr || handle == INVALID_HANDLE_VALUE) {
-      break;
-    }
+void BluetoothClassicComTransport::OnDataReady(
+    SerialPort::WaitResult result, const std::string& error) {
+  if (result == SerialPort::WaitResult::kCancelled || should_stop_ || !is_connected_) {
+    ReleaseIo();
+    return;
+  }
+  if (result == SerialPort::WaitResult::kError) {
+    is_connected_ = false;
+    ReportDisconnected(error);
+    ReleaseIo();
+    return;
+  }
 
-    DWORD errors = 0;
-    COMSTAT status;
-    if (!ClearCommError(handle, &errors, &status)) {
+  // Drain what the driver has queued before arming the next wait; if more
+  // is left the next wait completes at once.
+  std::string read_error;
+  for (int reads = 0; reads < kMaxReadsPerJob && !should_stop_ && is_connected_; ++reads) {
+    std::vector<uint8_t> buffer = receive_pool_.Acquire();
+    buffer.resize(kReadChunkSize);
+    size_t bytes_read = 0;
+    if (!serial_port_->Read(buffer.data(), buffer.size(), &bytes_read, &read_error)) {
       if (!should_stop_) {
         is_connected_ = false;
-        ReportDisconnected(LastErrorMessage("CLEAR_COMM_FAILED"));
+        ReportDisconnected(read_error);
       }
+      ReleaseIo();
       return;
     }
-
-    if (status.cbInQue == 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-      continue;
+    if (bytes_read == 0) {
+      receive_pool_.Release(std::move(buffer));
+      break;
     }
 
-    while (!should_stop_ && is_connected_) {
-      DWORD to_read = static_cast<DWORD>(std::min<size_t>(status.cbInQue, buffer.size()));
-      if (to_read == 0) {
-        break;
-      }
+    buffer.resize(bytes_read);
+    SendData(std::move(buffer));
+  }
 
-      DWORD bytes_read = 0;
-      BOOL read_ok = ReadFile(handle, buffer.data(), to_read, &bytes_read, nullptr);
-      if (!read_ok) {
-        DWORD read_error = GetLastError();
-        if (should_stop_ || read_error == ERROR_OPERATION_ABORTED || read_error == ERROR_INVALID_HANDLE) {
-          return;
-        }
-        is_connected_ = false;
-        ReportDisconnected(LastErrorMessage("READ_FAILED"));
-        return;
-      }
-      if (bytes_read == 0) {
-        break;
-      }
+  if (should_stop_ || !is_connected_) {
+    ReleaseIo();
+    return;
+  }
+  // The read chain keeps its reference across re-arms.
+  ArmRead();
+}
 
-      std::vector<uint8_t> data(buffer.begin(), buffer.begin() + bytes_read);
-      SendData(data);
+void BluetoothClassicComTransport::ScheduleDrain() {
+  // Pairs with the fence in Drain: either this exchange sees the flag
+  // cleared or the drain job sees the bytes just written.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  AcquireIo();
+  auto self = shared_from_this();
+  // A pool that is shutting down drops the job; its reference goes with it.
+  if (!workers_->Post([self]() { self->Drain(); })) {
+    ReleaseIo();
+  }
+}
+
+void BluetoothClassicComTransport::Drain() {
+  // Runs as the single consumer of send_ring_. Entered holding one I/O
+  // reference, which is either handed to a coalescing timer or released.
+  const size_t coalesce_max_bytes = options_.write_coalesce_max_bytes;
+  const auto coalesce_latency = std::chrono::microseconds(options_.write_coalesce_latency_us);
 
-      if (!ClearCommError(handle, &errors, &status)) {
+  while (!should_stop_) {
+    // An oversized payload only enters an empty queue, so it goes before
+    // anything in the ring.
+    if (const size_t oversize = oversize_bytes_.load(std::memory_order_acquire)) {
+      std::string error;
+      if (!serial_port_->Write(oversize_payload_.data(), oversize, &error)) {
         if (!should_stop_) {
           is_connected_ = false;
-          ReportDisconnected(LastErrorMessage("CLEAR_COMM_FAILED"));
+          ReportDisconnected(error);
         }
-        return;
+        break;
       }
+      oversize_payload_.clear();
+      oversize_payload_.shrink_to_fit();
+      oversize_bytes_.store(0, std::memory_order_release);
+      UpdateFlowControl();
+      RecordBatch(1, oversize);
+      continue;
     }
-  }
-}
 
-void BluetoothClassicComTransport::WriteLoop() {
-  while (!should_stop_) {
-    std::vector<uint8_t> next_payload;
-    {
-      std::unique_lock<std::mutex> lock(write_mutex_);
-      write_cv_.wait(lock, [this]() { return should_stop_ || !pending_writes_.empty(); });
-      if (should_stop_) {
+    SpscByteRing::Span span = send_ring_.Peek();
+    if (span.size == 0) {
+      drain_scheduled_.store(false, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if ((send_ring_.Empty() && oversize_bytes_.load(std::memory_order_acquire) == 0) ||
+          drain_scheduled_.exchange(true, std::memory_order_acq_rel)) {
         break;
       }
-      next_payload = std::move(pending_writes_.front());
-      pending_writes_.pop_front();
-    }
-
-    HANDLE handle = reinterpret_cast<HANDLE>(serial_handle_);
-    if (handle == nullptr || handle == INVALID_HANDLE_VALUE) {
-      break;
+      continue;
     }
 
-    const uint8_t* cursor = next_payload.data();
-    size_t remaining = next_payload.size();
-    while (remaining > 0 && !should_stop_) {
-      DWORD bytes_written = 0;
-      BOOL ok = WriteFile(handle, cursor, static_cast<DWORD>(remaining), &bytes_written, nullptr);
-      if (!ok || bytes_written == 0) {
-        DWORD write_error = GetLastError();
-        if (should_stop_ || write_error == ERROR_OPERATION_ABORTED || write_error == ERROR_INVALID_HANDLE) {
-          return;
-        }
-        if (!should_stop_) {
-          is_connected_ = false;
-          ReportDisconnected(LastErrorMessage("WRITE_ERROR"));
+    // The ring already merges everything queued so far. With a latency
+    // budget, give a short batch a little longer to fill up to the cap,
+    // parked on a timer rather than on this worker.
+    if (coalesce_max_bytes > 0 && coalesce_latency.count() > 0 &&
+        send_ring_.Size() < coalesce_max_bytes) {
+      const auto now = std::chrono::steady_clock::now();
+      if (!coalesce_deadline_set_) {
+        coalesce_deadline_ = now + coalesce_latency;
+        coalesce_deadline_set_ = true;
+      }
+      if (now < coalesce_deadline_) {
+        coalesce_pending_.store(true, std::memory_order_release);
+        auto self = shared_from_this();
+        const bool posted = workers_->PostAfter(coalesce_deadline_ - now, [self]() {
+          if (self->coalesce_pending_.exchange(false, std::memory_order_acq_rel)) {
+            self->Drain();
+          } else {
+            self->ReleaseIo();
+          }
+        });
+        if (!posted) {
+          coalesce_pending_.store(false, std::memory_order_release);
+          ReleaseIo();
         }
         return;
       }
-      cursor += bytes_written;
-      remaining -= bytes_written;
     }
+    coalesce_deadline_set_ = false;
+
+    size_t batch_size = span.size;
+    if (coalesce_max_bytes > 0 && batch_size > coalesce_max_bytes) {
+      batch_size = coalesce_max_bytes;
+    }
+
+    std::string error;
+    if (!serial_port_->Write(span.data, batch_size, &error)) {
+      if (!should_stop_) {
+        is_connected_ = false;
+        ReportDisconnected(error);
+      }
+      // drain_scheduled_ stays set so no further drain job is started.
+      break;
+    }
+    // A payload split across batches counts in the one holding its end.
+    const size_t batch_payloads = send_ring_.Consume(batch_size);
+    UpdateFlowControl();
+    RecordBatch(batch_payloads, batch_size);
   }
+
+  ReleaseIo();
+}
+
+void BluetoothClassicComTransport::RecordBatch(size_t payloads, size_t bytes) {
+  // Only the drain role updates the batch counters; readers just load them.
+  write_batches_.fetch_add(1, std::memory_order_relaxed);
+  write_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+  if (payloads > max_batch_payloads_.load(std::memory_order_relaxed)) {
+    max_batch_payloads_.store(payloads, std::memory_order_relaxed);
+  }
+  if (bytes > max_batch_bytes_.load(std::memory_order_relaxed)) {
+    max_batch_bytes_.store(bytes, std::memory_order_relaxed);
+  }
+}
+
+size_t BluetoothClassicComTransport::QueuedBytes() const {
+  return send_ring_.Size() + oversize_bytes_.load(std::memory_order_acquire);
+}
+
+void BluetoothClassicComTransport::UpdateFlowControl() {
+  // Called by both the producer and the drain job. The unlocked checks keep the
+  // steady state lock-free; the mutex is only taken around a transition.
+  const bool backpressured = backpressured_.load(std::memory_order_acquire);
+  const size_t queued_bytes = QueuedBytes();
+  if (!backpressured && (options_.send_queue_high_watermark_bytes == 0 ||
+                         queued_bytes < options_.send_queue_high_watermark_bytes)) {
+    return;
+  }
+  if (backpressured && queued_bytes > options_.send_queue_low_watermark_bytes) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(flow_mutex_);
+  const size_t current_bytes = QueuedBytes();
+  if (!backpressured_ && options_.send_queue_high_watermark_bytes > 0 &&
+      current_bytes >= options_.send_queue_high_watermark_bytes) {
+    backpressured_ = true;
+    SendFlowControlEvent(false, current_bytes);
+  } else if (backpressured_ && current_bytes <= options_.send_queue_low_watermark_bytes) {
+    backpressured_ = false;
+    SendFlowControlEvent(true, current_bytes);
+  }
+}
+
+flutter::EncodableMap BluetoothClassicComTransport::GetStats() const {
+  flutter::EncodableMap stats;
+  stats[flutter::EncodableValue("transport")] = flutter::EncodableValue("COM");
+  stats[flutter::EncodableValue("writeBatches")] =
+      flutter::EncodableValue(static_cast<int64_t>(write_batches_.load()));
+  stats[flutter::EncodableValue("writePayloads")] =
+      flutter::EncodableValue(static_cast<int64_t>(write_payloads_.load()));
+  stats[flutter::EncodableValue("writeBytes")] =
+      flutter::EncodableValue(static_cast<int64_t>(write_bytes_.load()));
+  stats[flutter::EncodableValue("maxBatchPayloads")] =
+      flutter::EncodableValue(static_cast<int64_t>(max_batch_payloads_.load()));
+  stats[flutter::EncodableValue("maxBatchBytes")] =
+      flutter::EncodableValue(static_cast<int64_t>(max_batch_bytes_.load()));
+  stats[flutter::EncodableValue("rxEvents")] =
+      flutter::EncodableValue(static_cast<int64_t>(read_events_.load()));
+  stats[flutter::EncodableValue("rxBufferAllocations")] =
+      flutter::EncodableValue(static_cast<int64_t>(receive_pool_.allocations()));
+  return stats;
 }
 
 void BluetoothClassicComTransport::ReportDisconnected(const std::string& status) {
@@ -313,21 +449,38 @@ void BluetoothClassicComTransport::SendConnectionState(bool is_connected, const
   connection_map[flutter::EncodableValue("status")] = flutter::EncodableValue(status);
   connection_map[flutter::EncodableValue("transport")] = flutter::EncodableValue("COM");
   connection_map[flutter::EncodableValue("comPort")] = flutter::EncodableValue(com_port_);
+  connection_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(connection_id_);
   connection_handler_->Success(flutter::EncodableValue(connection_map));
 }
 
-void BluetoothClassicComTransport::SendData(const std::vector<uint8_t>& data) {
-  flutter::EncodableMap data_map;
-  data_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
-  data_map[flutter::EncodableValue("comPort")] = flutter::EncodableValue(com_port_);
+void BluetoothClassicComTransport::SendFlowControlEvent(bool writable, size_t queued_bytes) {
+  flutter::EncodableMap event_map;
+  event_map[flutter::EncodableValue("event")] =
+      flutter::EncodableValue(writable ? "writable" : "backpressure");
+  event_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
+  event_map[flutter::EncodableValue("queuedBytes")] =
+      flutter::EncodableValue(static_cast<int64_t>(queued_bytes));
+  event_map[flutter::EncodableValue("transport")] = flutter::EncodableValue("COM");
+  event_map[flutter::EncodableValue("comPort")] = flutter::EncodableValue(com_port_);
+  event_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(connection_id_);
+  connection_handler_->Success(flutter::EncodableValue(event_map));
+}
+
+void BluetoothClassicComTransport::SendData(std::vector<uint8_t>&& data) {
+  read_events_.fetch_add(1, std::memory_order_relaxed);
+  if (options_.data_event_format == DataEventFormat::kBytes) {
+    *data_slot_ = flutter::EncodableValue(std::move(data));
+  } else {
+    *data_slot_ = EncodeDataPayload(data, options_.data_event_format);
+    receive_pool_.Release(std::move(data));
+  }
+
+  data_handler_->Success(data_event_);
 
-  flutter::EncodableList data_list;
-  data_list.reserve(data.size());
-  for (uint8_t byte : data) {
-    data_list.push_back(flutter::EncodableValue(static_cast<int>(byte)));
+  // The event has been serialized by the codec; take the buffer back.
+  if (auto* bytes = std::get_if<std::vector<uint8_t>>(data_slot_)) {
+    receive_pool_.Release(std::move(*bytes));
   }
-  data_map[flutter::EncodableValue("data")] = flutter::EncodableValue(data_list);
-  data_handler_->Success(flutter::EncodableValue(data_map));
 }
 
 }  // namespace flutter_bluetooth_classic
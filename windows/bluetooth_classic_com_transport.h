@@ -4,56 +4,144 @@
 #include <flutter/encodable_value.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "bluetooth_classic_serial_port.h"
+#include "bluetooth_transport_options.h"
+#include "receive_buffer_pool.h"
+#include "spsc_byte_ring.h"
+
 namespace flutter_bluetooth_classic {
 
 template <typename T>
 class EventStreamHandler;
+class IoReactor;
+class WorkerPool;
 
-class BluetoothClassicComTransport {
+// COM-port link driven by the shared reactor and worker pool: a completed
+// WaitCommEvent schedules a read job, and queued writes schedule a drain
+// job. No thread is owned per connection. Must be held in a shared_ptr;
+// pending jobs keep the transport alive until they finish.
+class BluetoothClassicComTransport
+    : public std::enable_shared_from_this<BluetoothClassicComTransport> {
  public:
+#ifdef _WIN32
+  // Drives com_port through a Win32SerialPort on reactor.
   BluetoothClassicComTransport(
       const std::string& com_port,
       const std::string& device_address,
+      int64_t connection_id,
+      IoReactor* reactor,
+      WorkerPool* workers,
       EventStreamHandler<flutter::EncodableValue>* connection_handler,
-      EventStreamHandler<flutter::EncodableValue>* data_handler);
+      EventStreamHandler<flutter::EncodableValue>* data_handler,
+      const TransportOptions& options = TransportOptions());
+#endif
+
+  // Drives an already constructed port; com_port only labels the events.
+  BluetoothClassicComTransport(
+      std::unique_ptr<SerialPort> serial_port,
+      const std::string& com_port,
+      const std::string& device_address,
+      int64_t connection_id,
+      WorkerPool* workers,
+      EventStreamHandler<flutter::EncodableValue>* connection_handler,
+      EventStreamHandler<flutter::EncodableValue>* data_handler,
+      const TransportOptions& options = TransportOptions());
 
   ~BluetoothClassicComTransport();
 
+  // OpenPort and Start.
   bool Open(std::string* error_message);
+  // Opens the port without announcing the link or reading from it, so a
+  // connect that loses a race can still drop it without any event.
+  bool OpenPort(std::string* error_message);
+  // Announces the link and starts reading; once, after OpenPort.
+  void Start();
+  // Single producer: must always be called from the same thread (the
+  // platform thread). Copies into the send ring without taking a lock.
   void WriteData(const std::vector<uint8_t>& data);
   bool IsConnected() const { return is_connected_; }
   std::string GetDeviceAddress() const { return device_address_; }
   std::string GetComPort() const { return com_port_; }
+  int64_t GetConnectionId() const { return connection_id_; }
+  // Stops both directions. Off the worker pool this also waits until the
+  // port is closed; on a worker the last in-flight job closes it.
   void Close();
 
+  // Counters: writeBatches, writePayloads, writeBytes, maxBatchPayloads,
+  // maxBatchBytes, rxEvents and rxBufferAllocations.
+  flutter::EncodableMap GetStats() const;
+
  private:
-  std::string ToWindowsComPath(const std::string& com_port) const;
-  void StartReadLoop();
-  void StartWriteLoop();
-  void ReadLoop();
-  void WriteLoop();
+  void ArmRead();
+  void OnDataReady(SerialPort::WaitResult result, const std::string& error);
+  void ScheduleDrain();
+  void Drain();
+  void RecordBatch(size_t payloads, size_t bytes);
+  void AcquireIo();
+  void ReleaseIo();
   void ReportDisconnected(const std::string& status);
   void SendConnectionState(bool is_connected, const std::string& status);
-  void SendData(const std::vector<uint8_t>& data);
+  size_t QueuedBytes() const;
+  void UpdateFlowControl();
+  void SendFlowControlEvent(bool writable, size_t queued_bytes);
+  void SendData(std::vector<uint8_t>&& data);
 
-  void* serial_handle_ = nullptr;
+  std::unique_ptr<SerialPort> serial_port_;
   std::string com_port_;
   std::string device_address_;
+  int64_t connection_id_;
+  WorkerPool* workers_;
+  TransportOptions options_;
   std::atomic<bool> is_connected_{false};
   std::atomic<bool> should_stop_{false};
   std::atomic<bool> disconnect_reported_{false};
-  std::thread read_thread_;
-  std::thread write_thread_;
-  std::mutex write_mutex_;
-  std::condition_variable write_cv_;
-  std::deque<std::vector<uint8_t>> pending_writes_;
+  // One reference for the open port plus one per armed read chain, drain
+  // job or coalescing timer; the port is closed when it drops to zero.
+  std::atomic<int> io_refs_{0};
+  std::atomic<bool> io_open_{false};
+  std::mutex io_mutex_;
+  std::condition_variable io_cv_;
+  // port_ready_: OpenPort succeeded. port_opened_: Start handed the port
+  // to the I/O jobs, which close it.
+  std::atomic<bool> port_ready_{false};
+  bool port_opened_ = false;
+  bool port_closed_ = false;
+  SpscByteRing send_ring_;
+  // A payload larger than the ring, admitted only to an empty queue (like
+  // SendQueueBudget does) and written ahead of anything queued after it.
+  // The producer fills it while oversize_bytes_ is 0; the drain role
+  // writes it and then clears oversize_bytes_.
+  std::vector<uint8_t> oversize_payload_;
+  std::atomic<size_t> oversize_bytes_{0};
+  // Set while a drain job (or the timer standing in for it) owns the
+  // consumer side of send_ring_, so there is never more than one.
+  std::atomic<bool> drain_scheduled_{false};
+  // Set while the drain role waits on a coalescing timer; WriteData clears
+  // it to flush early once a full batch is queued.
+  std::atomic<bool> coalesce_pending_{false};
+  bool coalesce_deadline_set_ = false;
+  std::chrono::steady_clock::time_point coalesce_deadline_;
+  // Serializes backpressure/writable transitions so events stay ordered.
+  std::mutex flow_mutex_;
+  std::atomic<bool> backpressured_{false};
+  std::atomic<uint64_t> write_batches_{0};
+  std::atomic<uint64_t> write_payloads_{0};
+  std::atomic<uint64_t> write_bytes_{0};
+  std::atomic<uint64_t> max_batch_payloads_{0};
+  std::atomic<uint64_t> max_batch_bytes_{0};
+  // Receive side: pooled read buffers and a data event whose map is built
+  // once; only its "data" slot changes per read.
+  ReceiveBufferPool receive_pool_;
+  flutter::EncodableValue data_event_;
+  flutter::EncodableValue* data_slot_ = nullptr;
+  std::atomic<uint64_t> read_events_{0};
   EventStreamHandler<flutter::EncodableValue>* connection_handler_ = nullptr;
   EventStreamHandler<flutter::EncodableValue>* data_handler_ = nullptr;
 };
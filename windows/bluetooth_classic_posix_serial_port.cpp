@@ -0,0 +1,225 @@
+#include "bluetooth_classic_posix_serial_port.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include "poll_reactor.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+std::string ErrorMessage(const std::string& prefix, int error) {
+  return prefix + " (error=" + std::to_string(error) + "): " + std::strerror(error);
+}
+
+std::string LastErrorMessage(const std::string& prefix) {
+  return ErrorMessage(prefix, errno);
+}
+
+void SetError(std::string* error_message, const std::string& value) {
+  if (error_message != nullptr) {
+    *error_message = value;
+  }
+}
+
+}  // namespace
+
+PosixSerialPort::PosixSerialPort(const std::string& device_path, PollReactor* reactor)
+    : device_path_(device_path), reactor_(reactor) {}
+
+PosixSerialPort::~PosixSerialPort() {
+  Close();
+}
+
+bool PosixSerialPort::Open(std::string* error_message) {
+  if (fd_ >= 0) {
+    return true;
+  }
+
+  const int fd = open(device_path_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd < 0) {
+    SetError(error_message, LastErrorMessage("COM_OPEN_FAILED"));
+    return false;
+  }
+
+  termios settings;
+  if (tcgetattr(fd, &settings) != 0) {
+    SetError(error_message, LastErrorMessage("COM_GET_STATE_FAILED"));
+    close(fd);
+    return false;
+  }
+
+  // 115200 8N1, no flow control, no line discipline
+  cfmakeraw(&settings);
+  cfsetispeed(&settings, B115200);
+  cfsetospeed(&settings, B115200);
+  settings.c_cflag |= CLOCAL | CREAD;
+  settings.c_cflag &= ~CRTSCTS;
+  // With O_NONBLOCK a read returns whatever is buffered, or EAGAIN; waiting
+  // for data is done by the reactor instead.
+  settings.c_cc[VMIN] = 1;
+  settings.c_cc[VTIME] = 0;
+
+  if (tcsetattr(fd, TCSANOW, &settings) != 0) {
+    SetError(error_message, LastErrorMessage("COM_SET_STATE_FAILED"));
+    close(fd);
+    return false;
+  }
+
+  tcflush(fd, TCIOFLUSH);
+
+  int pipe_fds[2];
+  if (pipe2(pipe_fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+    SetError(error_message, LastErrorMessage("COM_CREATE_EVENT_FAILED"));
+    close(fd);
+    return false;
+  }
+
+  cancel_read_ = pipe_fds[0];
+  cancel_write_ = pipe_fds[1];
+  cancelled_ = false;
+  fd_ = fd;
+  return true;
+}
+
+void PosixSerialPort::BeginWaitForData(WaitCallback on_ready) {
+  const int fd = fd_;
+  if (fd < 0 || cancelled_) {
+    reactor_->Dispatch([on_ready]() { on_ready(WaitResult::kCancelled, ""); });
+    return;
+  }
+
+  // poll() is level-triggered, so input queued before the watch is armed
+  // completes it at once.
+  reactor_->Watch(fd, [on_ready](PollReactor::Event event, int error) {
+    if (event == PollReactor::Event::kReadable) {
+      on_ready(WaitResult::kDataAvailable, "");
+    } else if (event == PollReactor::Event::kCancelled) {
+      on_ready(WaitResult::kCancelled, "");
+    } else if (error == 0) {
+      on_ready(WaitResult::kError, "WAIT_COMM_EVENT_FAILED: port hung up");
+    } else {
+      on_ready(WaitResult::kError, ErrorMessage("WAIT_COMM_EVENT_FAILED", error));
+    }
+  });
+
+  // Cancel() may have run between the check above and arming the watch.
+  if (cancelled_) {
+    reactor_->Cancel(fd);
+  }
+}
+
+bool PosixSerialPort::Read(
+    uint8_t* buffer, size_t capacity, size_t* bytes_read, std::string* error_message) {
+  *bytes_read = 0;
+  if (fd_ < 0) {
+    SetError(error_message, "READ_FAILED: port closed");
+    return false;
+  }
+
+  while (true) {
+    const ssize_t result = read(fd_, buffer, capacity);
+    if (result > 0) {
+      *bytes_read = static_cast<size_t>(result);
+      return true;
+    }
+    if (result == 0) {
+      // End of file on a tty: the other side hung up.
+      SetError(error_message, "READ_FAILED: port hung up");
+      return false;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return true;
+    }
+    if (errno != EINTR) {
+      SetError(error_message, LastErrorMessage("READ_FAILED"));
+      return false;
+    }
+  }
+}
+
+bool PosixSerialPort::Write(const uint8_t* data, size_t size, std::string* error_message) {
+  if (fd_ < 0) {
+    SetError(error_message, "WRITE_ERROR: port closed");
+    return false;
+  }
+
+  const uint8_t* cursor = data;
+  size_t remaining = size;
+  while (remaining > 0) {
+    if (cancelled_) {
+      SetError(error_message, ErrorMessage("WRITE_ERROR", ECANCELED));
+      return false;
+    }
+
+    const ssize_t written = write(fd_, cursor, remaining);
+    if (written > 0) {
+      cursor += written;
+      remaining -= static_cast<size_t>(written);
+      continue;
+    }
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      SetError(error_message, LastErrorMessage("WRITE_ERROR"));
+      return false;
+    }
+
+    // Output queue full: wait for room or for Cancel().
+    pollfd fds[2] = {{fd_, POLLOUT, 0}, {cancel_read_, POLLIN, 0}};
+    if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+      SetError(error_message, LastErrorMessage("WRITE_ERROR"));
+      return false;
+    }
+    if (fds[1].revents != 0) {
+      SetError(error_message, ErrorMessage("WRITE_ERROR", ECANCELED));
+      return false;
+    }
+    if ((fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0 && (fds[0].revents & POLLOUT) == 0) {
+      SetError(error_message, "WRITE_ERROR: port hung up");
+      return false;
+    }
+  }
+  return true;
+}
+
+void PosixSerialPort::Cancel() {
+  cancelled_ = true;
+  if (cancel_write_ >= 0) {
+    const char byte = 0;
+    [[maybe_unused]] const ssize_t written = write(cancel_write_, &byte, 1);
+  }
+  // Completes the armed watch with kCancelled.
+  if (fd_ >= 0) {
+    reactor_->Cancel(fd_);
+  }
+}
+
+void PosixSerialPort::Close() {
+  Cancel();
+
+  if (fd_ >= 0) {
+    tcflush(fd_, TCIOFLUSH);
+    close(fd_);
+  }
+  fd_ = -1;
+  ClosePipe();
+}
+
+void PosixSerialPort::ClosePipe() {
+  for (int* fd : {&cancel_read_, &cancel_write_}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+}  // namespace flutter_bluetooth_classic
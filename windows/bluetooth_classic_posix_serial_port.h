@@ -0,0 +1,46 @@
+#ifndef FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_POSIX_SERIAL_PORT_H_
+#define FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_POSIX_SERIAL_PORT_H_
+
+#include <atomic>
+#include <string>
+
+#include "bluetooth_classic_serial_port.h"
+
+namespace flutter_bluetooth_classic {
+
+class PollReactor;
+
+// termios serial device (an RFCOMM tty, or a pty in tests). Waits are
+// one-shot poll() watches on the shared PollReactor instead of a reader
+// thread sleeping between non-blocking reads, so idle links cost no CPU and
+// no thread, and a burst is picked up as soon as the driver signals it.
+class PosixSerialPort : public SerialPort {
+ public:
+  PosixSerialPort(const std::string& device_path, PollReactor* reactor);
+  ~PosixSerialPort() override;
+
+  PosixSerialPort(const PosixSerialPort&) = delete;
+  PosixSerialPort& operator=(const PosixSerialPort&) = delete;
+
+  bool Open(std::string* error_message) override;
+  void BeginWaitForData(WaitCallback on_ready) override;
+  bool Read(uint8_t* buffer, size_t capacity, size_t* bytes_read, std::string* error_message) override;
+  bool Write(const uint8_t* data, size_t size, std::string* error_message) override;
+  void Cancel() override;
+  void Close() override;
+
+ private:
+  void ClosePipe();
+
+  std::string device_path_;
+  PollReactor* reactor_;
+  int fd_ = -1;
+  // Wakes a Write blocked on a full output queue.
+  int cancel_read_ = -1;
+  int cancel_write_ = -1;
+  std::atomic<bool> cancelled_{false};
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_POSIX_SERIAL_PORT_H_
@@ -0,0 +1,49 @@
+#ifndef FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_SERIAL_PORT_H_
+#define FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_SERIAL_PORT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace flutter_bluetooth_classic {
+
+// Event-driven serial I/O used by BluetoothClassicComTransport.
+//
+// Waiting for input is asynchronous so no thread is parked per port; reads
+// and writes are short blocking calls made from worker jobs. The receive
+// side (BeginWaitForData/Read) and Write may run concurrently. Cancel() may
+// be called from any thread and aborts every pending call.
+class SerialPort {
+ public:
+  enum class WaitResult {
+    kDataAvailable,
+    kCancelled,
+    kError,
+  };
+
+  using WaitCallback = std::function<void(WaitResult result, const std::string& error_message)>;
+
+  virtual ~SerialPort() = default;
+
+  virtual bool Open(std::string* error_message) = 0;
+
+  // Arms a one-shot wait and returns immediately. on_ready runs exactly once
+  // on a worker thread when the driver has at least one byte, the wait is
+  // cancelled or the port fails. Never polls. At most one wait is armed.
+  virtual void BeginWaitForData(WaitCallback on_ready) = 0;
+
+  // Copies whatever is already buffered (up to capacity) without blocking.
+  // A zero-byte result means the input queue is drained.
+  virtual bool Read(uint8_t* buffer, size_t capacity, size_t* bytes_read, std::string* error_message) = 0;
+
+  // Blocks until every byte has been handed to the driver.
+  virtual bool Write(const uint8_t* data, size_t size, std::string* error_message) = 0;
+
+  virtual void Cancel() = 0;
+  virtual void Close() = 0;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_SERIAL_PORT_H_
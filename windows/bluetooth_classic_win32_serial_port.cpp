@@ -0,0 +1,304 @@
+#include "bluetooth_classic_win32_serial_port.h"
+
+#include <windows.h>
+
+#include <string>
+
+#include "io_reactor.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+std::string ErrorMessage(const std::string& prefix, DWORD error) {
+  char* buffer = nullptr;
+  FormatMessageA(
+      FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+      nullptr,
+      error,
+      MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+      reinterpret_cast<LPSTR>(&buffer),
+      0,
+      nullptr);
+
+  std::string result = prefix + " (error=" + std::to_string(error) + ")";
+  if (buffer != nullptr) {
+    result += ": ";
+    result += buffer;
+    LocalFree(buffer);
+  }
+  return result;
+}
+
+std::string LastErrorMessage(const std::string& prefix) {
+  return ErrorMessage(prefix, GetLastError());
+}
+
+void SetError(std::string* error_message, const std::string& value) {
+  if (error_message != nullptr) {
+    *error_message = value;
+  }
+}
+
+// Reads and writes wait on their own event; the low bit keeps their
+// completions off the reactor's port.
+HANDLE TagNoCompletionPort(void* event) {
+  return reinterpret_cast<HANDLE>(reinterpret_cast<ULONG_PTR>(event) | 1);
+}
+
+}  // namespace
+
+Win32SerialPort::Win32SerialPort(const std::string& com_port, IoReactor* reactor)
+    : com_port_(com_port), reactor_(reactor) {}
+
+Win32SerialPort::~Win32SerialPort() {
+  Close();
+}
+
+bool Win32SerialPort::Open(std::string* error_message) {
+  if (handle_ != nullptr) {
+    return true;
+  }
+
+  const std::string com_path = ToWindowsComPath(com_port_);
+  HANDLE handle = CreateFileA(
+      com_path.c_str(),
+      GENERIC_READ | GENERIC_WRITE,
+      0,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+      nullptr);
+
+  if (handle == INVALID_HANDLE_VALUE) {
+    SetError(error_message, LastErrorMessage("COM_OPEN_FAILED"));
+    return false;
+  }
+
+  DCB dcb;
+  SecureZeroMemory(&dcb, sizeof(dcb));
+  dcb.DCBlength = sizeof(dcb);
+  if (!GetCommState(handle, &dcb)) {
+    SetError(error_message, LastErrorMessage("COM_GET_STATE_FAILED"));
+    CloseHandle(handle);
+    return false;
+  }
+
+  dcb.BaudRate = CBR_115200;
+  dcb.ByteSize = 8;
+  dcb.StopBits = ONESTOPBIT;
+  dcb.Parity = NOPARITY;
+  dcb.fOutxCtsFlow = FALSE;
+  dcb.fOutxDsrFlow = FALSE;
+  dcb.fDtrControl = DTR_CONTROL_ENABLE;
+  dcb.fRtsControl = RTS_CONTROL_ENABLE;
+  dcb.fOutX = FALSE;
+  dcb.fInX = FALSE;
+
+  if (!SetCommState(handle, &dcb)) {
+    SetError(error_message, LastErrorMessage("COM_SET_STATE_FAILED"));
+    CloseHandle(handle);
+    return false;
+  }
+
+  COMMTIMEOUTS timeouts;
+  SecureZeroMemory(&timeouts, sizeof(timeouts));
+  // ReadFile returns immediately with whatever is buffered; waiting for data
+  // is done by WaitCommEvent instead.
+  timeouts.ReadIntervalTimeout = MAXDWORD;
+  timeouts.ReadTotalTimeoutConstant = 0;
+  timeouts.ReadTotalTimeoutMultiplier = 0;
+  timeouts.WriteTotalTimeoutConstant = 100;
+  timeouts.WriteTotalTimeoutMultiplier = 0;
+  SetupComm(handle, 65536, 65536);
+  SetCommTimeouts(handle, &timeouts);
+
+  if (!SetCommMask(handle, EV_RXCHAR)) {
+    SetError(error_message, LastErrorMessage("COM_SET_MASK_FAILED"));
+    CloseHandle(handle);
+    return false;
+  }
+
+  PurgeComm(handle, PURGE_RXCLEAR | PURGE_TXCLEAR);
+
+  if (!reactor_->Associate(handle, error_message)) {
+    CloseHandle(handle);
+    return false;
+  }
+
+  read_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  write_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  cancel_event_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+  if (read_event_ == nullptr || write_event_ == nullptr || cancel_event_ == nullptr) {
+    SetError(error_message, LastErrorMessage("COM_CREATE_EVENT_FAILED"));
+    CloseEvents();
+    CloseHandle(handle);
+    return false;
+  }
+
+  handle_ = handle;
+  return true;
+}
+
+void Win32SerialPort::BeginWaitForData(WaitCallback on_ready) {
+  HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+  if (handle == nullptr || WaitForSingleObject(cancel_event_, 0) == WAIT_OBJECT_0) {
+    reactor_->Dispatch([on_ready]() { on_ready(WaitResult::kCancelled, ""); });
+    return;
+  }
+
+  // EV_RXCHAR only fires for bytes that arrive after the wait is armed, so
+  // anything already queued has to be picked up first.
+  DWORD errors = 0;
+  COMSTAT status;
+  if (!ClearCommError(handle, &errors, &status)) {
+    const std::string error = LastErrorMessage("CLEAR_COMM_FAILED");
+    reactor_->Dispatch([on_ready, error]() { on_ready(WaitResult::kError, error); });
+    return;
+  }
+  if (status.cbInQue > 0) {
+    reactor_->Dispatch([on_ready]() { on_ready(WaitResult::kDataAvailable, ""); });
+    return;
+  }
+
+  OVERLAPPED* overlapped = reactor_->BeginOperation([on_ready](uint32_t error, uint32_t) {
+    if (error == ERROR_SUCCESS) {
+      on_ready(WaitResult::kDataAvailable, "");
+    } else if (error == ERROR_OPERATION_ABORTED) {
+      on_ready(WaitResult::kCancelled, "");
+    } else {
+      on_ready(WaitResult::kError, ErrorMessage("WAIT_COMM_EVENT_FAILED", error));
+    }
+  });
+
+  // A completion packet is queued whether the call finishes now or later.
+  if (!WaitCommEvent(handle, &wait_event_mask_, overlapped) && GetLastError() != ERROR_IO_PENDING) {
+    const std::string error = LastErrorMessage("WAIT_COMM_EVENT_FAILED");
+    reactor_->AbandonOperation(overlapped);
+    reactor_->Dispatch([on_ready, error]() { on_ready(WaitResult::kError, error); });
+    return;
+  }
+
+  // Cancel() may have run between the check above and arming the wait.
+  if (WaitForSingleObject(cancel_event_, 0) == WAIT_OBJECT_0) {
+    CancelIoEx(handle, overlapped);
+  }
+}
+
+bool Win32SerialPort::Read(
+    uint8_t* buffer, size_t capacity, size_t* bytes_read, std::string* error_message) {
+  *bytes_read = 0;
+  HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+  if (handle == nullptr) {
+    SetError(error_message, "READ_FAILED: port closed");
+    return false;
+  }
+
+  OVERLAPPED overlapped;
+  SecureZeroMemory(&overlapped, sizeof(overlapped));
+  ResetEvent(reinterpret_cast<HANDLE>(read_event_));
+  overlapped.hEvent = TagNoCompletionPort(read_event_);
+
+  DWORD transferred = 0;
+  if (!ReadFile(handle, buffer, static_cast<DWORD>(capacity), &transferred, &overlapped)) {
+    if (GetLastError() != ERROR_IO_PENDING) {
+      SetError(error_message, LastErrorMessage("READ_FAILED"));
+      return false;
+    }
+    // With ReadIntervalTimeout = MAXDWORD this completes without waiting
+    // for more data.
+    if (!GetOverlappedResult(handle, &overlapped, &transferred, TRUE)) {
+      SetError(error_message, LastErrorMessage("READ_FAILED"));
+      return false;
+    }
+  }
+
+  *bytes_read = transferred;
+  return true;
+}
+
+bool Win32SerialPort::Write(const uint8_t* data, size_t size, std::string* error_message) {
+  HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+  if (handle == nullptr) {
+    SetError(error_message, "WRITE_ERROR: port closed");
+    return false;
+  }
+
+  const uint8_t* cursor = data;
+  size_t remaining = size;
+  while (remaining > 0) {
+    OVERLAPPED overlapped;
+    SecureZeroMemory(&overlapped, sizeof(overlapped));
+    ResetEvent(reinterpret_cast<HANDLE>(write_event_));
+    overlapped.hEvent = TagNoCompletionPort(write_event_);
+
+    DWORD bytes_written = 0;
+    if (!WriteFile(handle, cursor, static_cast<DWORD>(remaining), &bytes_written, &overlapped)) {
+      if (GetLastError() != ERROR_IO_PENDING) {
+        SetError(error_message, LastErrorMessage("WRITE_ERROR"));
+        return false;
+      }
+
+      HANDLE wait_handles[2] = {overlapped.hEvent, reinterpret_cast<HANDLE>(cancel_event_)};
+      const DWORD signaled = WaitForMultipleObjects(2, wait_handles, FALSE, INFINITE);
+      if (signaled != WAIT_OBJECT_0) {
+        CancelIoEx(handle, &overlapped);
+        GetOverlappedResult(handle, &overlapped, &bytes_written, TRUE);
+        SetError(error_message, ErrorMessage("WRITE_ERROR", ERROR_OPERATION_ABORTED));
+        return false;
+      }
+      if (!GetOverlappedResult(handle, &overlapped, &bytes_written, FALSE)) {
+        SetError(error_message, LastErrorMessage("WRITE_ERROR"));
+        return false;
+      }
+    }
+
+    if (bytes_written == 0) {
+      SetError(error_message, "WRITE_ERROR: write timed out");
+      return false;
+    }
+    cursor += bytes_written;
+    remaining -= bytes_written;
+  }
+  return true;
+}
+
+void Win32SerialPort::Cancel() {
+  if (cancel_event_ != nullptr) {
+    SetEvent(reinterpret_cast<HANDLE>(cancel_event_));
+  }
+  // Completes the armed WaitCommEvent with ERROR_OPERATION_ABORTED.
+  HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+  if (handle != nullptr) {
+    CancelIoEx(handle, nullptr);
+  }
+}
+
+void Win32SerialPort::Close() {
+  Cancel();
+
+  HANDLE handle = reinterpret_cast<HANDLE>(handle_);
+  if (handle != nullptr && handle != INVALID_HANDLE_VALUE) {
+    PurgeComm(handle, PURGE_RXABORT | PURGE_TXABORT | PURGE_RXCLEAR | PURGE_TXCLEAR);
+    CloseHandle(handle);
+  }
+  handle_ = nullptr;
+  CloseEvents();
+}
+
+std::string Win32SerialPort::ToWindowsComPath(const std::string& com_port) const {
+  if (com_port.rfind("\\\\.\\", 0) == 0) {
+    return com_port;
+  }
+  return "\\\\.\\" + com_port;
+}
+
+void Win32SerialPort::CloseEvents() {
+  for (void** event : {&read_event_, &write_event_, &cancel_event_}) {
+    if (*event != nullptr) {
+      CloseHandle(reinterpret_cast<HANDLE>(*event));
+      *event = nullptr;
+    }
+  }
+}
+
+}  // namespace flutter_bluetooth_classic
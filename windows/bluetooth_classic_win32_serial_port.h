@@ -0,0 +1,47 @@
+#ifndef FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_WIN32_SERIAL_PORT_H_
+#define FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_WIN32_SERIAL_PORT_H_
+
+#include <string>
+
+#include "bluetooth_classic_serial_port.h"
+
+namespace flutter_bluetooth_classic {
+
+class IoReactor;
+
+// Overlapped COM port. Waits are WaitCommEvent(EV_RXCHAR) calls completed
+// through the shared IoReactor instead of polling ClearCommError, so idle
+// links cost no CPU and no thread, and a burst is picked up as soon as the
+// driver signals it.
+class Win32SerialPort : public SerialPort {
+ public:
+  Win32SerialPort(const std::string& com_port, IoReactor* reactor);
+  ~Win32SerialPort() override;
+
+  Win32SerialPort(const Win32SerialPort&) = delete;
+  Win32SerialPort& operator=(const Win32SerialPort&) = delete;
+
+  bool Open(std::string* error_message) override;
+  void BeginWaitForData(WaitCallback on_ready) override;
+  bool Read(uint8_t* buffer, size_t capacity, size_t* bytes_read, std::string* error_message) override;
+  bool Write(const uint8_t* data, size_t size, std::string* error_message) override;
+  void Cancel() override;
+  void Close() override;
+
+ private:
+  std::string ToWindowsComPath(const std::string& com_port) const;
+  void CloseEvents();
+
+  std::string com_port_;
+  IoReactor* reactor_;
+  void* handle_ = nullptr;
+  // Written by the driver when the armed WaitCommEvent completes.
+  unsigned long wait_event_mask_ = 0;
+  void* read_event_ = nullptr;
+  void* write_event_ = nullptr;
+  void* cancel_event_ = nullptr;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_BLUETOOTH_CLASSIC_WIN32_SERIAL_PORT_H_
@@ -3,8 +3,10 @@
 
 #include <winrt/Windows.Foundation.h>
 #include <winerror.h>
-#include <future>
-#include <thread>
+#include <optional>
+#include <stdexcept>
+
+#include "worker_pool.h"
 
 using namespace winrt;
 using namespace Windows::Foundation;
@@ -12,18 +14,38 @@ using namespace Windows::Networking::Sockets;
 using namespace Windows::Storage::Streams;
 
 namespace flutter_bluetooth_classic {
+namespace {
+
+constexpr uint32_t kReadChunkSize = 1024;
+constexpr size_t kPooledReadBuffers = 4;
+
+}  // namespace
 
 BluetoothConnection::BluetoothConnection(
     StreamSocket socket,
     const std::string& device_address,
+    int64_t connection_id,
+    WorkerPool* workers,
     EventStreamHandler<flutter::EncodableValue>* connection_handler,
-    EventStreamHandler<flutter::EncodableValue>* data_handler)
+    EventStreamHandler<flutter::EncodableValue>* data_handler,
+    const TransportOptions& options)
     : socket_(socket),
       device_address_(device_address),
+      connection_id_(connection_id),
+      options_(options),
+      workers_(workers),
+      pending_writes_(options),
+      receive_pool_(kReadChunkSize, kPooledReadBuffers),
       connection_handler_(connection_handler),
       data_handler_(data_handler),
       is_connected_(true) {
-  
+  flutter::EncodableMap data_map;
+  data_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
+  data_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(connection_id_);
+  data_map[flutter::EncodableValue("data")] = flutter::EncodableValue(std::vector<uint8_t>());
+  data_event_ = flutter::EncodableValue(std::move(data_map));
+  data_slot_ = &std::get<flutter::EncodableMap>(data_event_)[flutter::EncodableValue("data")];
+
   try {
     // Get input and output streams
     data_reader_ = DataReader(socket_.InputStream());
@@ -31,12 +53,6 @@ BluetoothConnection::BluetoothConnection(
     
     // Configure reader for efficient reading
     data_reader_.InputStreamOptions(InputStreamOptions::Partial);
-
-    // Send connection success event
-    SendConnectionState(true, "CONNECTED");
-
-    // Start reading data
-    StartReadLoop();
   }
   catch (hresult_error const& ex) {
     is_connected_ = false;
@@ -50,143 +66,271 @@ BluetoothConnection::~BluetoothConnection() {
   Close();
 }
 
-void BluetoothConnection::WriteData(const std::vector<uint8_t>& data) {
+void BluetoothConnection::Start() {
+  if (!is_connected_) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    io_started_ = true;
+    io_finished_ = false;
+  }
+  io_refs_ = 1;
+  io_open_ = true;
+
+  // Send connection success event
+  SendConnectionState(true, "CONNECTED");
+
+  AcquireIo();
+  ArmRead();
+}
+
+void BluetoothConnection::WriteData(const std::vector<uint8_t>& data, WriteCallback on_complete) {
   if (!is_connected_ || !data_writer_) {
     throw hresult_error(E_FAIL, L"Not connected");
   }
 
-  try {
-    // Write data to buffer
-    data_writer_.WriteBytes(data);
-    
-    // Flush to socket (run on background thread to avoid STA issues)
-    auto store_async = data_writer_.StoreAsync();
-    
-    std::promise<void> promise;
-    auto future = promise.get_future();
-    std::thread worker([op = std::move(store_async), &promise]() {
-      winrt::init_apartment(winrt::apartment_type::multi_threaded);
-      try {
-        op.get();
-        promise.set_value();
-      } catch (...) {
-        try {
-          promise.set_exception(std::current_exception());
-        } catch (...) {}
-      }
-      winrt::uninit_apartment();
-    });
-    
-    worker.join();  // Use join instead of detach to ensure proper cleanup
-    future.get();   // Get result or rethrow exception
+  SendQueueBudget::Transition transition = SendQueueBudget::Transition::kNone;
+  size_t queued_bytes = 0;
+  bool schedule_drain = false;
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    // Checked under the lock so Close() either fails this write or never
+    // sees it queued.
+    if (should_stop_) {
+      throw hresult_error(E_FAIL, L"Not connected");
+    }
+    if (!pending_writes_.Push(data, std::move(on_complete), &transition, &schedule_drain)) {
+      throw std::runtime_error("RFCOMM send queue is full");
+    }
+    queued_bytes = pending_writes_.queued_bytes();
+    if (schedule_drain) {
+      AcquireIo();
+    }
   }
-  catch (hresult_error const& ex) {
-    is_connected_ = false;
-    std::wstring msg_wide = ex.message().c_str();
-    std::string msg(msg_wide.begin(), msg_wide.end());
-    SendConnectionState(false, "WRITE_ERROR: " + msg);
-    throw;
+  if (schedule_drain) {
+    auto self = shared_from_this();
+    // A pool that is shutting down drops the job; its reference goes with it.
+    if (!workers_->Post([self]() { self->Drain(); })) {
+      ReleaseIo();
+    }
   }
+  SendFlowControlEvent(transition, queued_bytes);
 }
 
 void BluetoothConnection::Close() {
-  if (!is_connected_) {
-    return;
+  // The read chain or drain job may already have dropped is_connected_
+  // after a failure; their references still need to be released here.
+  const bool was_connected = is_connected_.exchange(false);
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    should_stop_ = true;
+  }
+  bool started = false;
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    started = io_started_;
   }
 
-  is_connected_ = false;
-  should_stop_ = true;
-
-  // Close socket first to unblock any pending reads on the read thread
-  // This must be done BEFORE joining the thread to prevent deadlock
+  // Aborts the pending LoadAsync and any in-flight StoreAsync; their
+  // completions see should_stop_ and drop their references.
   try {
     if (socket_) {
       socket_.Close();
-      socket_ = nullptr;
     }
   }
   catch (...) {
     // Ignore errors during socket close
   }
 
-  // Now wait for read thread to finish (it will exit because socket is closed)
-  if (read_thread_.joinable()) {
-    read_thread_.join();
+  if (io_open_.exchange(false)) {
+    ReleaseIo();
   }
+  // A job queued behind this worker could never run if it blocked here.
+  if (!workers_->IsWorkerThread()) {
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    io_cv_.wait(lock, [this]() { return io_finished_ || !io_started_; });
+  }
+  FailPendingWrites("DISCONNECTED");
+
+  // Send disconnection event; a link that never started was never announced
+  if (was_connected && started) {
+    SendConnectionState(false, "DISCONNECTED");
+  }
+}
 
-  // Clean up streams (safe to do now that read thread is done)
+void BluetoothConnection::AcquireIo() {
+  io_refs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BluetoothConnection::ReleaseIo() {
+  if (io_refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  // Clean up streams (safe now that no read or write is in flight)
   try {
     if (data_reader_) {
       data_reader_.Close();
-      data_reader_ = nullptr;
     }
-
     if (data_writer_) {
       data_writer_.Close();
-      data_writer_ = nullptr;
     }
   }
   catch (...) {
     // Ignore errors during cleanup
   }
-
-  // Send disconnection event
-  SendConnectionState(false, "DISCONNECTED");
+  {
+    std::lock_guard<std::mutex> lock(io_mutex_);
+    io_finished_ = true;
+  }
+  io_cv_.notify_all();
 }
 
-void BluetoothConnection::StartReadLoop() {
-  // Start read thread
-  read_thread_ = std::thread([this]() {
-    ReadLoop();
-  });
+void BluetoothConnection::ArmRead() {
+  // Loads that complete synchronously are handled here rather than by
+  // recursing through their completion.
+  while (true) {
+    IAsyncOperation<uint32_t> operation{nullptr};
+    try {
+      operation = data_reader_.LoadAsync(kReadChunkSize);
+    }
+    catch (...) {
+      if (is_connected_.exchange(false) && !should_stop_) {
+        SendConnectionState(false, "DISCONNECTED: Unknown error");
+      }
+      ReleaseIo();
+      return;
+    }
+
+    if (operation.Status() == AsyncStatus::Started) {
+      // The completion fires on the OS thread pool; hop to the worker pool
+      // so every callback of this connection runs on the same executor.
+      auto self = shared_from_this();
+      operation.Completed([self](IAsyncOperation<uint32_t> const& completed, AsyncStatus) {
+        const bool posted = self->workers_->Post([self, completed]() {
+          if (self->HandleLoad(completed)) {
+            self->ArmRead();
+          }
+        });
+        if (!posted) {
+          self->ReleaseIo();
+        }
+      });
+      return;
+    }
+    if (!HandleLoad(operation)) {
+      return;
+    }
+  }
 }
 
-void BluetoothConnection::ReadLoop() {
-  // Initialize WinRT apartment for this background thread
-  winrt::init_apartment(winrt::apartment_type::multi_threaded);
-  
-  const uint32_t buffer_size = 1024;
-  
-  while (is_connected_ && !should_stop_) {
-    try {
-      // Load data from socket
-      auto load_async = data_reader_.LoadAsync(buffer_size);
-      uint32_t bytes_read = load_async.get();
+bool BluetoothConnection::HandleLoad(IAsyncOperation<uint32_t> const& operation) {
+  if (should_stop_ || !is_connected_) {
+    ReleaseIo();
+    return false;
+  }
 
-      if (bytes_read == 0) {
-        // Connection closed
-        is_connected_ = false;
+  try {
+    const uint32_t bytes_read = operation.GetResults();
+    if (bytes_read == 0) {
+      // Connection closed
+      if (is_connected_.exchange(false)) {
         SendConnectionState(false, "DISCONNECTED: Remote device closed connection");
+      }
+      ReleaseIo();
+      return false;
+    }
+
+    // Read bytes into a pooled buffer (capacity >= kReadChunkSize)
+    std::vector<uint8_t> data = receive_pool_.Acquire();
+    data.resize(bytes_read);
+    data_reader_.ReadBytes(data);
+
+    // Send data to Flutter
+    SendData(std::move(data));
+    return true;
+  }
+  catch (hresult_error const& ex) {
+    if (is_connected_.exchange(false)) {
+      std::wstring msg_wide = ex.message().c_str();
+      std::string msg(msg_wide.begin(), msg_wide.end());
+      SendConnectionState(false, "DISCONNECTED: " + msg);
+    }
+  }
+  catch (...) {
+    if (is_connected_.exchange(false)) {
+      SendConnectionState(false, "DISCONNECTED: Unknown error");
+    }
+  }
+  ReleaseIo();
+  return false;
+}
+
+void BluetoothConnection::Drain() {
+  // StoreAsync().get() blocks, which is fine on an MTA worker
+  while (true) {
+    WriteQueue::Write next_write;
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      if (should_stop_) {
+        // Close() fails whatever is still queued
+        pending_writes_.EndDrain();
         break;
       }
+      std::optional<WriteQueue::Write> next = pending_writes_.Pop();
+      if (!next) {
+        break;
+      }
+      next_write = std::move(*next);
+    }
 
-      // Read bytes from buffer
-      std::vector<uint8_t> data(bytes_read);
-      data_reader_.ReadBytes(data);
+    try {
+      data_writer_.WriteBytes(next_write.data);
+      data_writer_.StoreAsync().get();
+      if (next_write.on_complete) {
+        next_write.on_complete(true, "");
+      }
 
-      // Send data to Flutter
-      SendData(data);
+      SendQueueBudget::Transition transition = SendQueueBudget::Transition::kNone;
+      size_t queued_bytes = 0;
+      {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        transition = pending_writes_.Release(next_write.data.size());
+        queued_bytes = pending_writes_.queued_bytes();
+      }
+      SendFlowControlEvent(transition, queued_bytes);
     }
     catch (hresult_error const& ex) {
-      if (is_connected_) {
-        is_connected_ = false;
-        std::wstring msg_wide = ex.message().c_str();
-        std::string msg(msg_wide.begin(), msg_wide.end());
-        SendConnectionState(false, "DISCONNECTED: " + msg);
+      std::wstring msg_wide = ex.message().c_str();
+      std::string msg(msg_wide.begin(), msg_wide.end());
+      if (next_write.on_complete) {
+        next_write.on_complete(false, msg);
       }
-      break;
-    }
-    catch (...) {
-      if (is_connected_) {
-        is_connected_ = false;
-        SendConnectionState(false, "DISCONNECTED: Unknown error");
+      if (is_connected_.exchange(false)) {
+        SendConnectionState(false, "WRITE_ERROR: " + msg);
       }
+      // The drain job stays scheduled: nothing more can be flushed
+      FailPendingWrites("WRITE_ERROR: " + msg);
       break;
     }
   }
-  
-  // Uninitialize apartment before thread exits
-  winrt::uninit_apartment();
+
+  ReleaseIo();
+}
+
+void BluetoothConnection::FailPendingWrites(const std::string& error) {
+  std::deque<WriteQueue::Write> failed;
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    failed = pending_writes_.TakeAll();
+  }
+  for (auto& write : failed) {
+    if (write.on_complete) {
+      write.on_complete(false, error);
+    }
+  }
 }
 
 void BluetoothConnection::SendConnectionState(bool is_connected, const std::string& status) {
@@ -194,24 +338,55 @@ void BluetoothConnection::SendConnectionState(bool is_connected, const std::stri
   connection_map[flutter::EncodableValue("isConnected")] = flutter::EncodableValue(is_connected);
   connection_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
   connection_map[flutter::EncodableValue("status")] = flutter::EncodableValue(status);
+  connection_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(connection_id_);
   
   connection_handler_->Success(flutter::EncodableValue(connection_map));
 }
 
-void BluetoothConnection::SendData(const std::vector<uint8_t>& data) {
-  flutter::EncodableMap data_map;
-  data_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
-  
-  // Convert bytes to list of ints for Flutter
-  flutter::EncodableList data_list;
-  data_list.reserve(data.size());
-  for (uint8_t byte : data) {
-    data_list.push_back(flutter::EncodableValue(static_cast<int>(byte)));
+void BluetoothConnection::SendFlowControlEvent(
+    SendQueueBudget::Transition transition, size_t queued_bytes) {
+  if (transition == SendQueueBudget::Transition::kNone) {
+    return;
   }
-  
-  data_map[flutter::EncodableValue("data")] = flutter::EncodableValue(data_list);
-  
-  data_handler_->Success(flutter::EncodableValue(data_map));
+
+  flutter::EncodableMap event_map;
+  event_map[flutter::EncodableValue("event")] = flutter::EncodableValue(
+      transition == SendQueueBudget::Transition::kBackpressure ? "backpressure" : "writable");
+  event_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address_);
+  event_map[flutter::EncodableValue("queuedBytes")] =
+      flutter::EncodableValue(static_cast<int64_t>(queued_bytes));
+  event_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(connection_id_);
+
+  connection_handler_->Success(flutter::EncodableValue(event_map));
+}
+
+void BluetoothConnection::SendData(std::vector<uint8_t>&& data) {
+  read_events_.fetch_add(1, std::memory_order_relaxed);
+
+  // Uint8List by default; boxed ints only when the legacy format was requested
+  if (options_.data_event_format == DataEventFormat::kBytes) {
+    *data_slot_ = flutter::EncodableValue(std::move(data));
+  } else {
+    *data_slot_ = EncodeDataPayload(data, options_.data_event_format);
+    receive_pool_.Release(std::move(data));
+  }
+
+  data_handler_->Success(data_event_);
+
+  // The codec has serialized the event, so the buffer can be reused
+  if (auto* bytes = std::get_if<std::vector<uint8_t>>(data_slot_)) {
+    receive_pool_.Release(std::move(*bytes));
+  }
+}
+
+flutter::EncodableMap BluetoothConnection::GetStats() const {
+  flutter::EncodableMap stats;
+  stats[flutter::EncodableValue("transport")] = flutter::EncodableValue("WINRT");
+  stats[flutter::EncodableValue("rxEvents")] =
+      flutter::EncodableValue(static_cast<int64_t>(read_events_.load()));
+  stats[flutter::EncodableValue("rxBufferAllocations")] =
+      flutter::EncodableValue(static_cast<int64_t>(receive_pool_.allocations()));
+  return stats;
 }
 
 }  // namespace flutter_bluetooth_classic
@@ -13,26 +13,48 @@
 #include <string>
 #include <vector>
 #include <atomic>
-#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <functional>
 
+#include "bluetooth_send_queue_budget.h"
+#include "bluetooth_transport_options.h"
+#include "receive_buffer_pool.h"
+#include "write_queue.h"
+
 namespace flutter_bluetooth_classic {
 
 template<typename T>
 class EventStreamHandler;
+class WorkerPool;
 
-class BluetoothConnection {
+// RFCOMM link over a WinRT StreamSocket. Reads are chained LoadAsync
+// completions and writes run as drain jobs on the shared worker pool, so no
+// thread is owned per connection. Must be held in a shared_ptr and started
+// with Start() once constructed.
+class BluetoothConnection : public std::enable_shared_from_this<BluetoothConnection> {
 public:
+  // Invoked on a worker once a payload has been flushed (or failed).
+  using WriteCallback = WriteQueue::Callback;
+
   BluetoothConnection(
       winrt::Windows::Networking::Sockets::StreamSocket socket,
       const std::string& device_address,
+      int64_t connection_id,
+      WorkerPool* workers,
       EventStreamHandler<flutter::EncodableValue>* connection_handler,
-      EventStreamHandler<flutter::EncodableValue>* data_handler);
+      EventStreamHandler<flutter::EncodableValue>* data_handler,
+      const TransportOptions& options = TransportOptions());
 
   ~BluetoothConnection();
 
-  // Write data to the connection
-  void WriteData(const std::vector<uint8_t>& data);
+  // Reports CONNECTED and arms the first read.
+  void Start();
+
+  // Queue data for the drain job. Throws if not connected or if the
+  // send budget is exhausted; otherwise on_complete reports the flush result.
+  void WriteData(const std::vector<uint8_t>& data, WriteCallback on_complete);
 
   // Check if connection is active
   bool IsConnected() const { return is_connected_; }
@@ -40,21 +62,42 @@ public:
   // Get device address
   std::string GetDeviceAddress() const { return device_address_; }
 
-  // Close the connection
+  // Handle of this connection in the manager's connection table
+  int64_t GetConnectionId() const { return connection_id_; }
+
+  // Close the connection. Off the worker pool this also waits for in-flight
+  // reads and writes to finish. A connection that was never started closes
+  // without reporting DISCONNECTED.
   void Close();
 
+  // Counters: rxEvents and rxBufferAllocations
+  flutter::EncodableMap GetStats() const;
+
 private:
-  // Start reading data from the socket
-  void StartReadLoop();
+  // Issue LoadAsync until one stays pending, then resume in its completion
+  void ArmRead();
+
+  // Deliver one completed load; false once the read chain has ended
+  bool HandleLoad(winrt::Windows::Foundation::IAsyncOperation<uint32_t> const& operation);
 
-  // Read loop running in background thread
-  void ReadLoop();
+  // Flush pending_writes_ until empty (runs on the worker pool)
+  void Drain();
+
+  // In-flight I/O accounting; the last release closes the streams
+  void AcquireIo();
+  void ReleaseIo();
+
+  // Fail every queued write (called once the writer can no longer flush)
+  void FailPendingWrites(const std::string& error);
 
   // Send connection state to Flutter
   void SendConnectionState(bool is_connected, const std::string& status);
 
-  // Send received data to Flutter
-  void SendData(const std::vector<uint8_t>& data);
+  // Send a backpressure/writable event to Flutter
+  void SendFlowControlEvent(SendQueueBudget::Transition transition, size_t queued_bytes);
+
+  // Send received data to Flutter; the buffer goes back to receive_pool_
+  void SendData(std::vector<uint8_t>&& data);
 
   // Socket and streams
   winrt::Windows::Networking::Sockets::StreamSocket socket_{nullptr};
@@ -63,13 +106,36 @@ private:
 
   // Device information
   std::string device_address_;
+  int64_t connection_id_;
+
+  // Transport settings (data event format, ...)
+  TransportOptions options_;
+
+  // Shared executor (not owned)
+  WorkerPool* workers_;
 
   // Connection state
   std::atomic<bool> is_connected_{false};
   std::atomic<bool> should_stop_{false};
 
-  // Read thread
-  std::thread read_thread_;
+  // One reference while open plus one for the read chain and one for a
+  // scheduled drain job; the last release closes the streams
+  std::atomic<int> io_refs_{0};
+  std::atomic<bool> io_open_{false};
+  std::mutex io_mutex_;
+  std::condition_variable io_cv_;
+  bool io_started_ = false;
+  bool io_finished_ = false;
+
+  // Pooled read buffers and a data event map that is built once
+  ReceiveBufferPool receive_pool_;
+  flutter::EncodableValue data_event_;
+  flutter::EncodableValue* data_slot_ = nullptr;
+  std::atomic<uint64_t> read_events_{0};
+
+  // Bounded write queue, guarded by write_mutex_
+  std::mutex write_mutex_;
+  WriteQueue pending_writes_;
 
   // Event handlers (not owned)
   EventStreamHandler<flutter::EncodableValue>* connection_handler_;
@@ -18,6 +18,8 @@ struct ClassicDeviceInfo {
   bool connected = false;
   bool remembered = false;
 
+  bool operator==(const ClassicDeviceInfo& other) const = default;
+
   flutter::EncodableMap ToEncodableMap() const {
     flutter::EncodableMap device_map;
     device_map[flutter::EncodableValue("name")] = flutter::EncodableValue(name);
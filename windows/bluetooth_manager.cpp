@@ -1,16 +1,19 @@
 #include "bluetooth_manager.h"
 #include "bluetooth_classic_com_transport.h"
-#include "bluetooth_classic_registry_enum.h"
 #include "bluetooth_connection.h"
 #include "bluetooth_server.h"
+#include "cache_file.h"
+#include "connect_race.h"
+#include "device_cache_format.h"
 #include "flutter_bluetooth_classic_plugin.h"
+#include "io_reactor.h"
+#include "winrt_awaitable.h"
 
 #include <winrt/Windows.Foundation.Collections.h>
 
-#include <algorithm>
-#include <cctype>
-#include <iomanip>
-#include <sstream>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
 
 using namespace winrt;
 using namespace Windows::Foundation;
@@ -21,6 +24,71 @@ using namespace Windows::Devices::Radios;
 using namespace Windows::Networking::Sockets;
 
 namespace flutter_bluetooth_classic {
+namespace {
+
+// A history file is a few KB; anything larger is not one this code wrote
+constexpr size_t kMaxHistoryFileSize = 1024 * 1024;
+
+int64_t MillisecondsSince(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+// Spellings of the same target map to the same key: the canonical address,
+// else the normalized COM port.
+std::string ConnectKey(const std::string& address) {
+  const std::string normalized = NormalizeAddress(address);
+  return !normalized.empty() ? normalized : "COM:" + NormalizeComPort(address);
+}
+
+flutter::EncodableMap PathStatsToEncodableMap(const ConnectHistory::PathStats& stats,
+                                              ConnectHistory::Clock::time_point now) {
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue("successes")] = flutter::EncodableValue(static_cast<int64_t>(stats.successes));
+  map[flutter::EncodableValue("failures")] = flutter::EncodableValue(static_cast<int64_t>(stats.failures));
+  map[flutter::EncodableValue("recentFailures")] =
+      flutter::EncodableValue(static_cast<int64_t>(stats.recent_failures));
+  map[flutter::EncodableValue("latencyMs")] = flutter::EncodableValue(static_cast<int64_t>(stats.latency_ms));
+  map[flutter::EncodableValue("lastSuccess")] = flutter::EncodableValue(stats.last_success_ms);
+  map[flutter::EncodableValue("lastFailure")] = flutter::EncodableValue(stats.last_failure_ms);
+  map[flutter::EncodableValue("skipped")] =
+      flutter::EncodableValue(ConnectHistory::IsBackingOff(stats, now));
+  return map;
+}
+
+// Reads the device's RFCOMM services in mode and picks one: preferred if it
+// still applies, else the Serial Port service, else the first one. Null if
+// the device lists no services.
+Task<RfcommDeviceService> FindRfcommServiceAsync(
+    BluetoothDevice device,
+    BluetoothCacheMode mode,
+    std::optional<SdpServiceCache::Choice> preferred,
+    SdpServiceCache::Choice* chosen,
+    WorkerPool* workers,
+    CancellationToken cancel) {
+  auto services_async = device.GetRfcommServicesAsync(mode);
+  auto services_result = co_await AwaitWinRt(services_async, workers, cancel);
+  auto services = services_result.Services();
+
+  if (preferred && !preferred->serial_port && preferred->fallback_index < services.Size()) {
+    *chosen = *preferred;
+    co_return services.GetAt(preferred->fallback_index);
+  }
+  const auto spp_uuid = RfcommServiceId::SerialPort().Uuid();
+  for (const auto& service : services) {
+    if (service.ServiceId().Uuid() == spp_uuid) {
+      *chosen = SdpServiceCache::Choice{true, 0};
+      co_return service;
+    }
+  }
+  if (services.Size() > 0) {
+    *chosen = SdpServiceCache::Choice{false, 0};
+    co_return services.GetAt(0);
+  }
+  co_return RfcommDeviceService{nullptr};
+}
+
+}  // namespace
 
 BluetoothManager::BluetoothManager(
     EventStreamHandler<flutter::EncodableValue>* state_handler,
@@ -29,9 +97,34 @@ BluetoothManager::BluetoothManager(
     : state_handler_(state_handler),
       connection_handler_(connection_handler),
       data_handler_(data_handler) {
+  // Workers block on WinRT operations, which is only allowed in the MTA
+  worker_pool_ = std::make_unique<WorkerPool>(
+      WorkerPool::DefaultThreadCount(),
+      []() { winrt::init_apartment(winrt::apartment_type::multi_threaded); },
+      []() { winrt::uninit_apartment(); });
+  io_reactor_ = std::make_unique<IoReactor>(worker_pool_.get());
+  device_index_ = std::make_shared<PairedDeviceIndex>(
+      worker_pool_.get(), CacheFilePath(L"paired_devices.bin"));
+  device_index_->SetChangeListener(
+      [this](const PairedDeviceIndex::Changes& changes) { OnPairedDevicesChanged(changes); });
+  device_index_->Start();
+
+  // A few KB, read in place; a damaged file just starts the history over
+  history_path_ = CacheFilePath(L"connect_history.bin");
+  std::vector<ConnectHistory::Record> history;
+  if (ReadCacheFile(history_path_, kMaxHistoryFileSize, [&history](const uint8_t* data, size_t size) {
+        return DecodeConnectHistory(data, size, &history);
+      })) {
+    connect_history_.Restore(history);
+  }
   
-  // Initialize Bluetooth radio
-  InitializeBluetoothRadio();
+  // Look up the Bluetooth radio off the platform thread
+  Spawn(InitializeBluetoothRadioAsync(), [](std::future<void> finished) {
+    try {
+      finished.get();
+    } catch (...) {
+    }
+  });
 }
 
 BluetoothManager::~BluetoothManager() {
@@ -49,19 +142,21 @@ BluetoothManager::~BluetoothManager() {
     device_watcher_.EnumerationCompleted(watcher_completed_token_);
   }
 
-  // Disconnect active connection
-  std::shared_ptr<BluetoothClassicComTransport> com_to_close;
-  std::shared_ptr<BluetoothConnection> winrt_to_close;
+  // Abort in-flight connects and enumerations at whatever WinRT call they
+  // are waiting on
+  shutdown_cancel_.Cancel();
+  device_index_->Stop();
+
+  // Disconnect every open connection; connects still in flight close
+  // their own link once they see shutting_down_
+  std::vector<ConnectionEntry> to_close;
   {
     std::lock_guard<std::mutex> lock(connection_mutex_);
-    com_to_close = std::move(active_com_connection_);
-    winrt_to_close = std::move(active_connection_);
-  }
-  if (com_to_close) {
-    com_to_close->Close();
+    shutting_down_ = true;
+    to_close = connections_.TakeAll();
   }
-  if (winrt_to_close) {
-    winrt_to_close->Close();
+  for (const auto& entry : to_close) {
+    entry.Close();
   }
 
   // Stop server
@@ -74,114 +169,239 @@ BluetoothManager::~BluetoothManager() {
   }
 
   // Unregister radio state handler
-  if (bluetooth_radio_ && radio_state_token_) {
-    bluetooth_radio_.StateChanged(radio_state_token_);
+  {
+    std::lock_guard<std::mutex> lock(radio_mutex_);
+    if (bluetooth_radio_ && radio_state_token_) {
+      bluetooth_radio_.StateChanged(radio_state_token_);
+    }
   }
+
+  // Finish queued jobs while the reactor can still post; the reactor is
+  // torn down with the members afterwards.
+  worker_pool_->Shutdown();
 }
 
-void BluetoothManager::InitializeBluetoothRadio() {
+Task<void> BluetoothManager::InitializeBluetoothRadioAsync() {
+  Radio found{nullptr};
   try {
-    // Get all radios (run on background thread to avoid STA issues)
     auto radios_async = Radio::GetRadiosAsync();
-    auto radios = RunOnBackgroundThread<decltype(radios_async.get())>(radios_async);
-
-    // Find Bluetooth radio
+    auto radios = co_await AwaitWinRt(radios_async, worker_pool_.get(), shutdown_cancel_.token());
     for (const auto& radio : radios) {
       if (radio.Kind() == RadioKind::Bluetooth) {
-        bluetooth_radio_ = radio;
-        
-        // Register for state changes
-        radio_state_token_ = bluetooth_radio_.StateChanged(
-            [this](Radio const& radio, auto const&) {
-              flutter::EncodableMap state_map;
-              bool is_enabled = (radio.State() == RadioState::On);
-              
-              std::string status;
-              switch (radio.State()) {
-                case RadioState::On:
-                  status = "ON";
-                  break;
-                case RadioState::Off:
-                  status = "OFF";
-                  break;
-                case RadioState::Disabled:
-                  status = "DISABLED";
-                  break;
-                default:
-                  status = "UNKNOWN";
-                  break;
-              }
-
-              state_map[flutter::EncodableValue("isEnabled")] = flutter::EncodableValue(is_enabled);
-              state_map[flutter::EncodableValue("status")] = flutter::EncodableValue(status);
-              
-              state_handler_->Success(flutter::EncodableValue(state_map));
-            });
-        
+        found = radio;
         break;
       }
     }
   }
-  catch (hresult_error const&) {
-    // Failed to get Bluetooth radio
+  catch (...) {
+    // No radio access, or shutting down: reported as unsupported
+  }
+
+  std::vector<std::coroutine_handle<>> waiters;
+  {
+    std::lock_guard<std::mutex> lock(radio_mutex_);
+    // The destructor unregisters under the same lock once shutdown started
+    if (found && !shutdown_cancel_.token().IsCancelled()) {
+      bluetooth_radio_ = found;
+      
+      // Register for state changes
+      radio_state_token_ = bluetooth_radio_.StateChanged(
+          [this](Radio const& radio, auto const&) {
+            flutter::EncodableMap state_map;
+            bool is_enabled = (radio.State() == RadioState::On);
+          
+            std::string status;
+            switch (radio.State()) {
+              case RadioState::On:
+                status = "ON";
+                break;
+              case RadioState::Off:
+                status = "OFF";
+                break;
+              case RadioState::Disabled:
+                status = "DISABLED";
+                break;
+              default:
+                status = "UNKNOWN";
+                break;
+            }
+
+            state_map[flutter::EncodableValue("isEnabled")] = flutter::EncodableValue(is_enabled);
+            state_map[flutter::EncodableValue("status")] = flutter::EncodableValue(status);
+          
+            state_handler_->Success(flutter::EncodableValue(state_map));
+          });
+    }
+    radio_ready_ = true;
+    waiters.swap(radio_waiters_);
+  }
+  for (auto handle : waiters) {
+    if (!worker_pool_->Post([handle]() { handle.resume(); })) {
+      handle.resume();
+    }
+  }
+}
+
+Task<Radio> BluetoothManager::BluetoothRadioAsync() {
+  RadioReadyAwaiter ready{this};
+  co_await ready;
+  std::lock_guard<std::mutex> lock(radio_mutex_);
+  co_return bluetooth_radio_;
+}
+
+bool BluetoothManager::RadioReadyAwaiter::await_ready() const {
+  std::lock_guard<std::mutex> lock(manager->radio_mutex_);
+  return manager->radio_ready_;
+}
+
+bool BluetoothManager::RadioReadyAwaiter::await_suspend(std::coroutine_handle<> handle) const {
+  std::lock_guard<std::mutex> lock(manager->radio_mutex_);
+  if (manager->radio_ready_) {
+    return false;
   }
+  manager->radio_waiters_.push_back(handle);
+  return true;
 }
 
 void BluetoothManager::IsBluetoothSupported(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  result->Success(flutter::EncodableValue(bluetooth_radio_ != nullptr));
+  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+  // Only calls made before the radio lookup finished wait for it
+  Spawn(BluetoothRadioAsync(), [result_ptr](std::future<Radio> radio) {
+    result_ptr->Success(flutter::EncodableValue(radio.get() != nullptr));
+  });
 }
 
 void BluetoothManager::IsBluetoothEnabled(
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  if (!bluetooth_radio_) {
-    result->Success(flutter::EncodableValue(false));
-    return;
-  }
+  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+  Spawn(BluetoothRadioAsync(), [result_ptr](std::future<Radio> radio_future) {
+    Radio radio = radio_future.get();
+    if (!radio) {
+      result_ptr->Success(flutter::EncodableValue(false));
+      return;
+    }
 
-  bool is_enabled = (bluetooth_radio_.State() == RadioState::On);
-  result->Success(flutter::EncodableValue(is_enabled));
+    bool is_enabled = (radio.State() == RadioState::On);
+    result_ptr->Success(flutter::EncodableValue(is_enabled));
+  });
 }
 
 void BluetoothManager::GetPairedDevices(
+    bool progressive,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  try {
-    std::vector<ClassicDeviceInfo> devices = BuildMergedClassicDeviceList();
-    CacheKnownDevices(devices);
+  if (progressive) {
+    // Answer with whatever is known now; the rest follows as devicesUpdated
+    stream_paired_changes_ = true;
+    const bool built = device_index_->IsBuilt();
+    std::vector<ClassicDeviceInfo> devices = device_index_->Current()->devices();
+    MarkConnectedDevices(&devices);
     flutter::EncodableList device_list;
+    for (const auto& device : devices) {
+      device_list.push_back(flutter::EncodableValue(device.ToEncodableMap()));
+    }
+    result->Success(flutter::EncodableValue(device_list));
 
-    std::string connected_address;
-    std::string connected_com_port;
-    {
-      std::lock_guard<std::mutex> lock(connection_mutex_);
-      if (active_com_connection_ && active_com_connection_->IsConnected()) {
-        connected_com_port = NormalizeComPort(active_com_connection_->GetComPort());
-      }
-      if (active_connection_ && active_connection_->IsConnected()) {
-        connected_address = NormalizeAddress(active_connection_->GetDeviceAddress());
-      }
+    if (built) {
+      // The build ended before changes were streamed, so its complete
+      // event went nowhere; the list just returned is final, say so.
+      PairedDeviceIndex::Changes final_update;
+      final_update.updated = std::move(devices);
+      final_update.complete = true;
+      SendPairedDevicesEvent(final_update);
     }
+    return;
+  }
+
+  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+
+  // Only the very first call waits for the initial build; afterwards the
+  // snapshot is ready and this completes inline.
+  Spawn(
+      device_index_->SnapshotAsync(shutdown_cancel_.token()),
+      [this, result_ptr](std::future<std::shared_ptr<const PairedDeviceIndex::Snapshot>> snapshot) {
+        try {
+          std::vector<ClassicDeviceInfo> devices = snapshot.get()->devices();
+          MarkConnectedDevices(&devices);
+          flutter::EncodableList device_list;
+          for (const auto& device : devices) {
+            device_list.push_back(flutter::EncodableValue(device.ToEncodableMap()));
+          }
+          result_ptr->Success(flutter::EncodableValue(device_list));
+        }
+        catch (hresult_error const& ex) {
+          std::wstring msg_wide = ex.message().c_str();
+          std::string msg(msg_wide.begin(), msg_wide.end());
+          result_ptr->Error("BLUETOOTH_ERROR", "Failed to get paired devices: " + msg);
+        }
+        catch (std::exception const& ex) {
+          result_ptr->Error("BLUETOOTH_ERROR", "Failed to get paired devices: " + std::string(ex.what()));
+        }
+      });
+}
 
-    for (auto& device : devices) {
-      if (!connected_address.empty() && NormalizeAddress(device.address) == connected_address) {
-        device.connected = true;
+void BluetoothManager::MarkConnectedDevices(std::vector<ClassicDeviceInfo>* devices) {
+  std::unordered_set<BdAddr, BdAddrHash> connected_addresses;
+  std::unordered_set<std::string> connected_com_ports;
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    for (const auto& connection : connections_.entries()) {
+      const ConnectionEntry& entry = connection.second;
+      if (entry.com && entry.com->IsConnected()) {
+        connected_com_ports.insert(NormalizeComPort(entry.com->GetComPort()));
       }
-      if (!connected_com_port.empty() && NormalizeComPort(device.com_port) == connected_com_port) {
-        device.connected = true;
+      BdAddr connected_address;
+      if (entry.winrt && entry.winrt->IsConnected() &&
+          BdAddr::TryParse(entry.winrt->GetDeviceAddress(), &connected_address)) {
+        connected_addresses.insert(connected_address);
       }
-      device_list.push_back(flutter::EncodableValue(device.ToEncodableMap()));
     }
+  }
 
-    result->Success(flutter::EncodableValue(device_list));
+  for (auto& device : *devices) {
+    BdAddr device_address;
+    if (BdAddr::TryParse(device.address, &device_address) &&
+        connected_addresses.count(device_address) > 0) {
+      device.connected = true;
+    }
+    if (!device.com_port.empty() &&
+        connected_com_ports.count(NormalizeComPort(device.com_port)) > 0) {
+      device.connected = true;
+    }
   }
-  catch (hresult_error const& ex) {
-    std::wstring msg_wide = ex.message().c_str();
-    std::string msg(msg_wide.begin(), msg_wide.end());
-    result->Error("BLUETOOTH_ERROR", "Failed to get paired devices: " + msg);
+}
+
+void BluetoothManager::OnPairedDevicesChanged(const PairedDeviceIndex::Changes& changes) {
+  for (const auto& device : changes.updated) {
+    WarmSdpCache(device);
   }
+  if (stream_paired_changes_) {
+    SendPairedDevicesEvent(changes);
+  }
+}
+
+void BluetoothManager::SendPairedDevicesEvent(const PairedDeviceIndex::Changes& changes) {
+  std::vector<ClassicDeviceInfo> updated = changes.updated;
+  MarkConnectedDevices(&updated);
+  flutter::EncodableList device_list;
+  for (const auto& device : updated) {
+    device_list.push_back(flutter::EncodableValue(device.ToEncodableMap()));
+  }
+  flutter::EncodableList removed_list;
+  for (const auto& device : changes.removed) {
+    removed_list.push_back(flutter::EncodableValue(device.address));
+  }
+
+  flutter::EncodableMap event_map;
+  event_map[flutter::EncodableValue("event")] = flutter::EncodableValue("devicesUpdated");
+  event_map[flutter::EncodableValue("devices")] = flutter::EncodableValue(device_list);
+  event_map[flutter::EncodableValue("removed")] = flutter::EncodableValue(removed_list);
+  event_map[flutter::EncodableValue("complete")] = flutter::EncodableValue(changes.complete);
+  state_handler_->Success(flutter::EncodableValue(event_map));
 }
 
 void BluetoothManager::StartDiscovery(
+    const DiscoveryBatchOptions& batch,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
   
   try {
@@ -199,6 +419,18 @@ void BluetoothManager::StartDiscovery(
     // Create device watcher
     device_watcher_ = DeviceInformation::CreateWatcher(selector);
 
+    // Each start is a fresh session: devices are reported as found again
+    uint64_t session = 0;
+    {
+      std::lock_guard<std::mutex> lock(discovery_mutex_);
+      discovered_devices_.Clear();
+      session = ++discovery_session_;
+      discovery_running_ = true;
+      FlushDiscoveryBatchLocked();
+      batch_options_ = batch;
+      discovery_batch_.set_max_devices(batch.max_devices);
+    }
+
     // Register event handlers
     watcher_added_token_ = device_watcher_.Added(
         {this, &BluetoothManager::OnDeviceAdded});
@@ -214,6 +446,8 @@ void BluetoothManager::StartDiscovery(
 
     // Start discovery
     device_watcher_.Start();
+    worker_pool_->PostAfter(kDiscoverySweepInterval,
+                            [this, session]() { SweepDiscoveredDevices(session); });
 
     result->Success(flutter::EncodableValue(true));
   }
@@ -234,168 +468,492 @@ void BluetoothManager::StopDiscovery(
     }
   }
 
+  // Seen devices stay for connects; they just stop aging until next start
+  {
+    std::lock_guard<std::mutex> lock(discovery_mutex_);
+    ++discovery_session_;
+    discovery_running_ = false;
+    FlushDiscoveryBatchLocked();
+  }
+
   result->Success(flutter::EncodableValue(true));
 }
 
 void BluetoothManager::Connect(
     const std::string& address,
+    const flutter::EncodableMap& options,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  // Move the result to a shared_ptr so it can be safely captured by the thread
-  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+  OpenConnectionAsync(address, options, true, std::move(result));
+}
+
+void BluetoothManager::OpenConnection(
+    const std::string& address,
+    const flutter::EncodableMap& options,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  OpenConnectionAsync(address, options, false, std::move(result));
+}
 
-  // Run entire connection process on background thread to avoid blocking UI
-  std::thread([this, address, result_ptr]() {
-    winrt::init_apartment(winrt::apartment_type::multi_threaded);
+void BluetoothManager::OpenConnectionAsync(
+    const std::string& address,
+    const flutter::EncodableMap& options,
+    bool replace_legacy,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  TransportOptions transport_options = CurrentTransportOptions();
+  std::string options_error;
+  if (!ApplyTransportOptions(options, &transport_options, &options_error)) {
+    result->Error("INVALID_ARGUMENT", options_error);
+    return;
+  }
 
-    try {
-      std::vector<ClassicDeviceInfo> devices = BuildMergedClassicDeviceList();
-      CacheKnownDevices(devices);
+  std::chrono::milliseconds timeout{0};
+  auto timeout_it = options.find(flutter::EncodableValue("connectTimeoutMs"));
+  if (timeout_it != options.end()) {
+    int64_t value = 0;
+    if (!internal::ReadNonNegativeInt(timeout_it->second, &value)) {
+      result->Error("INVALID_ARGUMENT", "connectTimeoutMs must be a non-negative integer");
+      return;
+    }
+    timeout = std::chrono::milliseconds(value);
+  }
+
+  // Move the result to a shared_ptr so it can be safely captured by the task
+  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
 
-      std::string request_key = NormalizeAddress(address);
-      if (request_key.empty()) {
-        request_key = "COM:" + NormalizeComPort(address);
+  auto pending = std::make_shared<PendingConnect>();
+  pending->key = ConnectKey(address);
+  pending->replace_legacy = replace_legacy;
+  pending->options = transport_options;
+  pending->timeout = timeout;
+  pending->results.push_back(result_ptr);
+
+  // The slot is reserved up front so a full table fails fast instead of
+  // after a multi-second connect.
+  ConnectionEntry replaced;
+  int64_t connection_id = 0;
+  bool reserved = false;
+  std::vector<std::shared_ptr<PendingConnect>> superseded;
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    for (const auto& in_flight : connects_in_flight_) {
+      const std::shared_ptr<PendingConnect>& other = in_flight.second;
+      if (!other->abort_code.empty() || other->replace_legacy != replace_legacy) {
+        continue;
       }
-      if (request_key.rfind("COM:", 0) != 0 && request_key.find(':') == std::string::npos) {
-        request_key = "COM:" + NormalizeComPort(address);
+      if (other->key == pending->key && other->options == transport_options &&
+          other->timeout == timeout) {
+        // Double tap: wait for the connect that is already running
+        other->results.push_back(result_ptr);
+        return;
       }
+      if (replace_legacy) {
+        superseded.push_back(other);
+      }
+    }
+    if (replace_legacy) {
+      replaced = connections_.TakeLegacy();
+    }
+    reserved = connections_.Reserve(&connection_id);
+    if (reserved) {
+      connects_in_flight_[connection_id] = pending;
+      // Only connects nothing else has aborted yet; a cancelled one keeps
+      // its CONNECTION_CANCELLED
+      for (const auto& other : superseded) {
+        other->abort_code = "CONNECTION_SUPERSEDED";
+        other->abort_message = "Failed to connect: superseded by a newer connect";
+      }
+    }
+  }
+  if (!reserved) {
+    replaced.Close();
+    result_ptr->Error("CONNECTION_LIMIT", "Maximum number of connections reached");
+    return;
+  }
+  for (const auto& other : superseded) {
+    // Its callers get CONNECTION_SUPERSEDED once it has stopped
+    other->cancel.Cancel("SUPERSEDED");
+  }
+  pending->shutdown_forward = shutdown_cancel_.token().OnCancel(
+      [cancel = pending->cancel]() mutable { cancel.Cancel(); });
+  if (timeout.count() > 0) {
+    pending->cancel.CancelAfter(worker_pool_.get(), timeout);
+  }
+
+  Spawn(
+      ConnectAsync(address, connection_id, transport_options, replaced, pending->cancel.token()),
+      [this, connection_id, replace_legacy, pending, replaced](std::future<ConnectOutcome> finished) {
+        ConnectOutcome outcome;
+        try {
+          outcome = finished.get();
+        } catch (...) {
+          // It may have stopped before closing the link it replaces (a
+          // stopping pool refuses to resume it); closing twice is harmless.
+          replaced.Close();
+          outcome.connected = false;
+          outcome.error_message = "Failed to connect: Unknown error";
+        }
 
-      ClassicDeviceInfo target;
-      bool has_target = false;
-      {
-        std::lock_guard<std::mutex> lock(connection_mutex_);
-        auto known = known_devices_by_key_.find(request_key);
-        if (known != known_devices_by_key_.end()) {
-          target = known->second;
-          has_target = true;
+        bool committed = false;
+        bool aborted = false;
+        std::string error_code = "CONNECTION_FAILED";
+        std::vector<std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>> results;
+        {
+          std::lock_guard<std::mutex> lock(connection_mutex_);
+          connects_in_flight_.erase(connection_id);
+          aborted = !pending->abort_code.empty();
+          if (aborted) {
+            error_code = pending->abort_code;
+            outcome.error_message = pending->abort_message;
+          }
+          committed = CommitConnectionSlotLocked(
+              connection_id, outcome.connected && !aborted ? &outcome.entry : nullptr,
+              replace_legacy);
+          results = std::move(pending->results);
         }
+        if (aborted) {
+          // It may have connected before it saw the abort: drop the link
+          outcome.entry.Close();
+          outcome.connected = false;
+        } else if (outcome.connected && !committed) {
+          outcome.entry.Close();
+          outcome.connected = false;
+          outcome.error_message = "Failed to connect: plugin is shutting down";
+        } else if (!outcome.connected && pending->cancel.token().reason() == "TIMEOUT") {
+          error_code = "CONNECTION_TIMEOUT";
+          outcome.error_message = "Failed to connect: no connection within " +
+                                  std::to_string(pending->timeout.count()) + " ms";
+        }
+
+        const flutter::EncodableValue phases(outcome.phases.ToEncodableMap());
+        for (const auto& result : results) {
+          if (!outcome.connected) {
+            result->Error(error_code, outcome.error_message, phases);
+          } else if (replace_legacy) {
+            result->Success(flutter::EncodableValue(true));
+          } else {
+            result->Success(flutter::EncodableValue(connection_id));
+          }
+        }
+      });
+}
+
+void BluetoothManager::CancelConnect(
+    const std::string& address,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  const std::string key = address.empty() ? std::string() : ConnectKey(address);
+  std::vector<std::shared_ptr<PendingConnect>> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    for (const auto& in_flight : connects_in_flight_) {
+      const std::shared_ptr<PendingConnect>& pending = in_flight.second;
+      if (!pending->abort_code.empty() || (!key.empty() && pending->key != key)) {
+        continue;
       }
+      pending->abort_code = "CONNECTION_CANCELLED";
+      pending->abort_message = "Failed to connect: cancelled";
+      cancelled.push_back(pending);
+    }
+  }
+  // Callers are answered by each connect once it has stopped
+  for (const auto& pending : cancelled) {
+    pending->cancel.Cancel();
+  }
+  result->Success(flutter::EncodableValue(!cancelled.empty()));
+}
 
-      if (!has_target) {
-        target.address = NormalizeAddress(address);
-        target.connect_key = request_key;
+Task<BluetoothManager::ConnectOutcome> BluetoothManager::ConnectAsync(
+    std::string address,
+    int64_t connection_id,
+    TransportOptions transport_options,
+    ConnectionEntry replaced,
+    CancellationToken cancel) {
+  // Run entire connection process off the platform thread
+  co_await ResumeOn(worker_pool_.get());
+  const auto started = std::chrono::steady_clock::now();
+
+  ConnectOutcome outcome;
+  ConnectionEntry& entry = outcome.entry;
+  bool& connected = outcome.connected;
+  std::string& error_message = outcome.error_message;
+  ConnectPhases& phases = outcome.phases;
+  try {
+    replaced.Close();
+
+    const auto enumeration_started = std::chrono::steady_clock::now();
+    std::shared_ptr<const PairedDeviceIndex::Snapshot> paired =
+        co_await device_index_->SnapshotAsync(cancel);
+
+    BdAddr request_address;
+    const bool is_address = BdAddr::TryParse(address, &request_address);
+
+    ClassicDeviceInfo target;
+    bool has_target = false;
+    if (const ClassicDeviceInfo* paired_device = paired->Find(address)) {
+      target = *paired_device;
+      has_target = true;
+    } else if (is_address) {
+      std::lock_guard<std::mutex> lock(discovery_mutex_);
+      if (const ClassicDeviceInfo* known = discovered_devices_.FindByAddress(request_address)) {
+        target = *known;
+        has_target = true;
       }
+    }
 
-      std::string com_error;
-      std::string winrt_error;
-      bool connected = false;
+    phases.enumeration_ms = MillisecondsSince(enumeration_started);
 
-      std::shared_ptr<BluetoothClassicComTransport> com_to_close;
-      std::shared_ptr<BluetoothConnection> winrt_to_close;
-      {
-        std::lock_guard<std::mutex> lock(connection_mutex_);
-        com_to_close = std::move(active_com_connection_);
-        winrt_to_close = std::move(active_connection_);
-      }
-      if (com_to_close) {
-        com_to_close->Close();
+    if (!has_target) {
+      target.address = is_address ? request_address.ToString() : std::string();
+      target.connect_key = is_address ? target.address : "COM:" + NormalizeComPort(address);
+    }
+
+    const std::string winrt_address =
+        !target.address.empty() ? target.address : NormalizeAddress(address);
+    BdAddr winrt_bt_address;
+    const bool has_bt_address = BdAddr::TryParse(winrt_address, &winrt_bt_address);
+    const bool try_com = !target.com_port.empty();
+    // Without a COM port WinRT is tried anyway and reports the bad address
+    const bool try_winrt = has_bt_address || !try_com;
+
+    ConnectOutcome com_outcome;
+    ConnectOutcome winrt_outcome;
+    if (try_com && try_winrt) {
+      std::function<Task<ConnectOutcome>(CancellationToken)> com_leg =
+          [this, target, connection_id, transport_options](CancellationToken leg_cancel) {
+            return TryComAsync(target, connection_id, transport_options, leg_cancel);
+          };
+      std::function<Task<ConnectOutcome>(CancellationToken)> winrt_leg =
+          [this, winrt_address, connection_id, transport_options](CancellationToken leg_cancel) {
+            return TryWinRtAsync(winrt_address, connection_id, transport_options, leg_cancel);
+          };
+      const ConnectHistory::Plan plan =
+          connect_history_.PlanFor(winrt_bt_address, ConnectHistory::Clock::now());
+      const bool com_first = plan.first == ConnectHistory::Path::kCom;
+      ConnectOutcome& first_outcome = com_first ? com_outcome : winrt_outcome;
+      ConnectOutcome& second_outcome = com_first ? winrt_outcome : com_outcome;
+
+      RaceResult<ConnectOutcome> attempts;
+      if (plan.race) {
+        // The path that worked best for this device (COM without history)
+        // gets a head start; the other joins after kConnectStagger, or at
+        // once if the first fails sooner, so a stale path no longer costs
+        // its whole timeout. The loser is cancelled and closed before it
+        // is ever announced.
+        attempts = co_await RaceStaggered<ConnectOutcome>(
+            com_first ? com_leg : winrt_leg, com_first ? winrt_leg : com_leg, kConnectStagger,
+            worker_pool_.get(), cancel, [](const ConnectOutcome& leg) { return leg.connected; },
+            [this, winrt_bt_address](ConnectOutcome lost) {
+              // Still proof that the path works
+              RecordConnectAttempt(
+                  winrt_bt_address,
+                  lost.entry.com ? ConnectHistory::Path::kCom : ConnectHistory::Path::kWinRt, lost);
+              lost.entry.Close();
+            });
+      } else {
+        // The other path failed recently: only fall back to it
+        attempts = co_await FallBack<ConnectOutcome>(
+            com_first ? com_leg : winrt_leg, com_first ? winrt_leg : com_leg, cancel,
+            [](const ConnectOutcome& leg) { return leg.connected; });
       }
-      if (winrt_to_close) {
-        winrt_to_close->Close();
+      if (attempts.legs[0]) {
+        first_outcome = std::move(*attempts.legs[0]);
       }
-
-      if (!target.com_port.empty()) {
-        connected = ConnectViaComLocked(target, &com_error);
+      if (attempts.legs[1]) {
+        second_outcome = std::move(*attempts.legs[1]);
       }
-      if (!connected) {
-        const std::string winrt_address =
-            !target.address.empty() ? target.address : NormalizeAddress(address);
-        connected = ConnectViaWinRtLocked(winrt_address, &winrt_error);
+      RecordConnectAttempt(winrt_bt_address, ConnectHistory::Path::kCom, com_outcome);
+      RecordConnectAttempt(winrt_bt_address, ConnectHistory::Path::kWinRt, winrt_outcome);
+    } else if (try_com) {
+      // A COM-only device has no Bluetooth address to key history by
+      com_outcome = co_await TryComAsync(target, connection_id, transport_options, cancel);
+    } else {
+      winrt_outcome = co_await TryWinRtAsync(winrt_address, connection_id, transport_options, cancel);
+      if (has_bt_address) {
+        RecordConnectAttempt(winrt_bt_address, ConnectHistory::Path::kWinRt, winrt_outcome);
       }
+    }
 
-      if (connected) {
-        result_ptr->Success(flutter::EncodableValue(true));
-      } else {
-        std::string reason = "COM_NOT_FOUND_OR_FAILED";
-        if (!com_error.empty() && !winrt_error.empty()) {
-          reason = "COM_OPEN_FAILED; WINRT_FALLBACK_FAILED";
-        } else if (!winrt_error.empty()) {
-          reason = "WINRT_FALLBACK_FAILED";
-        } else if (!com_error.empty()) {
-          reason = "COM_OPEN_FAILED";
-        }
-        result_ptr->Error(
-            "CONNECTION_FAILED",
-            "Failed to connect (" + reason + "). COM=[" + com_error + "] WINRT=[" + winrt_error + "]");
+    phases.com_open_ms = com_outcome.phases.com_open_ms;
+    phases.device_lookup_ms = winrt_outcome.phases.device_lookup_ms;
+    phases.sdp_ms = winrt_outcome.phases.sdp_ms;
+    phases.socket_connect_ms = winrt_outcome.phases.socket_connect_ms;
+
+    if (com_outcome.connected) {
+      entry = std::move(com_outcome.entry);
+      connected = true;
+    } else if (winrt_outcome.connected) {
+      entry = std::move(winrt_outcome.entry);
+      connected = true;
+    }
+    const std::string& com_error = com_outcome.error_message;
+    const std::string& winrt_error = winrt_outcome.error_message;
+
+    if (connected) {
+      entry.Start();
+    } else {
+      std::string reason = "COM_NOT_FOUND_OR_FAILED";
+      if (!com_error.empty() && !winrt_error.empty()) {
+        reason = "COM_OPEN_FAILED; WINRT_FALLBACK_FAILED";
+      } else if (!winrt_error.empty()) {
+        reason = "WINRT_FALLBACK_FAILED";
+      } else if (!com_error.empty()) {
+        reason = "COM_OPEN_FAILED";
       }
-    } catch (hresult_error const& ex) {
-      std::wstring msg_wide = ex.message().c_str();
-      std::string msg(msg_wide.begin(), msg_wide.end());
-      result_ptr->Error("CONNECTION_FAILED", "Failed to connect: " + msg);
-    } catch (std::exception const& ex) {
-      result_ptr->Error("CONNECTION_FAILED", "Failed to connect: " + std::string(ex.what()));
+      error_message =
+          "Failed to connect (" + reason + "). COM=[" + com_error + "] WINRT=[" + winrt_error + "]";
     }
+  } catch (hresult_error const& ex) {
+    std::wstring msg_wide = ex.message().c_str();
+    std::string msg(msg_wide.begin(), msg_wide.end());
+    error_message = "Failed to connect: " + msg;
+  } catch (std::exception const& ex) {
+    error_message = "Failed to connect: " + std::string(ex.what());
+  }
+  phases.total_ms = MillisecondsSince(started);
+  entry.phases = phases;
 
-    winrt::uninit_apartment();
-  }).detach();  // Detach thread so it runs independently without blocking
+  co_return outcome;
 }
 
 void BluetoothManager::Listen(
     const std::string& app_name,
+    size_t max_peers,
+    AdmissionPolicy policy,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  
-  try {
-    // Stop existing server if any
+  // Stop existing server if any
+  std::shared_ptr<BluetoothServer> previous;
+  {
+    std::lock_guard<std::mutex> lock(server_mutex_);
+    previous = std::move(bluetooth_server_);
+  }
+  if (previous) {
+    previous->StopListening();
+  }
+
+  // Create server with callback for incoming connections
+  auto on_connection = [this, max_peers, policy](
+                           StreamSocket socket, const std::string& device_address) {
+    AcceptServerPeer(socket, device_address, max_peers, policy);
+  };
+
+  auto server = std::make_shared<BluetoothServer>(
+      app_name,
+      worker_pool_.get(),
+      connection_handler_,
+      on_connection);
+  {
+    std::lock_guard<std::mutex> lock(server_mutex_);
+    bluetooth_server_ = server;
+  }
+
+  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
+  Spawn(server->StartListeningAsync(), [this, server, result_ptr](std::future<void> started) {
+    try {
+      started.get();
+    }
+    catch (hresult_error const& ex) {
+      std::wstring msg_wide = ex.message().c_str();
+      std::string msg(msg_wide.begin(), msg_wide.end());
+      result_ptr->Error("LISTEN_FAILED", "Failed to start listening: " + msg);
+      return;
+    }
+    catch (std::exception const& ex) {
+      result_ptr->Error("LISTEN_FAILED", "Failed to start listening: " + std::string(ex.what()));
+      return;
+    }
+
+    // stopListen or a newer listen may have replaced this server while it
+    // was starting
+    bool current = false;
     {
       std::lock_guard<std::mutex> lock(server_mutex_);
-      if (bluetooth_server_) {
-        bluetooth_server_->StopListening();
-        bluetooth_server_.reset();
-      }
+      current = bluetooth_server_ == server;
+    }
+    if (!current) {
+      server->StopListening();
+      result_ptr->Error("LISTEN_FAILED", "Failed to start listening: CANCELLED");
+      return;
     }
+    result_ptr->Success(flutter::EncodableValue(true));
+  });
+}
 
-    // Create server with callback for incoming connections
-    auto on_connection = [this](std::unique_ptr<BluetoothConnection> connection) {
-      std::shared_ptr<BluetoothClassicComTransport> com_to_close;
-      std::shared_ptr<BluetoothConnection> winrt_to_close;
-      std::shared_ptr<BluetoothConnection> new_connection(std::move(connection));
-      {
-        std::lock_guard<std::mutex> lock(connection_mutex_);
-        com_to_close = std::move(active_com_connection_);
-        winrt_to_close = std::move(active_connection_);
-        active_connection_ = std::move(new_connection);
-      }
-      if (com_to_close) {
-        com_to_close->Close();
-      }
-      if (winrt_to_close) {
-        winrt_to_close->Close();
-      }
-    };
+void BluetoothManager::AcceptServerPeer(
+    StreamSocket socket,
+    const std::string& device_address,
+    size_t max_peers,
+    AdmissionPolicy policy) {
+  const TransportOptions options = CurrentTransportOptions();
+  ConnectionEntry evicted;
+  int64_t connection_id = 0;
+  bool admitted = false;
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    connections_.PruneClosed();
+    if (policy == AdmissionPolicy::kEvictOldest &&
+        (ServerPeerCountLocked() >= max_peers || connections_.Full())) {
+      evicted = connections_.TakeOldest([](const ConnectionEntry& entry) { return entry.server_peer; });
+    }
+    if (ServerPeerCountLocked() < max_peers && connections_.Reserve(&connection_id)) {
+      ++pending_server_peers_;
+      admitted = true;
+    }
+  }
+  // The evicted peer reports its own DISCONNECTED event.
+  evicted.Close();
 
-    {
-      std::lock_guard<std::mutex> lock(server_mutex_);
-      bluetooth_server_ = std::make_unique<BluetoothServer>(
-          app_name,
-          connection_handler_,
-          data_handler_,
-          on_connection);
-      
-      bluetooth_server_->StartListening();
+  if (!admitted) {
+    try {
+      socket.Close();
+    } catch (...) {
+      // Ignore errors while dropping the rejected socket
     }
+    flutter::EncodableMap connection_map;
+    connection_map[flutter::EncodableValue("isConnected")] = flutter::EncodableValue(false);
+    connection_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue(device_address);
+    connection_map[flutter::EncodableValue("status")] =
+        flutter::EncodableValue("REJECTED: server peer limit reached");
+    connection_handler_->Success(flutter::EncodableValue(connection_map));
+    return;
+  }
 
-    result->Success(flutter::EncodableValue(true));
+  ConnectionEntry entry;
+  entry.server_peer = true;
+  try {
+    entry.winrt = std::make_shared<BluetoothConnection>(
+        socket, device_address, connection_id, worker_pool_.get(), connection_handler_, data_handler_,
+        options);
+    entry.winrt->Start();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    --pending_server_peers_;
+    CommitConnectionSlotLocked(connection_id, nullptr, false);
+    throw;
   }
-  catch (hresult_error const& ex) {
-    std::wstring msg_wide = ex.message().c_str();
-    std::string msg(msg_wide.begin(), msg_wide.end());
-    result->Error("LISTEN_FAILED", "Failed to start listening: " + msg);
+  bool committed = false;
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    --pending_server_peers_;
+    committed = CommitConnectionSlotLocked(connection_id, &entry, false);
+  }
+  if (!committed) {
+    entry.Close();
   }
 }
 
 void BluetoothManager::Disconnect(
+    int64_t connection_id,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  std::shared_ptr<BluetoothClassicComTransport> com_to_close;
-  std::shared_ptr<BluetoothConnection> winrt_to_close;
+  std::vector<ConnectionEntry> to_close;
   {
     std::lock_guard<std::mutex> lock(connection_mutex_);
-    com_to_close = std::move(active_com_connection_);
-    winrt_to_close = std::move(active_connection_);
-  }
-  if (com_to_close) {
-    com_to_close->Close();
+    if (connection_id == 0) {
+      to_close = connections_.TakeAll();
+    } else {
+      to_close.push_back(connections_.Take(connection_id));
+    }
   }
-  if (winrt_to_close) {
-    winrt_to_close->Close();
+  // Unknown handles are not an error: the link may already have dropped.
+  for (const auto& entry : to_close) {
+    entry.Close();
   }
 
   result->Success(flutter::EncodableValue(true));
@@ -414,207 +972,182 @@ void BluetoothManager::StopListen(
 }
 
 void BluetoothManager::SendData(
+    int64_t connection_id,
     const std::vector<uint8_t>& data,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  std::shared_ptr<BluetoothConnection> winrt_connection;
-  std::shared_ptr<BluetoothClassicComTransport> com_connection;
+  ConnectionEntry entry;
+  bool found = false;
   {
     std::lock_guard<std::mutex> lock(connection_mutex_);
-    winrt_connection = active_connection_;
-    com_connection = active_com_connection_;
+    found = connections_.Find(connection_id, &entry);
   }
 
-  const bool winrt_connected = winrt_connection && winrt_connection->IsConnected();
-  const bool com_connected = com_connection && com_connection->IsConnected();
-  if (!winrt_connected && !com_connected) {
-    result->Error("NOT_CONNECTED", "Not connected to any device");
+  if (!found || !entry.IsConnected()) {
+    result->Error("NOT_CONNECTED",
+                  connection_id == 0 ? "Not connected to any device"
+                                     : "No open connection with handle " + std::to_string(connection_id));
     return;
   }
+  const std::shared_ptr<BluetoothClassicComTransport>& com_connection = entry.com;
+  const std::shared_ptr<BluetoothConnection>& winrt_connection = entry.winrt;
 
+  // WinRT writes complete on the connection's writer thread once StoreAsync
+  // finishes, so the result has to outlive this call.
+  auto result_ptr = std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>(std::move(result));
   try {
-    if (com_connected) {
+    if (com_connection) {
       com_connection->WriteData(data);
+      result_ptr->Success(flutter::EncodableValue(true));
     } else {
-      winrt_connection->WriteData(data);
+      winrt_connection->WriteData(data, [result_ptr](bool success, const std::string& error) {
+        if (success) {
+          result_ptr->Success(flutter::EncodableValue(true));
+        } else {
+          result_ptr->Error("SEND_FAILED", "Failed to send data: " + error);
+        }
+      });
     }
-    result->Success(flutter::EncodableValue(true));
   } catch (hresult_error const& ex) {
     std::wstring msg_wide = ex.message().c_str();
     std::string msg(msg_wide.begin(), msg_wide.end());
-    result->Error("SEND_FAILED", "Failed to send data: " + msg);
+    result_ptr->Error("SEND_FAILED", "Failed to send data: " + msg);
   } catch (std::exception const& ex) {
-    result->Error("SEND_FAILED", "Failed to send data: " + std::string(ex.what()));
-  }
-}
-
-// Helper methods
-std::string BluetoothManager::BluetoothAddressToString(uint64_t address) {
-  std::stringstream ss;
-  ss << std::hex << std::setfill('0');
-  
-  // Format as XX:XX:XX:XX:XX:XX
-  for (int i = 5; i >= 0; i--) {
-    ss << std::setw(2) << ((address >> (i * 8)) & 0xFF);
-    if (i > 0) ss << ":";
+    result_ptr->Error("SEND_FAILED", "Failed to send data: " + std::string(ex.what()));
   }
-  
-  std::string result = ss.str();
-  // Convert to uppercase
-  std::transform(result.begin(), result.end(), result.begin(), ::toupper);
-  return result;
-}
-
-uint64_t BluetoothManager::StringToBluetoothAddress(const std::string& address) {
-  uint64_t result = 0;
-  std::string addr_no_colons = NormalizeAddress(address);
-  addr_no_colons.erase(std::remove(addr_no_colons.begin(), addr_no_colons.end(), ':'), addr_no_colons.end());
-  
-  // Parse hex string
-  std::stringstream ss;
-  ss << std::hex << addr_no_colons;
-  ss >> result;
-  
-  return result;
 }
 
-std::string BluetoothManager::NormalizeAddress(const std::string& address) {
-  std::string hex_only;
-  hex_only.reserve(address.size());
-  for (char c : address) {
-    if (std::isxdigit(static_cast<unsigned char>(c))) {
-      hex_only.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
-    }
+void BluetoothManager::Configure(
+    const flutter::EncodableMap& args,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  TransportOptions options = CurrentTransportOptions();
+  std::string error_message;
+  if (!ApplyTransportOptions(args, &options, &error_message)) {
+    result->Error("INVALID_ARGUMENT", error_message);
+    return;
   }
 
-  if (hex_only.size() != 12) {
-    return "";
+  int64_t max_connections = 0;
+  auto max_connections_it = args.find(flutter::EncodableValue("maxConnections"));
+  if (max_connections_it != args.end() &&
+      (!internal::ReadNonNegativeInt(max_connections_it->second, &max_connections) ||
+       max_connections == 0)) {
+    result->Error("INVALID_ARGUMENT", "maxConnections must be a positive integer");
+    return;
   }
 
-  std::stringstream formatted;
-  for (size_t i = 0; i < hex_only.size(); ++i) {
-    formatted << hex_only[i];
-    if (i % 2 == 1 && i < hex_only.size() - 1) {
-      formatted << ":";
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    transport_options_ = options;
+    if (max_connections > 0) {
+      connections_.set_max_connections(static_cast<size_t>(max_connections));
     }
   }
-  return formatted.str();
+  result->Success(flutter::EncodableValue(true));
 }
 
-std::string BluetoothManager::NormalizeComPort(const std::string& com_port) {
-  std::string normalized = com_port;
-  if (normalized.rfind("COM:", 0) == 0) {
-    normalized = normalized.substr(4);
+void BluetoothManager::GetConnectionStats(
+    int64_t connection_id,
+    std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
+  ConnectionEntry entry;
+  {
+    std::lock_guard<std::mutex> lock(connection_mutex_);
+    connections_.Find(connection_id, &entry);
   }
-  if (normalized.rfind("\\\\.\\", 0) == 0) {
-    normalized = normalized.substr(4);
+
+  flutter::EncodableMap stats;
+  if (entry.com) {
+    stats = entry.com->GetStats();
+    stats[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(entry.com->GetConnectionId());
+  } else if (entry.winrt) {
+    stats = entry.winrt->GetStats();
+    stats[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(entry.winrt->GetConnectionId());
+    stats[flutter::EncodableValue("sdpCacheHit")] = flutter::EncodableValue(entry.sdp_cache_hit);
   }
-  std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) {
-    return static_cast<char>(std::toupper(c));
-  });
-  return normalized;
-}
-
-std::vector<ClassicDeviceInfo> BluetoothManager::BuildMergedClassicDeviceList() {
-  std::unordered_map<std::string, ClassicDeviceInfo> merged;
-
-  BluetoothClassicRegistryEnumerator registry_enumerator;
-  auto registry_devices = registry_enumerator.EnumerateClassicSppDevices();
-  for (auto& registry_device : registry_devices) {
-    registry_device.address = NormalizeAddress(registry_device.address);
-    registry_device.com_port = NormalizeComPort(registry_device.com_port);
-    if (registry_device.connect_key.empty()) {
-      if (!registry_device.address.empty()) {
-        registry_device.connect_key = registry_device.address;
-      } else if (!registry_device.com_port.empty()) {
-        registry_device.connect_key = "COM:" + registry_device.com_port;
-      }
-    }
-    if (registry_device.connect_key.empty()) {
-      continue;
-    }
-    merged[registry_device.connect_key] = registry_device;
+  if (entry.com || entry.winrt) {
+    stats[flutter::EncodableValue("connectMs")] = flutter::EncodableValue(entry.phases.total_ms);
+    stats[flutter::EncodableValue("connectPhases")] = flutter::EncodableValue(entry.phases.ToEncodableMap());
   }
 
-  hstring selector = BluetoothDevice::GetDeviceSelectorFromPairingState(true);
-  auto devices_async = DeviceInformation::FindAllAsync(selector);
-  auto devices = RunOnBackgroundThread<decltype(devices_async.get())>(devices_async);
-  for (const auto& device_info : devices) {
-    ClassicDeviceInfo device;
-    std::wstring name_wide = device_info.Name().c_str();
-    device.name = std::string(name_wide.begin(), name_wide.end());
-    device.paired = true;
-    device.remembered = true;
-    device.source = "winrt-classic";
+  const auto now = ConnectHistory::Clock::now();
+  flutter::EncodableList history;
+  for (const auto& record : connect_history_.Records()) {
+    const ConnectHistory::Plan plan = connect_history_.PlanFor(record.address, now);
+    flutter::EncodableMap device;
+    device[flutter::EncodableValue("address")] = flutter::EncodableValue(record.address.ToString());
+    device[flutter::EncodableValue("preferred")] =
+        flutter::EncodableValue(plan.first == ConnectHistory::Path::kCom ? "COM" : "WINRT");
+    device[flutter::EncodableValue("com")] = flutter::EncodableValue(
+        PathStatsToEncodableMap(record.paths[static_cast<int>(ConnectHistory::Path::kCom)], now));
+    device[flutter::EncodableValue("winrt")] = flutter::EncodableValue(
+        PathStatsToEncodableMap(record.paths[static_cast<int>(ConnectHistory::Path::kWinRt)], now));
+    history.push_back(flutter::EncodableValue(device));
+  }
+  stats[flutter::EncodableValue("connectHistory")] = flutter::EncodableValue(history);
 
-    std::wstring id_wide = device_info.Id().c_str();
-    device.device_id = std::string(id_wide.begin(), id_wide.end());
+  const SdpServiceCache::Stats sdp = sdp_cache_.stats();
+  stats[flutter::EncodableValue("sdpCacheHits")] = flutter::EncodableValue(static_cast<int64_t>(sdp.hits));
+  stats[flutter::EncodableValue("sdpCacheMisses")] = flutter::EncodableValue(static_cast<int64_t>(sdp.misses));
+  stats[flutter::EncodableValue("sdpWarmups")] = flutter::EncodableValue(static_cast<int64_t>(sdp.warmups));
+  result->Success(flutter::EncodableValue(stats));
+}
 
-    try {
-      auto bt_device_async = BluetoothDevice::FromIdAsync(device_info.Id());
-      auto bt_device = RunOnBackgroundThread<decltype(bt_device_async.get())>(bt_device_async);
-      if (bt_device) {
-        device.address = NormalizeAddress(BluetoothAddressToString(bt_device.BluetoothAddress()));
-      }
-    } catch (...) {
-      // Keep device even if WinRT object cannot be materialized.
-    }
+flutter::EncodableMap BluetoothManager::ConnectPhases::ToEncodableMap() const {
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue("enumerationMs")] = flutter::EncodableValue(enumeration_ms);
+  map[flutter::EncodableValue("deviceLookupMs")] = flutter::EncodableValue(device_lookup_ms);
+  map[flutter::EncodableValue("sdpMs")] = flutter::EncodableValue(sdp_ms);
+  map[flutter::EncodableValue("socketConnectMs")] = flutter::EncodableValue(socket_connect_ms);
+  map[flutter::EncodableValue("comOpenMs")] = flutter::EncodableValue(com_open_ms);
+  map[flutter::EncodableValue("totalMs")] = flutter::EncodableValue(total_ms);
+  return map;
+}
 
-    if (device.address.empty()) {
-      continue;
-    }
-    device.connect_key = device.address;
+bool BluetoothManager::ConnectionEntry::IsConnected() const {
+  return (com && com->IsConnected()) || (winrt && winrt->IsConnected());
+}
 
-    auto it = merged.find(device.connect_key);
-    if (it == merged.end()) {
-      merged[device.connect_key] = device;
-      continue;
-    }
-    ClassicDeviceInfo& existing = it->second;
-    if (existing.name.empty() && !device.name.empty()) {
-      existing.name = device.name;
-    }
-    if (existing.device_id.empty()) {
-      existing.device_id = device.device_id;
-    }
-    existing.paired = existing.paired || device.paired;
-    existing.remembered = existing.remembered || device.remembered;
-    if (existing.source != "winrt-classic") {
-      existing.source = "registry+winrt";
-    }
+void BluetoothManager::ConnectionEntry::Start() const {
+  if (com) {
+    com->Start();
+  }
+  if (winrt) {
+    winrt->Start();
   }
+}
 
-  std::vector<ClassicDeviceInfo> result;
-  result.reserve(merged.size());
-  for (auto& entry : merged) {
-    ClassicDeviceInfo device = entry.second;
-    if (device.address.empty() && !device.com_port.empty()) {
-      device.address = "COM:" + device.com_port;
-    }
-    if (device.connect_key.empty()) {
-      device.connect_key = entry.first;
-    }
-    result.push_back(device);
+void BluetoothManager::ConnectionEntry::Close() const {
+  if (com) {
+    com->Close();
+  }
+  if (winrt) {
+    winrt->Close();
   }
-  return result;
 }
 
-void BluetoothManager::CacheKnownDevices(const std::vector<ClassicDeviceInfo>& devices) {
+// Helper methods
+TransportOptions BluetoothManager::CurrentTransportOptions() {
   std::lock_guard<std::mutex> lock(connection_mutex_);
-  known_devices_by_key_.clear();
-  for (const auto& device : devices) {
-    if (!device.connect_key.empty()) {
-      known_devices_by_key_[device.connect_key] = device;
-    }
-    if (!device.address.empty()) {
-      known_devices_by_key_[NormalizeAddress(device.address)] = device;
-    }
-    if (!device.com_port.empty()) {
-      known_devices_by_key_["COM:" + NormalizeComPort(device.com_port)] = device;
-    }
-  }
+  return transport_options_;
 }
 
-bool BluetoothManager::ConnectViaComLocked(const ClassicDeviceInfo& device, std::string* error_message) {
+bool BluetoothManager::CommitConnectionSlotLocked(
+    int64_t connection_id, const ConnectionEntry* entry, bool legacy) {
+  const bool rejected = entry != nullptr && shutting_down_;
+  connections_.Commit(connection_id, rejected ? nullptr : entry, legacy);
+  return !rejected;
+}
+
+size_t BluetoothManager::ServerPeerCountLocked() const {
+  return pending_server_peers_ +
+         connections_.Count([](const ConnectionEntry& entry) { return entry.server_peer; });
+}
+
+bool BluetoothManager::ConnectViaComLocked(
+    const ClassicDeviceInfo& device,
+    int64_t connection_id,
+    const TransportOptions& options,
+    ConnectionEntry* entry,
+    std::string* error_message) {
   if (device.com_port.empty()) {
     if (error_message != nullptr) {
       *error_message = "COM_NOT_FOUND";
@@ -623,117 +1156,298 @@ bool BluetoothManager::ConnectViaComLocked(const ClassicDeviceInfo& device, std:
   }
 
   auto connection = std::make_shared<BluetoothClassicComTransport>(
-      device.com_port, !device.address.empty() ? device.address : "COM:" + device.com_port, connection_handler_, data_handler_);
+      device.com_port,
+      !device.address.empty() ? device.address : "COM:" + device.com_port,
+      connection_id,
+      io_reactor_.get(),
+      worker_pool_.get(),
+      connection_handler_,
+      data_handler_,
+      options);
 
   std::string open_error;
-  if (!connection->Open(&open_error)) {
+  if (!connection->OpenPort(&open_error)) {
     if (error_message != nullptr) {
       *error_message = open_error.empty() ? "COM_OPEN_FAILED" : open_error;
     }
     return false;
   }
-  {
-    std::lock_guard<std::mutex> lock(connection_mutex_);
-    active_com_connection_ = std::move(connection);
-    active_connection_.reset();
-  }
+  entry->com = std::move(connection);
   return true;
 }
 
-bool BluetoothManager::ConnectViaWinRtLocked(const std::string& address, std::string* error_message) {
-  const std::string normalized_address = NormalizeAddress(address);
-  if (normalized_address.empty()) {
+Task<BluetoothManager::ConnectOutcome> BluetoothManager::TryComAsync(
+    ClassicDeviceInfo target,
+    int64_t connection_id,
+    TransportOptions options,
+    CancellationToken cancel) {
+  ConnectOutcome outcome;
+  if (cancel.IsCancelled()) {
+    outcome.error_message = cancel.reason();
+    outcome.cancelled = true;
+    co_return outcome;
+  }
+  const auto started = std::chrono::steady_clock::now();
+  outcome.connected = ConnectViaComLocked(
+      target, connection_id, options, &outcome.entry, &outcome.error_message);
+  outcome.elapsed_ms = MillisecondsSince(started);
+  outcome.phases.com_open_ms = outcome.elapsed_ms;
+  // The port open itself cannot be interrupted, only abandoned
+  outcome.cancelled = !outcome.connected && cancel.IsCancelled();
+  co_return outcome;
+}
+
+Task<BluetoothManager::ConnectOutcome> BluetoothManager::TryWinRtAsync(
+    std::string address,
+    int64_t connection_id,
+    TransportOptions options,
+    CancellationToken cancel) {
+  ConnectOutcome outcome;
+  const auto started = std::chrono::steady_clock::now();
+  try {
+    outcome.connected = co_await ConnectViaWinRtAsync(
+        address, connection_id, options, &outcome.entry, &outcome.error_message, &outcome.phases,
+        cancel);
+  } catch (hresult_error const& ex) {
+    std::wstring msg_wide = ex.message().c_str();
+    outcome.error_message = std::string(msg_wide.begin(), msg_wide.end());
+  } catch (std::exception const& ex) {
+    outcome.error_message = ex.what();
+  }
+  if (!outcome.connected && outcome.error_message.empty()) {
+    outcome.error_message = "WINRT_CONNECT_FAILED";
+  }
+  outcome.elapsed_ms = MillisecondsSince(started);
+  outcome.cancelled = !outcome.connected && cancel.IsCancelled();
+  co_return outcome;
+}
+
+void BluetoothManager::RecordConnectAttempt(
+    BdAddr address, ConnectHistory::Path path, const ConnectOutcome& attempt) {
+  // Attempts that never ran leave no error behind
+  if (attempt.cancelled || (!attempt.connected && attempt.error_message.empty())) {
+    return;
+  }
+  const auto now = ConnectHistory::Clock::now();
+  if (attempt.connected) {
+    connect_history_.RecordSuccess(address, path, std::chrono::milliseconds(attempt.elapsed_ms), now);
+  } else {
+    connect_history_.RecordFailure(address, path, now);
+  }
+  ScheduleHistorySave();
+}
+
+void BluetoothManager::ScheduleHistorySave() {
+  if (history_path_.empty() || history_save_pending_.exchange(true)) {
+    return;
+  }
+  worker_pool_->Post([this]() {
+    std::lock_guard<std::mutex> file_lock(history_file_mutex_);
+    history_save_pending_ = false;
+    WriteCacheFile(history_path_, EncodeConnectHistory(connect_history_.Records()));
+  });
+}
+
+Task<bool> BluetoothManager::ConnectViaWinRtAsync(
+    std::string address,
+    int64_t connection_id,
+    TransportOptions options,
+    ConnectionEntry* entry,
+    std::string* error_message,
+    ConnectPhases* phases,
+    CancellationToken cancel) {
+  BdAddr bt_address;
+  if (!BdAddr::TryParse(address, &bt_address)) {
     if (error_message != nullptr) {
       *error_message = "INVALID_BT_ADDRESS";
     }
-    return false;
+    co_return false;
   }
+  const std::string normalized_address = bt_address.ToString();
 
-  uint64_t bt_address = StringToBluetoothAddress(normalized_address);
-  auto bt_device_async = BluetoothDevice::FromBluetoothAddressAsync(bt_address);
-  auto bt_device = bt_device_async.get();
+  auto phase_started = std::chrono::steady_clock::now();
+  auto bt_device_async = BluetoothDevice::FromBluetoothAddressAsync(bt_address.value());
+  auto bt_device = co_await AwaitWinRt(bt_device_async, worker_pool_.get(), cancel);
+  phases->device_lookup_ms = MillisecondsSince(phase_started);
   if (!bt_device) {
     if (error_message != nullptr) {
       *error_message = "DEVICE_NOT_FOUND";
     }
-    return false;
+    co_return false;
   }
 
-  auto services_async = bt_device.GetRfcommServicesAsync(BluetoothCacheMode::Uncached);
-  auto services_result = services_async.get();
-  if (services_result.Services().Size() == 0) {
-    if (error_message != nullptr) {
-      *error_message = "NO_SERVICES";
-    }
-    return false;
+  std::optional<SdpServiceCache::Choice> known;
+  SdpServiceCache::Choice cached_choice;
+  if (sdp_cache_.Lookup(bt_address, &cached_choice)) {
+    known = cached_choice;
   }
 
-  RfcommServiceId spp_service_id = RfcommServiceId::SerialPort();
-  RfcommDeviceService rfcomm_service{nullptr};
-  for (const auto& service : services_result.Services()) {
-    if (service.ServiceId().Uuid() == spp_service_id.Uuid()) {
-      rfcomm_service = service;
-      break;
+  // The system's cached SDP records first; the device is only queried over
+  // the air when they hold no usable service or it does not answer on it.
+  SdpServiceCache::Choice choice;
+  phase_started = std::chrono::steady_clock::now();
+  auto rfcomm_service = co_await FindRfcommServiceAsync(
+      bt_device, BluetoothCacheMode::Cached, known, &choice, worker_pool_.get(), cancel);
+  phases->sdp_ms = MillisecondsSince(phase_started);
+  StreamSocket socket{nullptr};
+  if (rfcomm_service) {
+    StreamSocket attempt;
+    phase_started = std::chrono::steady_clock::now();
+    try {
+      auto connect_async = attempt.ConnectAsync(
+          rfcomm_service.ConnectionHostName(), rfcomm_service.ConnectionServiceName());
+      co_await AwaitWinRt(connect_async, worker_pool_.get(), cancel);
+      socket = attempt;
+    } catch (hresult_error const&) {
+      // Stale record, e.g. the service moved to another channel
+      attempt.Close();
     }
+    phases->socket_connect_ms = MillisecondsSince(phase_started);
   }
-  if (!rfcomm_service && services_result.Services().Size() > 0) {
-    rfcomm_service = services_result.Services().GetAt(0);
-  }
-  if (!rfcomm_service) {
-    if (error_message != nullptr) {
-      *error_message = "NO_SPP_SERVICE";
+  // A hit needs a remembered service and a connect that worked on it; the
+  // system's cached records alone, without an entry, count as a miss.
+  const bool cache_hit = known.has_value() && static_cast<bool>(socket);
+  sdp_cache_.CountLookup(cache_hit);
+
+  if (!socket) {
+    phase_started = std::chrono::steady_clock::now();
+    rfcomm_service = co_await FindRfcommServiceAsync(
+        bt_device, BluetoothCacheMode::Uncached, known, &choice, worker_pool_.get(), cancel);
+    phases->sdp_ms += MillisecondsSince(phase_started);
+    if (!rfcomm_service) {
+      sdp_cache_.Forget(bt_address);
+      if (error_message != nullptr) {
+        *error_message = "NO_SERVICES";
+      }
+      co_return false;
     }
-    return false;
+    socket = StreamSocket();
+    phase_started = std::chrono::steady_clock::now();
+    auto connect_async =
+        socket.ConnectAsync(rfcomm_service.ConnectionHostName(), rfcomm_service.ConnectionServiceName());
+    co_await AwaitWinRt(connect_async, worker_pool_.get(), cancel);
+    phases->socket_connect_ms += MillisecondsSince(phase_started);
   }
+  sdp_cache_.Record(bt_address, choice);
+  entry->sdp_cache_hit = cache_hit;
 
-  StreamSocket socket;
-  auto connect_async =
-      socket.ConnectAsync(rfcomm_service.ConnectionHostName(), rfcomm_service.ConnectionServiceName());
-  connect_async.get();
+  entry->winrt = std::make_shared<BluetoothConnection>(
+      socket, normalized_address, connection_id, worker_pool_.get(), connection_handler_,
+      data_handler_, options);
+  co_return true;
+}
 
-  auto connection =
-      std::make_shared<BluetoothConnection>(socket, normalized_address, connection_handler_, data_handler_);
-  {
-    std::lock_guard<std::mutex> lock(connection_mutex_);
-    active_connection_ = std::move(connection);
-    active_com_connection_.reset();
+void BluetoothManager::WarmSdpCache(const ClassicDeviceInfo& device) {
+  BdAddr address;
+  if (!BdAddr::TryParse(device.address, &address) || !sdp_cache_.QueueWarmup(address)) {
+    return;
+  }
+  Spawn(RunSdpWarmupsAsync(), [](std::future<void> finished) {
+    try {
+      finished.get();
+    } catch (...) {
+    }
+  });
+}
+
+Task<void> BluetoothManager::RunSdpWarmupsAsync() {
+  co_await ResumeOn(worker_pool_.get());
+
+  const CancellationToken shutdown = shutdown_cancel_.token();
+  BdAddr address;
+  while (!shutdown.IsCancelled() && sdp_cache_.NextWarmup(&address)) {
+    CancellationSource timeout;
+    timeout.CancelAfter(worker_pool_.get(), kSdpWarmupTimeout);
+    CancellationRegistration stop = shutdown.OnCancel([timeout]() mutable { timeout.Cancel(); });
+    try {
+      auto bt_device_async = BluetoothDevice::FromBluetoothAddressAsync(address.value());
+      auto bt_device = co_await AwaitWinRt(bt_device_async, worker_pool_.get(), timeout.token());
+      if (!bt_device) {
+        continue;
+      }
+      SdpServiceCache::Choice choice;
+      auto service = co_await FindRfcommServiceAsync(
+          bt_device, BluetoothCacheMode::Cached, std::nullopt, &choice, worker_pool_.get(),
+          timeout.token());
+      if (!service) {
+        service = co_await FindRfcommServiceAsync(
+            bt_device, BluetoothCacheMode::Uncached, std::nullopt, &choice, worker_pool_.get(),
+            timeout.token());
+      }
+      if (service) {
+        sdp_cache_.Record(address, choice);
+        sdp_cache_.CountWarmup();
+      }
+    } catch (...) {
+      // Out of range or too slow; tried again when the device shows up next
+    }
   }
-  return true;
 }
 
 // Device watcher callbacks
 void BluetoothManager::OnDeviceAdded(
     DeviceWatcher const& sender,
     DeviceInformation const& device_info) {
-  
+  uint64_t session = 0;
+  {
+    std::lock_guard<std::mutex> lock(discovery_mutex_);
+    session = discovery_session_;
+  }
+  // The address lookup is awaited, not waited for: a burst of found
+  // devices no longer holds one worker each.
+  Spawn(AddDiscoveredDeviceAsync(device_info, session), [](std::future<void> finished) {
+    try {
+      finished.get();
+    } catch (...) {
+    }
+  });
+}
+
+Task<void> BluetoothManager::AddDiscoveredDeviceAsync(DeviceInformation device_info, uint64_t session) {
   try {
     // Get Bluetooth device to get address
     auto bt_device_async = BluetoothDevice::FromIdAsync(device_info.Id());
-    auto bt_device = RunOnBackgroundThread<decltype(bt_device_async.get())>(bt_device_async);
+    auto bt_device = co_await AwaitWinRt(bt_device_async, worker_pool_.get(), shutdown_cancel_.token());
     
-    if (!bt_device) return;
+    if (!bt_device) co_return;
 
     ClassicDeviceInfo device;
     std::wstring name_wide = device_info.Name().c_str();
     device.name = std::string(name_wide.begin(), name_wide.end());
-    device.address = NormalizeAddress(BluetoothAddressToString(bt_device.BluetoothAddress()));
+    const BdAddr bt_address(bt_device.BluetoothAddress());
+    device.address = bt_address.ToString();
     device.paired = device_info.Pairing().IsPaired();
     device.remembered = true;
     device.source = "winrt-discovery";
     device.connect_key = device.address;
 
-    std::lock_guard<std::mutex> lock(connection_mutex_);
-    auto known = known_devices_by_key_.find(device.connect_key);
-    if (known != known_devices_by_key_.end()) {
-      device.com_port = known->second.com_port;
+    std::shared_ptr<const PairedDeviceIndex::Snapshot> paired = device_index_->Current();
+    if (const ClassicDeviceInfo* paired_device = paired->FindByAddress(bt_address)) {
+      device.com_port = paired_device->com_port;
     }
-    known_devices_by_key_[device.connect_key] = device;
 
-    flutter::EncodableMap event_map;
-    event_map[flutter::EncodableValue("event")] = flutter::EncodableValue("deviceFound");
-    event_map[flutter::EncodableValue("device")] = flutter::EncodableValue(device.ToEncodableMap());
-    
-    state_handler_->Success(flutter::EncodableValue(event_map));
+    std::wstring id_wide = device_info.Id().c_str();
+    device.device_id = std::string(id_wide.begin(), id_wide.end());
+
+    // Events are sent under the lock so they reach Dart in the order the
+    // cache applied them
+    std::lock_guard<std::mutex> lock(discovery_mutex_);
+    if (session != discovery_session_) {
+      // Found by a session that was stopped while the lookup ran
+      co_return;
+    }
+    std::vector<ClassicDeviceInfo> evicted;
+    const DiscoveryCache::Change change =
+        discovered_devices_.Upsert(device, DiscoveryCache::Clock::now(), &evicted);
+    for (const auto& lost : evicted) {
+      EmitDiscoveryEventLocked("deviceLost", lost);
+    }
+    if (change == DiscoveryCache::Change::kAdded) {
+      EmitDiscoveryEventLocked("deviceFound", device);
+      WarmSdpCache(device);
+    } else if (change == DiscoveryCache::Change::kUpdated) {
+      EmitDiscoveryEventLocked("deviceUpdated", device);
+    }
   }
   catch (...) {
     // Ignore errors for individual devices
@@ -743,13 +1457,127 @@ void BluetoothManager::OnDeviceAdded(
 void BluetoothManager::OnDeviceUpdated(
     DeviceWatcher const& sender,
     DeviceInformationUpdate const& device_info_update) {
-  // Not needed for now
+  try {
+    std::optional<std::string> name;
+    std::optional<bool> paired;
+    auto properties = device_info_update.Properties();
+    if (properties.HasKey(L"System.ItemNameDisplay")) {
+      auto value = properties.Lookup(L"System.ItemNameDisplay").try_as<IPropertyValue>();
+      if (value && value.Type() == PropertyType::String) {
+        std::wstring name_wide = value.GetString().c_str();
+        name = std::string(name_wide.begin(), name_wide.end());
+      }
+    }
+    if (properties.HasKey(L"System.Devices.Aep.IsPaired")) {
+      auto value = properties.Lookup(L"System.Devices.Aep.IsPaired").try_as<IPropertyValue>();
+      if (value && value.Type() == PropertyType::Boolean) {
+        paired = value.GetBoolean();
+      }
+    }
+
+    std::wstring id_wide = device_info_update.Id().c_str();
+    const std::string device_id(id_wide.begin(), id_wide.end());
+
+    std::lock_guard<std::mutex> lock(discovery_mutex_);
+    const ClassicDeviceInfo* updated =
+        discovered_devices_.Update(device_id, name, paired, DiscoveryCache::Clock::now());
+    if (updated != nullptr) {
+      EmitDiscoveryEventLocked("deviceUpdated", *updated);
+    }
+  }
+  catch (...) {
+    // Ignore errors for individual devices
+  }
 }
 
 void BluetoothManager::OnDeviceRemoved(
     DeviceWatcher const& sender,
     DeviceInformationUpdate const& device_info_update) {
-  // Not needed for now
+  std::wstring id_wide = device_info_update.Id().c_str();
+  const std::string device_id(id_wide.begin(), id_wide.end());
+
+  std::lock_guard<std::mutex> lock(discovery_mutex_);
+  ClassicDeviceInfo removed;
+  if (discovered_devices_.Remove(device_id, &removed)) {
+    EmitDiscoveryEventLocked("deviceLost", removed);
+  }
+}
+
+void BluetoothManager::SweepDiscoveredDevices(uint64_t session) {
+  std::lock_guard<std::mutex> lock(discovery_mutex_);
+  if (session != discovery_session_ || !discovery_running_) {
+    return;
+  }
+  for (const auto& lost : discovered_devices_.Expire(DiscoveryCache::Clock::now())) {
+    EmitDiscoveryEventLocked("deviceLost", lost);
+  }
+  worker_pool_->PostAfter(kDiscoverySweepInterval,
+                          [this, session]() { SweepDiscoveredDevices(session); });
+}
+
+void BluetoothManager::EmitDiscoveryEventLocked(const char* event, const ClassicDeviceInfo& device) {
+  if (batch_options_.interval.count() == 0) {
+    SendDiscoveryEvent(event, device);
+    return;
+  }
+
+  const std::string_view kind(event);
+  if (kind == "deviceFound") {
+    const bool first = discovery_batch_.empty();
+    if (discovery_batch_.Add(device)) {
+      FlushDiscoveryBatchLocked();
+    } else if (first) {
+      const uint64_t generation = batch_generation_;
+      worker_pool_->PostAfter(batch_options_.interval,
+                              [this, generation]() { OnDiscoveryBatchTimer(generation); });
+    }
+    return;
+  }
+
+  // Dart has not seen a device that is still pending: fold the change into
+  // the batch, or drop the device without a deviceLost.
+  BdAddr address;
+  if (BdAddr::TryParse(device.address, &address) && discovery_batch_.Contains(address)) {
+    if (kind == "deviceLost") {
+      discovery_batch_.Discard(address);
+    } else {
+      discovery_batch_.Add(device);
+    }
+    return;
+  }
+
+  // Anything else must not overtake the devices found before it
+  FlushDiscoveryBatchLocked();
+  SendDiscoveryEvent(event, device);
+}
+
+void BluetoothManager::FlushDiscoveryBatchLocked() {
+  if (discovery_batch_.empty()) {
+    return;
+  }
+  ++batch_generation_;
+  flutter::EncodableList device_list;
+  for (const auto& device : discovery_batch_.Take()) {
+    device_list.push_back(flutter::EncodableValue(device.ToEncodableMap()));
+  }
+  flutter::EncodableMap event_map;
+  event_map[flutter::EncodableValue("event")] = flutter::EncodableValue("devicesFound");
+  event_map[flutter::EncodableValue("devices")] = flutter::EncodableValue(device_list);
+  state_handler_->Success(flutter::EncodableValue(event_map));
+}
+
+void BluetoothManager::OnDiscoveryBatchTimer(uint64_t generation) {
+  std::lock_guard<std::mutex> lock(discovery_mutex_);
+  if (generation == batch_generation_) {
+    FlushDiscoveryBatchLocked();
+  }
+}
+
+void BluetoothManager::SendDiscoveryEvent(const char* event, const ClassicDeviceInfo& device) {
+  flutter::EncodableMap event_map;
+  event_map[flutter::EncodableValue("event")] = flutter::EncodableValue(event);
+  event_map[flutter::EncodableValue("device")] = flutter::EncodableValue(device.ToEncodableMap());
+  state_handler_->Success(flutter::EncodableValue(event_map));
 }
 
 void BluetoothManager::OnEnumerationCompleted(
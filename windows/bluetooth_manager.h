@@ -13,6 +13,9 @@
 #include <winrt/Windows.Networking.Sockets.h>
 #include <winrt/Windows.Storage.Streams.h>
 
+#include <atomic>
+#include <chrono>
+#include <coroutine>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -21,10 +24,19 @@
 #include <unordered_map>
 #include <functional>
 #include <future>
-#include <thread>
-#include <type_traits>
 
+#include "async_task.h"
+#include "bluetooth_address.h"
 #include "bluetooth_device_model.h"
+#include "bluetooth_server.h"
+#include "bluetooth_transport_options.h"
+#include "connect_history.h"
+#include "connection_table.h"
+#include "discovery_batch.h"
+#include "discovery_cache.h"
+#include "paired_device_index.h"
+#include "sdp_service_cache.h"
+#include "worker_pool.h"
 
 namespace flutter_bluetooth_classic {
 
@@ -33,7 +45,7 @@ template<typename T>
 class EventStreamHandler;
 class BluetoothConnection;
 class BluetoothClassicComTransport;
-class BluetoothServer;
+class IoReactor;
 
 class BluetoothManager {
 public:
@@ -51,77 +63,243 @@ public:
   void IsBluetoothEnabled(
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // progressive answers at once with what the index holds (registry rows
+  // are there within milliseconds) and streams later changes as
+  // devicesUpdated events on the state channel. The event that ends the
+  // initial build has complete set; if the build had already ended, one
+  // such event repeating the answer follows it.
   void GetPairedDevices(
+      bool progressive,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // With batch.interval > 0, found devices are sent as devicesFound lists
+  // instead of one deviceFound each.
   void StartDiscovery(
+      const DiscoveryBatchOptions& batch,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
   void StopDiscovery(
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // Legacy single-link connect: replaces the previous handle-less
+  // connection and completes with true. A connect to another target while
+  // one is in flight supersedes it (CONNECTION_SUPERSEDED).
   void Connect(
       const std::string& address,
+      const flutter::EncodableMap& options,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // Adds a connection to the table without touching existing ones and
+  // completes with its handle.
+  //
+  // For both, a request identical to one in flight (same target, kind and
+  // options) joins it and completes with the same result. A
+  // connectTimeoutMs option bounds the whole attempt (CONNECTION_TIMEOUT).
+  // Failures carry the connect's phase timings as error details.
+  void OpenConnection(
+      const std::string& address,
+      const flutter::EncodableMap& options,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Every accepted peer becomes its own connection. At most max_peers are
+  // kept; policy decides what happens to the next one.
   void Listen(
       const std::string& app_name,
+      size_t max_peers,
+      AdmissionPolicy policy,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // Aborts connects still in flight to address (all of them if empty);
+  // their callers get CONNECTION_CANCELLED. Completes with whether there
+  // was any.
+  void CancelConnect(
+      const std::string& address,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // connection_id 0 closes every connection.
   void Disconnect(
+      int64_t connection_id,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
   void StopListen(
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  // connection_id 0 targets the default connection (see FindConnectionLocked).
   void SendData(
+      int64_t connection_id,
       const std::vector<uint8_t>& data,
       std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
 
+  void Configure(
+      const flutter::EncodableMap& args,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
+  // Also reports how the connection was set up (connectMs, connectPhases,
+  // sdpCacheHit),
+  // the SDP cache hit counts across all WinRT connects and the per-device
+  // connect history (connectHistory).
+  void GetConnectionStats(
+      int64_t connection_id,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+
 private:
+  // Where a connect spent its time, in milliseconds; phases that did not
+  // run stay 0. Raced paths overlap, so the phases can add up to more
+  // than total_ms.
+  struct ConnectPhases {
+    int64_t enumeration_ms = 0;
+    int64_t device_lookup_ms = 0;
+    int64_t sdp_ms = 0;
+    int64_t socket_connect_ms = 0;
+    int64_t com_open_ms = 0;
+    int64_t total_ms = 0;
+
+    flutter::EncodableMap ToEncodableMap() const;
+  };
+
+  // One row of the connection table. Exactly one transport is set.
+  struct ConnectionEntry {
+    std::shared_ptr<BluetoothClassicComTransport> com;
+    std::shared_ptr<BluetoothConnection> winrt;
+    bool server_peer = false;
+    // How the link was set up, for getConnectionStats
+    ConnectPhases phases;
+    bool sdp_cache_hit = false;
+
+    bool IsConnected() const;
+    // Announces the link and starts its I/O; connects leave that to the
+    // caller so a losing attempt can be dropped silently.
+    void Start() const;
+    void Close() const;
+  };
+
+  // Result of one connect attempt; error_message is set when !connected.
+  struct ConnectOutcome {
+    ConnectionEntry entry;
+    bool connected = false;
+    std::string error_message;
+    // Set by the race legs: how long the attempt took, and whether it was
+    // cut short (lost the race, shutdown) rather than failing on its own.
+    int64_t elapsed_ms = 0;
+    bool cancelled = false;
+    ConnectPhases phases;
+  };
+
+  // A connect in flight, keyed by its reserved handle in connects_in_flight_.
+  // Guarded by connection_mutex_ except cancel, which is cancelled outside
+  // it once abort_code is set.
+  struct PendingConnect {
+    std::string key;
+    bool replace_legacy = false;
+    TransportOptions options;
+    std::chrono::milliseconds timeout{0};
+    // Set once superseded or cancelled; its callers get this error
+    std::string abort_code;
+    std::string abort_message;
+    CancellationSource cancel;
+    CancellationRegistration shutdown_forward;
+    // The caller that started it plus everyone who joined
+    std::vector<std::shared_ptr<flutter::MethodResult<flutter::EncodableValue>>> results;
+  };
+
+  static constexpr size_t kDefaultMaxConnections = 8;
+  // Discovery keeps at most this many devices, each until it has not been
+  // seen for kDiscoveryMaxAge; the sweep runs every kDiscoverySweepInterval.
+  static constexpr size_t kDiscoveryCapacity = 512;
+  static constexpr std::chrono::seconds kDiscoveryMaxAge{120};
+  static constexpr std::chrono::seconds kDiscoverySweepInterval{15};
+  // SDP choices are kept for kSdpCacheCapacity devices. Background lookups
+  // run one at a time, at most kSdpWarmupQueue waiting, each given up
+  // after kSdpWarmupTimeout.
+  static constexpr size_t kSdpCacheCapacity = 256;
+  static constexpr size_t kSdpWarmupQueue = 32;
+  static constexpr std::chrono::seconds kSdpWarmupTimeout{10};
+  // Head start of the leading path before the other one joins the race
+  static constexpr std::chrono::milliseconds kConnectStagger{300};
+  static constexpr size_t kConnectHistoryCapacity = 64;
+
   // Helper methods
-  void InitializeBluetoothRadio();
-  std::string BluetoothAddressToString(uint64_t address);
-  uint64_t StringToBluetoothAddress(const std::string& address);
-  std::string NormalizeAddress(const std::string& address);
-  std::string NormalizeComPort(const std::string& com_port);
-  std::vector<ClassicDeviceInfo> BuildMergedClassicDeviceList();
-  void CacheKnownDevices(const std::vector<ClassicDeviceInfo>& devices);
-  bool ConnectViaComLocked(const ClassicDeviceInfo& device, std::string* error_message);
-  bool ConnectViaWinRtLocked(const std::string& address, std::string* error_message);
-  
-  // Template helper to run async operations on a background thread
-  template<typename TResult, typename TAsync>
-  TResult RunOnBackgroundThread(TAsync async_operation) {
-    std::promise<TResult> promise;
-    auto future = promise.get_future();
-    
-    std::thread worker([op = std::move(async_operation), &promise]() {
-      winrt::init_apartment(winrt::apartment_type::multi_threaded);
-      try {
-        if constexpr (std::is_void_v<TResult>) {
-          op.get();
-          promise.set_value();
-        } else {
-          auto result = op.get();
-          promise.set_value(result);
-        }
-      } catch (...) {
-        try {
-          promise.set_exception(std::current_exception());
-        } catch (...) {}
-      }
-      winrt::uninit_apartment();
-    });
-    
-    worker.join();  // Use join instead of detach to ensure proper cleanup
-    return future.get();
-  }
-  
+  // Looks up the radio once, at construction; radio_ready_ is set when done,
+  // found or not.
+  Task<void> InitializeBluetoothRadioAsync();
+  // The Bluetooth radio, or nullptr without one, once the lookup finished
+  Task<winrt::Windows::Devices::Radios::Radio> BluetoothRadioAsync();
+  // Suspends until radio_ready_; resumed on a worker.
+  struct RadioReadyAwaiter {
+    BluetoothManager* manager;
+    bool await_ready() const;
+    bool await_suspend(std::coroutine_handle<> handle) const;
+    void await_resume() const {}
+  };
+  TransportOptions CurrentTransportOptions();
+  // Sets connected on devices that have an open link (COM or WinRT)
+  void MarkConnectedDevices(std::vector<ClassicDeviceInfo>* devices);
+  void OnPairedDevicesChanged(const PairedDeviceIndex::Changes& changes);
+  void SendPairedDevicesEvent(const PairedDeviceIndex::Changes& changes);
+  void OpenConnectionAsync(
+      const std::string& address,
+      const flutter::EncodableMap& options,
+      bool replace_legacy,
+      std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result);
+  // Parameters are taken by value: they must outlive every suspension.
+  Task<ConnectOutcome> ConnectAsync(
+      std::string address,
+      int64_t connection_id,
+      TransportOptions transport_options,
+      ConnectionEntry replaced,
+      CancellationToken cancel);
+  // Releases a reservation; a non-null entry is added to the table. Returns
+  // false once the manager is shutting down, in which case the caller
+  // closes the entry.
+  bool CommitConnectionSlotLocked(int64_t connection_id, const ConnectionEntry* entry, bool legacy);
+  size_t ServerPeerCountLocked() const;
+  void AcceptServerPeer(
+      winrt::Windows::Networking::Sockets::StreamSocket socket,
+      const std::string& device_address,
+      size_t max_peers,
+      AdmissionPolicy policy);
+  bool ConnectViaComLocked(
+      const ClassicDeviceInfo& device,
+      int64_t connection_id,
+      const TransportOptions& options,
+      ConnectionEntry* entry,
+      std::string* error_message);
+  // Connect race legs: each reports failure in the outcome instead of
+  // throwing, and neither starts the link.
+  Task<ConnectOutcome> TryComAsync(
+      ClassicDeviceInfo target,
+      int64_t connection_id,
+      TransportOptions options,
+      CancellationToken cancel);
+  Task<ConnectOutcome> TryWinRtAsync(
+      std::string address,
+      int64_t connection_id,
+      TransportOptions options,
+      CancellationToken cancel);
+  // Feeds a finished attempt into connect_history_ (cancelled attempts
+  // say nothing about the path) and schedules a save.
+  void RecordConnectAttempt(BdAddr address, ConnectHistory::Path path, const ConnectOutcome& attempt);
+  void ScheduleHistorySave();
+  Task<bool> ConnectViaWinRtAsync(
+      std::string address,
+      int64_t connection_id,
+      TransportOptions options,
+      ConnectionEntry* entry,
+      std::string* error_message,
+      ConnectPhases* phases,
+      CancellationToken cancel);
+  // Looks up the device's RFCOMM service ahead of a connect (see sdp_cache_)
+  void WarmSdpCache(const ClassicDeviceInfo& device);
+  Task<void> RunSdpWarmupsAsync();
+
   // Device watcher callbacks
   void OnDeviceAdded(
       winrt::Windows::Devices::Enumeration::DeviceWatcher const& sender,
       winrt::Windows::Devices::Enumeration::DeviceInformation const& deviceInfo);
+  // Resolves the address of a device the watcher added and records it,
+  // unless discovery was stopped or restarted (session) meanwhile.
+  Task<void> AddDiscoveredDeviceAsync(
+      winrt::Windows::Devices::Enumeration::DeviceInformation device_info, uint64_t session);
   
   void OnDeviceUpdated(
       winrt::Windows::Devices::Enumeration::DeviceWatcher const& sender,
@@ -135,14 +313,25 @@ private:
       winrt::Windows::Devices::Enumeration::DeviceWatcher const& sender,
       winrt::Windows::Foundation::IInspectable const& obj);
 
+  // Drops devices that aged out and re-arms itself while session is current
+  void SweepDiscoveredDevices(uint64_t session);
+  void SendDiscoveryEvent(const char* event, const ClassicDeviceInfo& device);
+  // Routes a discovery event through the batch when batching is on
+  void EmitDiscoveryEventLocked(const char* event, const ClassicDeviceInfo& device);
+  void FlushDiscoveryBatchLocked();
+  void OnDiscoveryBatchTimer(uint64_t generation);
+
   // Stream handlers (not owned)
   EventStreamHandler<flutter::EncodableValue>* state_handler_;
   EventStreamHandler<flutter::EncodableValue>* connection_handler_;
   EventStreamHandler<flutter::EncodableValue>* data_handler_;
 
-  // Bluetooth radio
+  // Bluetooth radio, guarded by radio_mutex_
   winrt::Windows::Devices::Radios::Radio bluetooth_radio_{nullptr};
   winrt::event_token radio_state_token_{};
+  bool radio_ready_ = false;
+  std::vector<std::coroutine_handle<>> radio_waiters_;
+  std::mutex radio_mutex_;
 
   // Device watcher
   winrt::Windows::Devices::Enumeration::DeviceWatcher device_watcher_{nullptr};
@@ -151,15 +340,54 @@ private:
   winrt::event_token watcher_removed_token_{};
   winrt::event_token watcher_completed_token_{};
 
-  // Active connection
-  std::shared_ptr<BluetoothConnection> active_connection_;
-  std::shared_ptr<BluetoothClassicComTransport> active_com_connection_;
+  // Open connections keyed by handle
+  ConnectionTable<ConnectionEntry> connections_{kDefaultMaxConnections};
+  std::map<int64_t, std::shared_ptr<PendingConnect>> connects_in_flight_;
+  size_t pending_server_peers_ = 0;
+  bool shutting_down_ = false;
   std::mutex connection_mutex_;
-  std::unordered_map<std::string, ClassicDeviceInfo> known_devices_by_key_;
+  // Cancelled by the destructor; every connect and enumeration observes it.
+  CancellationSource shutdown_cancel_;
+  // Devices seen by the current discovery session (paired devices live in
+  // device_index_). discovery_session_ changes on every start and stop so
+  // an aging sweep from an earlier session stops rescheduling itself.
+  DiscoveryCache discovered_devices_{kDiscoveryCapacity, kDiscoveryMaxAge};
+  uint64_t discovery_session_ = 0;
+  bool discovery_running_ = false;
+  // Opt-in batching of found devices; batch_generation_ changes on every
+  // flush so a timer armed for an earlier batch does nothing.
+  DiscoveryBatchOptions batch_options_;
+  DiscoveryBatch discovery_batch_;
+  uint64_t batch_generation_ = 0;
+  std::mutex discovery_mutex_;
+  TransportOptions transport_options_;
 
   // Server for incoming connections
-  std::unique_ptr<BluetoothServer> bluetooth_server_;
+  // Shared so a start in progress keeps the server it is starting alive
+  std::shared_ptr<BluetoothServer> bluetooth_server_;
   std::mutex server_mutex_;
+
+  // Live paired-device list. Declared before the pool so that jobs the pool
+  // drains on shutdown can still reach it.
+  std::shared_ptr<PairedDeviceIndex> device_index_;
+  // Set by the first progressive getPairedDevices; devicesUpdated events are
+  // only sent from then on.
+  std::atomic<bool> stream_paired_changes_{false};
+  // RFCOMM service per device for WinRT connects, warmed from discovery
+  // and the paired list.
+  SdpServiceCache sdp_cache_{kSdpCacheCapacity, kSdpWarmupQueue};
+  // Which path worked per device; saved next to the paired-device cache.
+  // history_save_pending_ coalesces saves, history_file_mutex_ serializes
+  // the writers.
+  ConnectHistory connect_history_{kConnectHistoryCapacity};
+  std::wstring history_path_;
+  std::atomic<bool> history_save_pending_{false};
+  std::mutex history_file_mutex_;
+
+  // Shared executor for connects and transport I/O. The reactor is declared
+  // last so it is destroyed before the pool it posts to.
+  std::unique_ptr<WorkerPool> worker_pool_;
+  std::unique_ptr<IoReactor> io_reactor_;
 };
 
 }  // namespace flutter_bluetooth_classic
@@ -0,0 +1,68 @@
+#ifndef FLUTTER_PLUGIN_BLUETOOTH_SEND_QUEUE_BUDGET_H_
+#define FLUTTER_PLUGIN_BLUETOOTH_SEND_QUEUE_BUDGET_H_
+
+#include <cstddef>
+
+#include "bluetooth_transport_options.h"
+
+namespace flutter_bluetooth_classic {
+
+// Byte accounting for a transport's outbound queue with hysteresis between
+// the high and low watermarks. Not thread-safe; callers hold their queue lock.
+class SendQueueBudget {
+ public:
+  enum class Transition {
+    kNone,
+    kBackpressure,
+    kWritable,
+  };
+
+  explicit SendQueueBudget(const TransportOptions& options)
+      : max_bytes_(options.send_queue_max_bytes),
+        high_watermark_(options.send_queue_high_watermark_bytes),
+        low_watermark_(options.send_queue_low_watermark_bytes) {}
+
+  // Accounts for bytes about to be queued. Fails if that would exceed the
+  // hard limit, except on an empty queue so oversized payloads still go out.
+  bool TryReserve(size_t bytes, Transition* transition) {
+    *transition = Transition::kNone;
+    if (queued_bytes_ > 0 && bytes > max_bytes_ - queued_bytes_) {
+      return false;
+    }
+    queued_bytes_ += bytes;
+    if (!backpressured_ && queued_bytes_ >= high_watermark_ && high_watermark_ > 0) {
+      backpressured_ = true;
+      *transition = Transition::kBackpressure;
+    }
+    return true;
+  }
+
+  // Accounts for bytes the driver has accepted.
+  Transition Release(size_t bytes) {
+    queued_bytes_ = bytes > queued_bytes_ ? 0 : queued_bytes_ - bytes;
+    if (backpressured_ && queued_bytes_ <= low_watermark_) {
+      backpressured_ = false;
+      return Transition::kWritable;
+    }
+    return Transition::kNone;
+  }
+
+  void Reset() {
+    queued_bytes_ = 0;
+    backpressured_ = false;
+  }
+
+  size_t queued_bytes() const { return queued_bytes_; }
+  bool backpressured() const { return backpressured_; }
+
+ private:
+  size_t max_bytes_;
+  size_t high_watermark_;
+  size_t low_watermark_;
+  size_t queued_bytes_ = 0;
+  bool backpressured_ = false;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_BLUETOOTH_SEND_QUEUE_BUDGET_H_
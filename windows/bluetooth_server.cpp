@@ -1,12 +1,12 @@
 #include "bluetooth_server.h"
-#include "bluetooth_connection.h"
 #include "flutter_bluetooth_classic_plugin.h"
 
 #include <winrt/Windows.Foundation.h>
 #include <winrt/Windows.Storage.Streams.h>
 #include <winerror.h>
-#include <future>
-#include <thread>
+
+#include "winrt_awaitable.h"
+#include "worker_pool.h"
 
 using namespace winrt;
 using namespace Windows::Foundation;
@@ -17,12 +17,12 @@ namespace flutter_bluetooth_classic {
 
 BluetoothServer::BluetoothServer(
     const std::string& service_name,
+    WorkerPool* workers,
     EventStreamHandler<flutter::EncodableValue>* connection_handler,
-    EventStreamHandler<flutter::EncodableValue>* data_handler,
     ConnectionCallback on_connection)
     : service_name_(service_name),
+      workers_(workers),
       connection_handler_(connection_handler),
-      data_handler_(data_handler),
       on_connection_(on_connection) {
 }
 
@@ -30,28 +30,34 @@ BluetoothServer::~BluetoothServer() {
   StopListening();
 }
 
-void BluetoothServer::StartListening() {
+Task<void> BluetoothServer::StartListeningAsync() {
   if (is_listening_) {
-    return;
+    co_return;
   }
 
   try {
-    InitializeServiceProvider();
+    co_await InitializeServiceProviderAsync(start_cancel_.token());
     is_listening_ = true;
   }
-  catch (hresult_error const&) {
+  catch (...) {
+    // Nothing else touches the listener until is_listening_ is set
     is_listening_ = false;
+    ReleaseListener();
     throw;
   }
 }
 
 void BluetoothServer::StopListening() {
+  start_cancel_.Cancel();
   if (!is_listening_) {
     return;
   }
 
   is_listening_ = false;
+  ReleaseListener();
+}
 
+void BluetoothServer::ReleaseListener() {
   // Unregister connection received handler
   if (socket_listener_ && connection_received_token_) {
     socket_listener_.ConnectionReceived(connection_received_token_);
@@ -74,31 +80,14 @@ void BluetoothServer::StopListening() {
   }
 }
 
-void BluetoothServer::InitializeServiceProvider() {
+Task<void> BluetoothServer::InitializeServiceProviderAsync(CancellationToken cancel) {
   // Create RFCOMM service provider for Serial Port Profile (SPP)
   // SPP UUID: 00001101-0000-1000-8000-00805F9B34FB
   RfcommServiceId spp_service_id = RfcommServiceId::SerialPort();
   
-  // Run on background thread to avoid STA issues
+  // Resumes on a worker, so the rest runs in the MTA
   auto provider_async = RfcommServiceProvider::CreateAsync(spp_service_id);
-  
-  std::promise<decltype(provider_async.get())> promise;
-  auto future = promise.get_future();
-  std::thread worker([op = std::move(provider_async), &promise]() {
-    winrt::init_apartment(winrt::apartment_type::multi_threaded);
-    try {
-      auto result = op.get();
-      promise.set_value(result);
-    } catch (...) {
-      try {
-        promise.set_exception(std::current_exception());
-      } catch (...) {}
-    }
-    winrt::uninit_apartment();
-  });
-  
-  worker.join();  // Use join instead of detach to ensure proper cleanup
-  service_provider_ = future.get();
+  service_provider_ = co_await AwaitWinRt(provider_async, workers_, cancel);
 
   if (!service_provider_) {
     throw hresult_error(E_FAIL, L"Failed to create RFCOMM service provider");
@@ -120,16 +109,9 @@ void BluetoothServer::InitializeServiceProvider() {
           std::wstring remote_host_wide = socket.Information().RemoteAddress().DisplayName().c_str();
           std::string device_address(remote_host_wide.begin(), remote_host_wide.end());
 
-          // Create connection object
-          auto connection = std::make_unique<BluetoothConnection>(
-              socket,
-              device_address,
-              connection_handler_,
-              data_handler_);
-
           // Notify via callback
           if (on_connection_) {
-            on_connection_(std::move(connection));
+            on_connection_(socket, device_address);
           }
         }
         catch (hresult_error const& ex) {
@@ -151,24 +133,7 @@ void BluetoothServer::InitializeServiceProvider() {
       service_provider_.ServiceId().AsString(),
       SocketProtectionLevel::BluetoothEncryptionAllowNullAuthentication);
   
-  // Run on background thread to avoid STA issues (returns void)
-  std::promise<void> bind_promise;
-  auto bind_future = bind_promise.get_future();
-  std::thread bind_worker([op = std::move(bind_async), &bind_promise]() {
-    winrt::init_apartment(winrt::apartment_type::multi_threaded);
-    try {
-      op.get();
-      bind_promise.set_value();
-    } catch (...) {
-      try {
-        bind_promise.set_exception(std::current_exception());
-      } catch (...) {}
-    }
-    winrt::uninit_apartment();
-  });
-  
-  bind_worker.join();  // Use join instead of detach to ensure proper cleanup
-  bind_future.get();
+  co_await AwaitWinRt(bind_async, workers_, cancel);
 
   // Set SDP attributes for the service
   try {
@@ -12,29 +12,58 @@
 #include <atomic>
 #include <functional>
 
+#include "async_task.h"
+
 namespace flutter_bluetooth_classic {
 
 template<typename T>
 class EventStreamHandler;
+class WorkerPool;
+
+// A piconet has at most seven active peripherals.
+constexpr size_t kDefaultMaxServerPeers = 7;
+
+// What the server does with a peer that arrives while it is full.
+enum class AdmissionPolicy {
+  // Close the new socket and keep the existing peers.
+  kReject,
+  // Close the longest-connected peer to make room.
+  kEvictOldest,
+};
 
-class BluetoothConnection;
+inline bool ParseAdmissionPolicy(const std::string& value, AdmissionPolicy* policy) {
+  if (value == "reject") {
+    *policy = AdmissionPolicy::kReject;
+    return true;
+  }
+  if (value == "evictOldest") {
+    *policy = AdmissionPolicy::kEvictOldest;
+    return true;
+  }
+  return false;
+}
 
 class BluetoothServer {
 public:
-  using ConnectionCallback = std::function<void(std::unique_ptr<BluetoothConnection>)>;
+  // Receives each accepted socket; the owner wraps it in a connection so it
+  // can assign the handle and settings.
+  using ConnectionCallback = std::function<void(
+      winrt::Windows::Networking::Sockets::StreamSocket socket, const std::string& device_address)>;
 
+  // workers runs the blocking WinRT calls made while starting to listen.
   BluetoothServer(
       const std::string& service_name,
+      WorkerPool* workers,
       EventStreamHandler<flutter::EncodableValue>* connection_handler,
-      EventStreamHandler<flutter::EncodableValue>* data_handler,
       ConnectionCallback on_connection);
 
   ~BluetoothServer();
 
-  // Start listening for incoming connections
-  void StartListening();
+  // Start listening for incoming connections. The task finishes once the
+  // service is advertised; the caller keeps the server alive until then.
+  Task<void> StartListeningAsync();
 
-  // Stop listening
+  // Stop listening. A start still in progress is cancelled and fails.
   void StopListening();
 
   // Check if server is running
@@ -42,10 +71,16 @@ public:
 
 private:
   // Initialize RFCOMM service provider
-  void InitializeServiceProvider();
+  Task<void> InitializeServiceProviderAsync(CancellationToken cancel);
+
+  // Unregister, close and stop advertising whatever has been set up
+  void ReleaseListener();
 
   // Service information
   std::string service_name_;
+
+  // Shared executor (not owned)
+  WorkerPool* workers_;
   
   // RFCOMM service provider
   winrt::Windows::Devices::Bluetooth::Rfcomm::RfcommServiceProvider service_provider_{nullptr};
@@ -56,10 +91,10 @@ private:
 
   // State
   std::atomic<bool> is_listening_{false};
+  CancellationSource start_cancel_;
 
   // Event handlers (not owned)
   EventStreamHandler<flutter::EncodableValue>* connection_handler_;
-  EventStreamHandler<flutter::EncodableValue>* data_handler_;
 
   // Callback for new connections
   ConnectionCallback on_connection_;
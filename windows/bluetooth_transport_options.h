@@ -0,0 +1,151 @@
+#ifndef FLUTTER_PLUGIN_BLUETOOTH_TRANSPORT_OPTIONS_H_
+#define FLUTTER_PLUGIN_BLUETOOTH_TRANSPORT_OPTIONS_H_
+
+#include <flutter/encodable_value.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+
+// How received bytes are carried in data channel events.
+enum class DataEventFormat {
+  // A single std::vector<uint8_t> (Uint8List in Dart).
+  kBytes,
+  // One boxed int per byte (List<int> in Dart). Kept for older listeners.
+  kIntList,
+};
+
+inline bool ParseDataEventFormat(const std::string& value, DataEventFormat* format) {
+  if (value == "bytes") {
+    *format = DataEventFormat::kBytes;
+    return true;
+  }
+  if (value == "list") {
+    *format = DataEventFormat::kIntList;
+    return true;
+  }
+  return false;
+}
+
+// Upper bound accepted for sendQueueMaxBytes, so one connection cannot ask
+// for an arbitrarily large queue.
+constexpr size_t kMaxSendQueueBytes = 16 * 1024 * 1024;
+
+// Per-connection settings handed to the COM and WinRT transports.
+struct TransportOptions {
+  DataEventFormat data_event_format = DataEventFormat::kBytes;
+
+  // COM write coalescing. When write_coalesce_max_bytes is non-zero the
+  // writer merges queued payloads into one WriteFile of at most that many
+  // bytes, waiting up to write_coalesce_latency_us for more to arrive.
+  size_t write_coalesce_max_bytes = 0;
+  uint32_t write_coalesce_latency_us = 0;
+
+  // Byte budget of the outbound queue. Writes that would push the queue past
+  // send_queue_max_bytes (at most kMaxSendQueueBytes) are rejected;
+  // crossing the high watermark emits a "backpressure" event and draining
+  // to the low watermark a "writable" one.
+  size_t send_queue_max_bytes = 1024 * 1024;
+  size_t send_queue_high_watermark_bytes = 256 * 1024;
+  size_t send_queue_low_watermark_bytes = 64 * 1024;
+
+  bool operator==(const TransportOptions&) const = default;
+};
+
+namespace internal {
+
+inline bool ReadNonNegativeInt(const flutter::EncodableValue& value, int64_t* out) {
+  if (const auto* v32 = std::get_if<int32_t>(&value)) {
+    *out = *v32;
+  } else if (const auto* v64 = std::get_if<int64_t>(&value)) {
+    *out = *v64;
+  } else {
+    return false;
+  }
+  return *out >= 0;
+}
+
+}  // namespace internal
+
+// Overrides fields of *options with whatever keys are present in args.
+// Unknown keys are ignored so the same map can carry unrelated settings.
+inline bool ApplyTransportOptions(
+    const flutter::EncodableMap& args, TransportOptions* options, std::string* error_message) {
+  auto format_it = args.find(flutter::EncodableValue("dataEventFormat"));
+  if (format_it != args.end()) {
+    const auto* format = std::get_if<std::string>(&format_it->second);
+    if (!format || !ParseDataEventFormat(*format, &options->data_event_format)) {
+      *error_message = "dataEventFormat must be 'bytes' or 'list'";
+      return false;
+    }
+  }
+
+  int64_t value = 0;
+  auto max_bytes_it = args.find(flutter::EncodableValue("coalesceMaxBytes"));
+  if (max_bytes_it != args.end()) {
+    if (!internal::ReadNonNegativeInt(max_bytes_it->second, &value)) {
+      *error_message = "coalesceMaxBytes must be a non-negative integer";
+      return false;
+    }
+    options->write_coalesce_max_bytes = static_cast<size_t>(value);
+  }
+
+  auto latency_it = args.find(flutter::EncodableValue("coalesceLatencyUs"));
+  if (latency_it != args.end()) {
+    if (!internal::ReadNonNegativeInt(latency_it->second, &value) || value > UINT32_MAX) {
+      *error_message = "coalesceLatencyUs must be a non-negative integer";
+      return false;
+    }
+    options->write_coalesce_latency_us = static_cast<uint32_t>(value);
+  }
+
+  const std::pair<const char*, size_t*> byte_limits[] = {
+      {"sendQueueMaxBytes", &options->send_queue_max_bytes},
+      {"highWatermarkBytes", &options->send_queue_high_watermark_bytes},
+      {"lowWatermarkBytes", &options->send_queue_low_watermark_bytes},
+  };
+  for (const auto& limit : byte_limits) {
+    auto limit_it = args.find(flutter::EncodableValue(limit.first));
+    if (limit_it == args.end()) {
+      continue;
+    }
+    if (!internal::ReadNonNegativeInt(limit_it->second, &value)) {
+      *error_message = std::string(limit.first) + " must be a non-negative integer";
+      return false;
+    }
+    *limit.second = static_cast<size_t>(value);
+  }
+  if (options->send_queue_max_bytes > kMaxSendQueueBytes) {
+    *error_message = "sendQueueMaxBytes must be at most " + std::to_string(kMaxSendQueueBytes);
+    return false;
+  }
+  if (options->send_queue_low_watermark_bytes > options->send_queue_high_watermark_bytes ||
+      options->send_queue_high_watermark_bytes > options->send_queue_max_bytes) {
+    *error_message = "Watermarks must satisfy lowWatermarkBytes <= highWatermarkBytes <= sendQueueMaxBytes";
+    return false;
+  }
+
+  return true;
+}
+
+inline flutter::EncodableValue EncodeDataPayload(
+    const std::vector<uint8_t>& data, DataEventFormat format) {
+  if (format == DataEventFormat::kBytes) {
+    return flutter::EncodableValue(data);
+  }
+
+  flutter::EncodableList data_list;
+  data_list.reserve(data.size());
+  for (uint8_t byte : data) {
+    data_list.push_back(flutter::EncodableValue(static_cast<int>(byte)));
+  }
+  return flutter::EncodableValue(std::move(data_list));
+}
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_BLUETOOTH_TRANSPORT_OPTIONS_H_
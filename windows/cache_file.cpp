@@ -0,0 +1,113 @@
+#include "cache_file.h"
+
+#include <windows.h>
+#include <shlobj.h>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+// File name of the host executable without its extension, so two apps
+// using the plugin keep separate caches; empty if it cannot be read.
+std::wstring ExecutableName() {
+  std::wstring module_path(MAX_PATH, L'\0');
+  while (true) {
+    const DWORD length =
+        GetModuleFileNameW(nullptr, module_path.data(), static_cast<DWORD>(module_path.size()));
+    if (length == 0) {
+      return std::wstring();
+    }
+    if (length < module_path.size()) {
+      module_path.resize(length);
+      break;
+    }
+    module_path.resize(module_path.size() * 2);
+  }
+  const size_t separator = module_path.find_last_of(L"\\/");
+  std::wstring name =
+      separator == std::wstring::npos ? module_path : module_path.substr(separator + 1);
+  const size_t extension = name.find_last_of(L'.');
+  if (extension != std::wstring::npos && extension > 0) {
+    name.resize(extension);
+  }
+  return name;
+}
+
+}  // namespace
+
+std::wstring CacheFilePath(const wchar_t* name) {
+  const std::wstring executable = ExecutableName();
+  if (executable.empty()) {
+    return std::wstring();
+  }
+  PWSTR local_app_data = nullptr;
+  std::wstring path;
+  if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &local_app_data))) {
+    path = std::wstring(local_app_data) + L"\\flutter_bluetooth_classic\\" + executable + L"\\" +
+           name;
+  }
+  CoTaskMemFree(local_app_data);
+  return path;
+}
+
+bool ReadCacheFile(const std::wstring& path,
+                   size_t max_size,
+                   const std::function<bool(const uint8_t* data, size_t size)>& parse) {
+  if (path.empty()) {
+    return false;
+  }
+
+  // Mapped rather than read: the file is parsed once, straight from the view
+  bool parsed = false;
+  HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  LARGE_INTEGER size{};
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+      static_cast<ULONGLONG>(size.QuadPart) <= max_size) {
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr) {
+      const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      if (view != nullptr) {
+        parsed = parse(static_cast<const uint8_t*>(view), static_cast<size_t>(size.QuadPart));
+        UnmapViewOfFile(view);
+      }
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+  return parsed;
+}
+
+bool WriteCacheFile(const std::wstring& path, const std::vector<uint8_t>& bytes) {
+  if (path.empty()) {
+    return false;
+  }
+  const size_t separator = path.find_last_of(L'\\');
+  if (separator != std::wstring::npos) {
+    // Creates the per-app folder and its parent as needed
+    SHCreateDirectoryExW(nullptr, path.substr(0, separator).c_str(), nullptr);
+  }
+
+  const std::wstring temp_path = path + L".tmp";
+  HANDLE file = CreateFileW(temp_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  DWORD written = 0;
+  // Flushed before the rename: otherwise a power loss can leave the new
+  // name pointing at data that never reached the disk.
+  const bool ok = WriteFile(file, bytes.data(), static_cast<DWORD>(bytes.size()), &written, nullptr) &&
+                  written == bytes.size() && FlushFileBuffers(file);
+  CloseHandle(file);
+  if (!ok || !MoveFileExW(temp_path.c_str(), path.c_str(),
+                          MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    DeleteFileW(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace flutter_bluetooth_classic
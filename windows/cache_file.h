@@ -0,0 +1,30 @@
+#ifndef FLUTTER_PLUGIN_CACHE_FILE_H_
+#define FLUTTER_PLUGIN_CACHE_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+
+// %LOCALAPPDATA%\flutter_bluetooth_classic\<executable>\<name>, where
+// <executable> is the host app's file name without extension; empty (no
+// cache) if either cannot be resolved.
+std::wstring CacheFilePath(const wchar_t* name);
+
+// Maps path read-only and hands its bytes to parse, which must not keep
+// them. False if the file is missing, empty or larger than max_size, or if
+// parse rejects it.
+bool ReadCacheFile(const std::wstring& path,
+                   size_t max_size,
+                   const std::function<bool(const uint8_t* data, size_t size)>& parse);
+
+// Writes bytes aside and swaps them in, so a crash never leaves a torn
+// file. Creates the cache folder if needed.
+bool WriteCacheFile(const std::wstring& path, const std::vector<uint8_t>& bytes);
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_CACHE_FILE_H_
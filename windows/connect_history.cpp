@@ -0,0 +1,127 @@
+#include "connect_history.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+int64_t ToMillis(ConnectHistory::Clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+// A path that has worked and has not failed since
+bool IsProven(const ConnectHistory::PathStats& stats) {
+  return stats.successes > 0 && stats.recent_failures == 0;
+}
+
+}  // namespace
+
+ConnectHistory::ConnectHistory(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+ConnectHistory::Plan ConnectHistory::PlanFor(BdAddr address, Clock::time_point now) const {
+  Plan plan;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(address);
+  if (it == entries_.end()) {
+    return plan;
+  }
+  const PathStats& com = it->second.paths[static_cast<int>(Path::kCom)];
+  const PathStats& winrt = it->second.paths[static_cast<int>(Path::kWinRt)];
+
+  if (IsProven(com) != IsProven(winrt)) {
+    plan.first = IsProven(winrt) ? Path::kWinRt : Path::kCom;
+  } else if (IsProven(com) && winrt.latency_ms < com.latency_ms) {
+    plan.first = Path::kWinRt;
+  }
+
+  // Skipping both would leave nothing to try
+  const bool com_off = IsBackingOff(com, now);
+  const bool winrt_off = IsBackingOff(winrt, now);
+  if (com_off != winrt_off) {
+    plan.first = com_off ? Path::kWinRt : Path::kCom;
+    plan.race = false;
+  }
+  return plan;
+}
+
+void ConnectHistory::RecordSuccess(BdAddr address, Path path, std::chrono::milliseconds latency,
+                                   Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PathStats& stats = TouchLocked(address).paths[static_cast<int>(path)];
+  const uint32_t sample = static_cast<uint32_t>(
+      std::clamp<int64_t>(latency.count(), 0, static_cast<int64_t>(UINT32_MAX)));
+  // Weighted towards history so one slow connect does not flip the order
+  stats.latency_ms = stats.successes == 0
+                         ? sample
+                         : static_cast<uint32_t>((uint64_t{stats.latency_ms} * 3 + sample) / 4);
+  ++stats.successes;
+  stats.recent_failures = 0;
+  stats.last_success_ms = ToMillis(now);
+}
+
+void ConnectHistory::RecordFailure(BdAddr address, Path path, Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  PathStats& stats = TouchLocked(address).paths[static_cast<int>(path)];
+  ++stats.failures;
+  ++stats.recent_failures;
+  stats.last_failure_ms = ToMillis(now);
+}
+
+bool ConnectHistory::IsBackingOff(const PathStats& stats, Clock::time_point now) {
+  if (stats.recent_failures == 0) {
+    return false;
+  }
+  std::chrono::milliseconds backoff = kFailureBackoff;
+  for (uint32_t i = 1; i < stats.recent_failures && backoff < kMaxFailureBackoff; ++i) {
+    backoff *= 2;
+  }
+  backoff = std::min<std::chrono::milliseconds>(backoff, kMaxFailureBackoff);
+  const int64_t since_failure = ToMillis(now) - stats.last_failure_ms;
+  // A failure "in the future" means the clock was set back; trust it no longer
+  return since_failure >= 0 && since_failure < backoff.count();
+}
+
+std::vector<ConnectHistory::Record> ConnectHistory::Records() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Record> records;
+  records.reserve(entries_.size());
+  for (const BdAddr& address : lru_) {
+    const Entry& entry = entries_.at(address);
+    records.push_back(Record{address, {entry.paths[0], entry.paths[1]}});
+  }
+  return records;
+}
+
+void ConnectHistory::Restore(const std::vector<Record>& records) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  lru_.clear();
+  entries_.clear();
+  for (const Record& record : records) {
+    if (entries_.size() >= capacity_) {
+      break;
+    }
+    if (entries_.count(record.address) > 0) {
+      continue;
+    }
+    lru_.push_back(record.address);
+    entries_.emplace(record.address,
+                     Entry{{record.paths[0], record.paths[1]}, std::prev(lru_.end())});
+  }
+}
+
+ConnectHistory::Entry& ConnectHistory::TouchLocked(BdAddr address) {
+  auto it = entries_.find(address);
+  if (it != entries_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second;
+  }
+  while (entries_.size() >= capacity_ && !lru_.empty()) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(address);
+  return entries_.emplace(address, Entry{{}, lru_.begin()}).first->second;
+}
+
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,90 @@
+#ifndef FLUTTER_PLUGIN_CONNECT_HISTORY_H_
+#define FLUTTER_PLUGIN_CONNECT_HISTORY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "bluetooth_address.h"
+
+namespace flutter_bluetooth_classic {
+
+// What worked the last times each device was connected, per path (COM or
+// WinRT), so the next connect can lead with the better path and leave out
+// one that keeps failing. Times are wall-clock so the history can be saved
+// and still mean something after a restart. Thread-safe.
+class ConnectHistory {
+ public:
+  using Clock = std::chrono::system_clock;
+
+  enum class Path { kCom = 0, kWinRt = 1 };
+
+  struct PathStats {
+    uint32_t successes = 0;
+    uint32_t failures = 0;
+    // Failures since the last success; drives the negative cache
+    uint32_t recent_failures = 0;
+    // Smoothed latency of successful connects
+    uint32_t latency_ms = 0;
+    int64_t last_success_ms = 0;
+    int64_t last_failure_ms = 0;
+  };
+
+  struct Record {
+    BdAddr address;
+    PathStats paths[2];
+  };
+
+  // With race set both paths are tried together, first leading. Otherwise
+  // the other path failed recently and is only tried once first has
+  // failed too.
+  struct Plan {
+    Path first = Path::kCom;
+    bool race = true;
+  };
+
+  // A path that just failed is skipped for kFailureBackoff, doubling with
+  // every further failure up to kMaxFailureBackoff.
+  static constexpr std::chrono::seconds kFailureBackoff{30};
+  static constexpr std::chrono::minutes kMaxFailureBackoff{10};
+
+  // Keeps the capacity most recently connected devices.
+  explicit ConnectHistory(size_t capacity);
+
+  // Without history: COM first, raced with WinRT (the default order).
+  Plan PlanFor(BdAddr address, Clock::time_point now) const;
+
+  void RecordSuccess(BdAddr address, Path path, std::chrono::milliseconds latency,
+                     Clock::time_point now);
+  void RecordFailure(BdAddr address, Path path, Clock::time_point now);
+
+  // Whether stats keep path out of a race at now.
+  static bool IsBackingOff(const PathStats& stats, Clock::time_point now);
+
+  // Most recently used first.
+  std::vector<Record> Records() const;
+  // Replaces the history, e.g. with what was saved; records past capacity
+  // are dropped from the end.
+  void Restore(const std::vector<Record>& records);
+
+ private:
+  struct Entry {
+    PathStats paths[2];
+    std::list<BdAddr>::iterator lru;
+  };
+
+  Entry& TouchLocked(BdAddr address);
+
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  std::list<BdAddr> lru_;
+  std::unordered_map<BdAddr, Entry, BdAddrHash> entries_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_CONNECT_HISTORY_H_
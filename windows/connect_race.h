@@ -0,0 +1,242 @@
+#ifndef FLUTTER_PLUGIN_CONNECT_RACE_H_
+#define FLUTTER_PLUGIN_CONNECT_RACE_H_
+
+#include <coroutine>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "async_task.h"
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+
+// Outcome of RaceStaggered. winner is the leg (0 or 1) that succeeded
+// first; -1 if neither did, in which case legs holds both failures. A leg
+// that threw has no result.
+template <typename T>
+struct RaceResult {
+  int winner = -1;
+  std::optional<T> legs[2];
+};
+
+namespace internal {
+
+template <typename T>
+struct RaceState {
+  std::function<Task<T>(CancellationToken)> legs[2];
+  std::function<bool(const T&)> succeeded;
+  std::function<void(T)> discard;
+  WorkerPool* workers = nullptr;
+  CancellationSource cancels[2];
+
+  std::mutex mutex;
+  bool started[2] = {false, false};
+  bool finished[2] = {false, false};
+  bool decided = false;
+  RaceResult<T> result;
+  std::coroutine_handle<> waiter;
+};
+
+template <typename T>
+void FinishRaceLeg(const std::shared_ptr<RaceState<T>>& state, int leg, std::future<T> finished);
+
+// Starts leg on a worker unless it already started or the race is over.
+template <typename T>
+void StartRaceLeg(const std::shared_ptr<RaceState<T>>& state, int leg) {
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->started[leg] || state->decided) {
+      return;
+    }
+    state->started[leg] = true;
+  }
+  // A leg may block before its first suspension; keep that off the caller
+  const bool posted = state->workers->Post([state, leg]() {
+    Spawn(state->legs[leg](state->cancels[leg].token()),
+          [state, leg](std::future<T> finished) {
+            FinishRaceLeg(state, leg, std::move(finished));
+          });
+  });
+  if (!posted) {
+    // The pool is shutting down: the leg fails without running
+    std::promise<T> rejected;
+    rejected.set_exception(std::make_exception_ptr(OperationCancelled("SHUTDOWN")));
+    FinishRaceLeg(state, leg, rejected.get_future());
+  }
+}
+
+template <typename T>
+void FinishRaceLeg(const std::shared_ptr<RaceState<T>>& state, int leg, std::future<T> finished) {
+  std::optional<T> value;
+  try {
+    value.emplace(finished.get());
+  } catch (...) {
+  }
+  const bool won = value.has_value() && state->succeeded(*value);
+  const int other = 1 - leg;
+
+  std::optional<T> loser;
+  bool cancel_other = false;
+  bool start_other = false;
+  std::coroutine_handle<> resume;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->finished[leg] = true;
+    if (state->decided) {
+      if (won) {
+        loser = std::move(value);
+      }
+    } else if (won) {
+      state->decided = true;
+      state->result.winner = leg;
+      state->result.legs[leg] = std::move(value);
+      cancel_other = state->started[other] && !state->finished[other];
+      resume = std::exchange(state->waiter, {});
+    } else {
+      state->result.legs[leg] = std::move(value);
+      if (!state->started[other]) {
+        // Failed before the stagger ran out: no point waiting for it
+        start_other = true;
+      } else if (state->finished[other]) {
+        state->decided = true;
+        resume = std::exchange(state->waiter, {});
+      }
+    }
+  }
+
+  if (cancel_other) {
+    state->cancels[other].Cancel("LOST_RACE");
+  }
+  if (loser) {
+    state->discard(std::move(*loser));
+  }
+  if (start_other) {
+    StartRaceLeg(state, other);
+  }
+  if (resume) {
+    resume.resume();
+  }
+}
+
+// Outer cancel: ends the race without waiting for a leg that cannot be
+// interrupted (a blocking port open); should it still succeed, its result
+// goes to discard like any late winner.
+template <typename T>
+void AbandonRace(const std::shared_ptr<RaceState<T>>& state) {
+  std::coroutine_handle<> resume;
+  {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->decided) {
+      return;
+    }
+    state->decided = true;
+    resume = std::exchange(state->waiter, {});
+  }
+  if (resume) {
+    // Not on the cancelling thread, which may be the platform thread,
+    // unless the pool is shutting down and nothing else can
+    if (!state->workers->Post([resume]() { resume.resume(); })) {
+      resume.resume();
+    }
+  }
+}
+
+}  // namespace internal
+
+// Runs two attempts at the same thing: first at once, second after stagger
+// or as soon as first fails, whichever comes sooner.
+//
+// The first result that satisfies succeeded wins and the other leg is
+// cancelled ("LOST_RACE"); should that leg succeed anyway, its result is
+// handed to discard so it can be torn down. Legs report failure through
+// their result. Cancelling cancel cancels both legs with the same reason
+// and completes the race at once with whatever has finished by then.
+template <typename T>
+Task<RaceResult<T>> RaceStaggered(
+    std::function<Task<T>(CancellationToken)> first,
+    std::function<Task<T>(CancellationToken)> second,
+    WorkerPool::Clock::duration stagger,
+    WorkerPool* workers,
+    CancellationToken cancel,
+    std::function<bool(const T&)> succeeded,
+    std::function<void(T)> discard) {
+  auto state = std::make_shared<internal::RaceState<T>>();
+  state->legs[0] = std::move(first);
+  state->legs[1] = std::move(second);
+  state->succeeded = std::move(succeeded);
+  state->discard = std::move(discard);
+  state->workers = workers;
+
+  CancellationRegistration forward = cancel.OnCancel([state, cancel]() {
+    const std::string reason = cancel.reason();
+    state->cancels[0].Cancel(reason);
+    state->cancels[1].Cancel(reason);
+    internal::AbandonRace(state);
+  });
+
+  internal::StartRaceLeg(state, 0);
+  std::weak_ptr<internal::RaceState<T>> weak_state = state;
+  workers->PostAfter(stagger, [weak_state]() {
+    if (auto state = weak_state.lock()) {
+      internal::StartRaceLeg(state, 1);
+    }
+  });
+
+  struct Decided {
+    std::shared_ptr<internal::RaceState<T>> state;
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) const {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->decided) {
+        return false;
+      }
+      state->waiter = handle;
+      return true;
+    }
+    void await_resume() const noexcept {}
+  };
+  Decided decided{state};
+  co_await decided;
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  co_return std::move(state->result);
+}
+
+// Runs first, then second only if first did not succeed and cancel has not
+// fired. Same result shape as RaceStaggered; a leg that threw has no result.
+template <typename T>
+Task<RaceResult<T>> FallBack(
+    std::function<Task<T>(CancellationToken)> first,
+    std::function<Task<T>(CancellationToken)> second,
+    CancellationToken cancel,
+    std::function<bool(const T&)> succeeded) {
+  RaceResult<T> result;
+  try {
+    result.legs[0].emplace(co_await first(cancel));
+  } catch (...) {
+  }
+  if (result.legs[0] && succeeded(*result.legs[0])) {
+    result.winner = 0;
+    co_return result;
+  }
+  if (cancel.IsCancelled()) {
+    co_return result;
+  }
+  try {
+    result.legs[1].emplace(co_await second(cancel));
+  } catch (...) {
+  }
+  if (result.legs[1] && succeeded(*result.legs[1])) {
+    result.winner = 1;
+  }
+  co_return result;
+}
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_CONNECT_RACE_H_
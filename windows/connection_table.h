@@ -0,0 +1,161 @@
+#ifndef FLUTTER_PLUGIN_CONNECTION_TABLE_H_
+#define FLUTTER_PLUGIN_CONNECTION_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+
+// Open links keyed by handle, at most max_connections of them counting
+// connects still in flight. Handles are never reused; 0 means "no handle".
+// One link may be the legacy one that handle-less calls address.
+//
+// Entry is copyable and has bool IsConnected() const. Not thread-safe; the
+// owner calls it under its connection lock and closes taken entries
+// outside of it.
+template <typename Entry>
+class ConnectionTable {
+ public:
+  explicit ConnectionTable(size_t max_connections) : max_connections_(max_connections) {}
+
+  // Lowering the limit does not close existing links; it only blocks new
+  // ones until enough have gone away.
+  void set_max_connections(size_t max_connections) { max_connections_ = max_connections; }
+  size_t max_connections() const { return max_connections_; }
+
+  // Reserves a slot for a connect and hands out its handle. Links that
+  // dropped on their own are pruned first. False when the table is full.
+  bool Reserve(int64_t* connection_id) {
+    PruneClosed();
+    if (Full()) {
+      return false;
+    }
+    ++pending_;
+    *connection_id = next_connection_id_++;
+    return true;
+  }
+
+  // Releases a reservation; a non-null entry is added under its handle.
+  void Commit(int64_t connection_id, const Entry* entry, bool legacy) {
+    --pending_;
+    if (entry == nullptr) {
+      return;
+    }
+    entries_[connection_id] = *entry;
+    if (legacy) {
+      legacy_connection_id_ = connection_id;
+    }
+  }
+
+  // Links that dropped on their own (remote close, read error) keep their
+  // row until the next reservation so late sendData calls still get a
+  // NOT_CONNECTED rather than an unknown-handle answer.
+  void PruneClosed() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->second.IsConnected()) {
+        ++it;
+        continue;
+      }
+      if (legacy_connection_id_ == it->first) {
+        legacy_connection_id_ = 0;
+      }
+      it = entries_.erase(it);
+    }
+  }
+
+  bool Full() const { return entries_.size() + pending_ >= max_connections_; }
+
+  // The link with that handle. Handle-less callers (0) get the legacy link,
+  // or else the most recently opened one that is still up.
+  bool Find(int64_t connection_id, Entry* entry) const {
+    if (connection_id != 0) {
+      auto it = entries_.find(connection_id);
+      if (it == entries_.end()) {
+        return false;
+      }
+      *entry = it->second;
+      return true;
+    }
+    auto legacy = entries_.find(legacy_connection_id_);
+    if (legacy != entries_.end()) {
+      *entry = legacy->second;
+      return true;
+    }
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+      if (it->second.IsConnected()) {
+        *entry = it->second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Removes the link with that handle; an empty entry if there is none.
+  Entry Take(int64_t connection_id) {
+    Entry entry;
+    auto it = entries_.find(connection_id);
+    if (it != entries_.end()) {
+      entry = std::move(it->second);
+      entries_.erase(it);
+    }
+    if (legacy_connection_id_ == connection_id) {
+      legacy_connection_id_ = 0;
+    }
+    return entry;
+  }
+
+  Entry TakeLegacy() { return Take(legacy_connection_id_); }
+
+  // Removes the oldest link matching pred. Handles grow monotonically, so
+  // that is the first match in handle order.
+  template <typename Pred>
+  Entry TakeOldest(Pred pred) {
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (pred(it->second)) {
+        return Take(it->first);
+      }
+    }
+    return Entry();
+  }
+
+  template <typename Pred>
+  size_t Count(Pred pred) const {
+    size_t count = 0;
+    for (const auto& entry : entries_) {
+      if (pred(entry.second)) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  std::vector<Entry> TakeAll() {
+    std::vector<Entry> all;
+    all.reserve(entries_.size());
+    for (auto& entry : entries_) {
+      all.push_back(std::move(entry.second));
+    }
+    entries_.clear();
+    legacy_connection_id_ = 0;
+    return all;
+  }
+
+  const std::map<int64_t, Entry>& entries() const { return entries_; }
+  size_t pending() const { return pending_; }
+
+ private:
+  std::map<int64_t, Entry> entries_;
+  int64_t next_connection_id_ = 1;
+  int64_t legacy_connection_id_ = 0;
+  // Reserved slots whose connect is still in flight, so concurrent opens
+  // cannot overshoot max_connections_
+  size_t pending_ = 0;
+  size_t max_connections_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_CONNECTION_TABLE_H_
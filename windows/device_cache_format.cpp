@@ -0,0 +1,249 @@
+#include "device_cache_format.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+constexpr uint8_t kMagic[4] = {'F', 'B', 'C', 'D'};
+constexpr uint8_t kHistoryMagic[4] = {'F', 'B', 'C', 'H'};
+constexpr size_t kHeaderSize = 4 + 2 + 2 + 4 + 4 + 4;
+// Everything in the header up to the CRC field
+constexpr size_t kCheckedHeaderSize = kHeaderSize - 4;
+constexpr uint8_t kFlagPaired = 0x01;
+constexpr uint8_t kFlagRemembered = 0x02;
+// Flags byte plus six empty strings
+constexpr size_t kMinRecordSize = 1 + 6 * 2;
+// Address plus two paths of four u32 and two u64
+constexpr size_t kHistoryRecordSize = 8 + 2 * (4 * 4 + 2 * 8);
+
+// Continues crc (0 to start) over data.
+uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t size) {
+  static const std::array<uint32_t, 256> table = []() {
+    std::array<uint32_t, 256> entries{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      entries[i] = c;
+    }
+    return entries;
+  }();
+
+  crc ^= 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+void PutU16(std::vector<uint8_t>* out, uint16_t value) {
+  out->push_back(static_cast<uint8_t>(value));
+  out->push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void PutU32(std::vector<uint8_t>* out, uint32_t value) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out->push_back(static_cast<uint8_t>(value >> shift));
+  }
+}
+
+void PutString(std::vector<uint8_t>* out, const std::string& value) {
+  // Longer fields are cut rather than failing the whole file
+  const size_t length = value.size() < 0xFFFF ? value.size() : 0xFFFF;
+  PutU16(out, static_cast<uint16_t>(length));
+  out->insert(out->end(), value.begin(), value.begin() + length);
+}
+
+void PutU64(std::vector<uint8_t>* out, uint64_t value) {
+  PutU32(out, static_cast<uint32_t>(value));
+  PutU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+uint16_t GetU16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t GetU64(const uint8_t* p) {
+  return static_cast<uint64_t>(GetU32(p)) | (static_cast<uint64_t>(GetU32(p + 4)) << 32);
+}
+
+std::vector<uint8_t> WithHeader(const uint8_t (&magic)[4], uint16_t version, size_t count,
+                                const std::vector<uint8_t>& payload) {
+  std::vector<uint8_t> out;
+  out.reserve(kHeaderSize + payload.size());
+  out.insert(out.end(), magic, magic + 4);
+  PutU16(&out, version);
+  PutU16(&out, 0);
+  PutU32(&out, static_cast<uint32_t>(count));
+  PutU32(&out, static_cast<uint32_t>(payload.size()));
+  PutU32(&out, Crc32(Crc32(0, out.data(), kCheckedHeaderSize), payload.data(), payload.size()));
+  out.insert(out.end(), payload.begin(), payload.end());
+  return out;
+}
+
+// Checks magic, version, the reserved field, size and the checksum, which
+// covers the header fields as well as the payload. On success *payload and
+// *payload_size cover the records and *count is the stored record count.
+bool CheckHeader(const uint8_t* data, size_t size, const uint8_t (&magic)[4], uint16_t version,
+                 const uint8_t** payload, uint32_t* payload_size, uint32_t* count) {
+  if (data == nullptr || size < kHeaderSize || std::memcmp(data, magic, 4) != 0 ||
+      GetU16(data + 4) != version || GetU16(data + 6) != 0) {
+    return false;
+  }
+  *count = GetU32(data + 8);
+  *payload_size = GetU32(data + 12);
+  *payload = data + kHeaderSize;
+  return *payload_size == size - kHeaderSize &&
+         Crc32(Crc32(0, data, kCheckedHeaderSize), *payload, *payload_size) ==
+             GetU32(data + kCheckedHeaderSize);
+}
+
+// Bounds-checked cursor over the payload
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  bool ReadByte(uint8_t* value) {
+    if (size_ - offset_ < 1) {
+      return false;
+    }
+    *value = data_[offset_++];
+    return true;
+  }
+
+  bool ReadString(std::string* value) {
+    if (size_ - offset_ < 2) {
+      return false;
+    }
+    const uint16_t length = GetU16(data_ + offset_);
+    offset_ += 2;
+    if (size_ - offset_ < length) {
+      return false;
+    }
+    value->assign(reinterpret_cast<const char*>(data_ + offset_), length);
+    offset_ += length;
+    return true;
+  }
+
+  bool AtEnd() const { return offset_ == size_; }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+}  // namespace
+
+std::vector<uint8_t> EncodeDeviceCache(const std::vector<ClassicDeviceInfo>& devices) {
+  std::vector<uint8_t> payload;
+  for (const auto& device : devices) {
+    uint8_t flags = 0;
+    if (device.paired) {
+      flags |= kFlagPaired;
+    }
+    if (device.remembered) {
+      flags |= kFlagRemembered;
+    }
+    payload.push_back(flags);
+    PutString(&payload, device.name);
+    PutString(&payload, device.address);
+    PutString(&payload, device.com_port);
+    PutString(&payload, device.device_id);
+    PutString(&payload, device.source);
+    PutString(&payload, device.connect_key);
+  }
+
+  return WithHeader(kMagic, kDeviceCacheVersion, devices.size(), payload);
+}
+
+bool DecodeDeviceCache(const uint8_t* data, size_t size, std::vector<ClassicDeviceInfo>* devices) {
+  const uint8_t* payload = nullptr;
+  uint32_t payload_size = 0;
+  uint32_t count = 0;
+  if (!CheckHeader(data, size, kMagic, kDeviceCacheVersion, &payload, &payload_size, &count) ||
+      count > payload_size / kMinRecordSize) {
+    return false;
+  }
+
+  std::vector<ClassicDeviceInfo> decoded;
+  decoded.reserve(count);
+  Reader reader(payload, payload_size);
+  for (uint32_t i = 0; i < count; ++i) {
+    ClassicDeviceInfo device;
+    uint8_t flags = 0;
+    if (!reader.ReadByte(&flags) || !reader.ReadString(&device.name) ||
+        !reader.ReadString(&device.address) || !reader.ReadString(&device.com_port) ||
+        !reader.ReadString(&device.device_id) || !reader.ReadString(&device.source) ||
+        !reader.ReadString(&device.connect_key)) {
+      return false;
+    }
+    device.paired = (flags & kFlagPaired) != 0;
+    device.remembered = (flags & kFlagRemembered) != 0;
+    decoded.push_back(std::move(device));
+  }
+  if (!reader.AtEnd()) {
+    return false;
+  }
+
+  devices->swap(decoded);
+  return true;
+}
+
+std::vector<uint8_t> EncodeConnectHistory(const std::vector<ConnectHistory::Record>& records) {
+  std::vector<uint8_t> payload;
+  payload.reserve(records.size() * kHistoryRecordSize);
+  for (const auto& record : records) {
+    PutU64(&payload, record.address.value());
+    for (const auto& path : record.paths) {
+      PutU32(&payload, path.successes);
+      PutU32(&payload, path.failures);
+      PutU32(&payload, path.recent_failures);
+      PutU32(&payload, path.latency_ms);
+      PutU64(&payload, static_cast<uint64_t>(path.last_success_ms));
+      PutU64(&payload, static_cast<uint64_t>(path.last_failure_ms));
+    }
+  }
+  return WithHeader(kHistoryMagic, kConnectHistoryVersion, records.size(), payload);
+}
+
+bool DecodeConnectHistory(const uint8_t* data, size_t size,
+                          std::vector<ConnectHistory::Record>* records) {
+  const uint8_t* payload = nullptr;
+  uint32_t payload_size = 0;
+  uint32_t count = 0;
+  if (!CheckHeader(data, size, kHistoryMagic, kConnectHistoryVersion, &payload, &payload_size,
+                   &count) ||
+      static_cast<uint64_t>(count) * kHistoryRecordSize != payload_size) {
+    return false;
+  }
+
+  std::vector<ConnectHistory::Record> decoded(count);
+  const uint8_t* p = payload;
+  for (auto& record : decoded) {
+    record.address = BdAddr(GetU64(p));
+    p += 8;
+    for (auto& path : record.paths) {
+      path.successes = GetU32(p);
+      path.failures = GetU32(p + 4);
+      path.recent_failures = GetU32(p + 8);
+      path.latency_ms = GetU32(p + 12);
+      path.last_success_ms = static_cast<int64_t>(GetU64(p + 16));
+      path.last_failure_ms = static_cast<int64_t>(GetU64(p + 24));
+      p += 32;
+    }
+  }
+  records->swap(decoded);
+  return true;
+}
+
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,46 @@
+#ifndef FLUTTER_PLUGIN_DEVICE_CACHE_FORMAT_H_
+#define FLUTTER_PLUGIN_DEVICE_CACHE_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bluetooth_device_model.h"
+#include "connect_history.h"
+
+namespace flutter_bluetooth_classic {
+
+// On-disk form of the paired-device list, read at startup so the first
+// connect does not wait for enumeration.
+//
+// Little-endian: "FBCD", u16 version, u16 reserved (0), u32 device count,
+// u32 payload size, u32 CRC-32 of the preceding header bytes and the
+// payload; then per device a flags byte
+// (paired, remembered) and six u16-length-prefixed strings (name, address,
+// com_port, device_id, source, connect_key). No Win32 here so the codec
+// builds anywhere.
+constexpr uint16_t kDeviceCacheVersion = 2;
+
+std::vector<uint8_t> EncodeDeviceCache(const std::vector<ClassicDeviceInfo>& devices);
+
+// False (and devices untouched) for anything that is not an intact file of
+// this version: wrong magic or version, a nonzero reserved field,
+// truncation, checksum mismatch or a record running past the payload.
+bool DecodeDeviceCache(const uint8_t* data, size_t size, std::vector<ClassicDeviceInfo>* devices);
+
+// Connect history saved next to the device cache. Same header with magic
+// "FBCH"; then per device a u64 address and, for COM and WinRT, u32
+// successes, failures, recent failures and latency in ms and u64 last
+// success and failure times (ms since the Unix epoch).
+constexpr uint16_t kConnectHistoryVersion = 2;
+
+std::vector<uint8_t> EncodeConnectHistory(const std::vector<ConnectHistory::Record>& records);
+
+// Rejects damaged files the same way DecodeDeviceCache does.
+bool DecodeConnectHistory(const uint8_t* data, size_t size,
+                          std::vector<ConnectHistory::Record>* records);
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_DEVICE_CACHE_FORMAT_H_
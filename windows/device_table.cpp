@@ -0,0 +1,146 @@
+#include "device_table.h"
+
+#include <functional>
+#include <utility>
+
+namespace flutter_bluetooth_classic {
+
+void DeviceTable::Reserve(size_t count) {
+  devices_.reserve(count);
+  by_address_.reserve(count);
+}
+
+void DeviceTable::Clear() {
+  devices_.clear();
+  by_address_.clear();
+  by_com_port_.clear();
+  by_device_id_.clear();
+}
+
+size_t DeviceTable::Upsert(ClassicDeviceInfo device) {
+  const size_t existing = PositionOf(device);
+  if (existing != npos) {
+    Unindex(existing);
+    devices_[existing] = std::move(device);
+    Index(existing);
+    return existing;
+  }
+  devices_.push_back(std::move(device));
+  Index(devices_.size() - 1);
+  return devices_.size() - 1;
+}
+
+bool DeviceTable::EraseAt(size_t position) {
+  if (position >= devices_.size()) {
+    return false;
+  }
+  Unindex(position);
+  const size_t last = devices_.size() - 1;
+  if (position != last) {
+    Unindex(last);
+    devices_[position] = std::move(devices_[last]);
+    devices_.pop_back();
+    Index(position);
+  } else {
+    devices_.pop_back();
+  }
+  return true;
+}
+
+const ClassicDeviceInfo* DeviceTable::FindByAddress(BdAddr address) const {
+  auto it = by_address_.find(address);
+  return it != by_address_.end() ? &devices_[it->second] : nullptr;
+}
+
+const ClassicDeviceInfo* DeviceTable::FindByComPort(const std::string& port) const {
+  auto it = by_com_port_.find(NormalizeComPort(port));
+  return it != by_com_port_.end() ? &devices_[it->second] : nullptr;
+}
+
+const ClassicDeviceInfo* DeviceTable::FindByDeviceId(const std::string& device_id) const {
+  auto range = by_device_id_.equal_range(std::hash<std::string>()(device_id));
+  for (auto it = range.first; it != range.second; ++it) {
+    if (devices_[it->second].device_id == device_id) {
+      return &devices_[it->second];
+    }
+  }
+  return nullptr;
+}
+
+const ClassicDeviceInfo* DeviceTable::Find(const std::string& address_or_port) const {
+  BdAddr address;
+  if (BdAddr::TryParse(address_or_port, &address)) {
+    return FindByAddress(address);
+  }
+  return FindByComPort(address_or_port);
+}
+
+size_t DeviceTable::PositionOf(const ClassicDeviceInfo& device) const {
+  BdAddr address;
+  if (BdAddr::TryParse(device.address, &address)) {
+    auto it = by_address_.find(address);
+    return it != by_address_.end() ? it->second : npos;
+  }
+  if (!device.com_port.empty()) {
+    auto it = by_com_port_.find(NormalizeComPort(device.com_port));
+    // A port shared with an addressed device does not make them the same
+    if (it != by_com_port_.end() && !BdAddr::TryParse(devices_[it->second].address, &address)) {
+      return it->second;
+    }
+  }
+  return npos;
+}
+
+void DeviceTable::Index(size_t position) {
+  const ClassicDeviceInfo& device = devices_[position];
+  const Position slot = static_cast<Position>(position);
+  BdAddr address;
+  if (BdAddr::TryParse(device.address, &address)) {
+    by_address_[address] = slot;
+  }
+  if (!device.com_port.empty()) {
+    by_com_port_[NormalizeComPort(device.com_port)] = slot;
+  }
+  if (!device.device_id.empty()) {
+    // Same id as an earlier device: the later one wins, as for the others
+    auto range = by_device_id_.equal_range(std::hash<std::string>()(device.device_id));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (devices_[it->second].device_id == device.device_id) {
+        by_device_id_.erase(it);
+        break;
+      }
+    }
+    by_device_id_.emplace(std::hash<std::string>()(device.device_id), slot);
+  }
+}
+
+void DeviceTable::Unindex(size_t position) {
+  // Only drop keys that still point here; a later device may have taken
+  // over a shared COM port or device id.
+  const ClassicDeviceInfo& device = devices_[position];
+  const Position slot = static_cast<Position>(position);
+  BdAddr address;
+  if (BdAddr::TryParse(device.address, &address)) {
+    auto it = by_address_.find(address);
+    if (it != by_address_.end() && it->second == slot) {
+      by_address_.erase(it);
+    }
+  }
+  if (!device.com_port.empty()) {
+    auto it = by_com_port_.find(NormalizeComPort(device.com_port));
+    if (it != by_com_port_.end() && it->second == slot) {
+      by_com_port_.erase(it);
+    }
+  }
+  if (!device.device_id.empty()) {
+    auto range = by_device_id_.equal_range(std::hash<std::string>()(device.device_id));
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == slot) {
+        by_device_id_.erase(it);
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace flutter_bluetooth_classic
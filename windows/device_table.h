@@ -0,0 +1,67 @@
+#ifndef FLUTTER_PLUGIN_DEVICE_TABLE_H_
+#define FLUTTER_PLUGIN_DEVICE_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bluetooth_address.h"
+#include "bluetooth_device_model.h"
+
+namespace flutter_bluetooth_classic {
+
+// Devices stored once, contiguously, with secondary indices by address,
+// COM port and WinRT device id that hold positions into that storage.
+//
+// A device is identified by its address, or by its COM port when it has no
+// address; Upsert replaces the entry with the same identity. Erase moves
+// the last entry into the freed slot, so positions are only stable between
+// mutations. Not thread-safe.
+class DeviceTable {
+ public:
+  void Reserve(size_t count);
+  void Clear();
+
+  // Inserts or replaces; returns the device's position.
+  size_t Upsert(ClassicDeviceInfo device);
+
+  // Removes the device at position; false if out of range.
+  bool EraseAt(size_t position);
+
+  const ClassicDeviceInfo* FindByAddress(BdAddr address) const;
+  // port is normalized first ("COM:COM7" and "\\.\COM7" match "COM7")
+  const ClassicDeviceInfo* FindByComPort(const std::string& port) const;
+  const ClassicDeviceInfo* FindByDeviceId(const std::string& device_id) const;
+
+  // Address in any spelling, else COM port name; null if neither is known.
+  const ClassicDeviceInfo* Find(const std::string& address_or_port) const;
+
+  // Position of the entry with the same identity as device, or npos.
+  size_t PositionOf(const ClassicDeviceInfo& device) const;
+
+  const std::vector<ClassicDeviceInfo>& devices() const { return devices_; }
+  size_t size() const { return devices_.size(); }
+  bool empty() const { return devices_.empty(); }
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+ private:
+  // Positions fit in 32 bits and keep the index nodes small
+  using Position = uint32_t;
+
+  void Index(size_t position);
+  void Unindex(size_t position);
+
+  std::vector<ClassicDeviceInfo> devices_;
+  std::unordered_map<BdAddr, Position, BdAddrHash> by_address_;
+  std::unordered_map<std::string, Position> by_com_port_;
+  // Keyed by hash: WinRT ids are long, so the id itself is only kept once,
+  // in the device. Lookups confirm the match against that copy.
+  std::unordered_multimap<size_t, Position> by_device_id_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_DEVICE_TABLE_H_
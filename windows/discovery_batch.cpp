@@ -0,0 +1,45 @@
+#include "discovery_batch.h"
+
+#include <utility>
+
+namespace flutter_bluetooth_classic {
+
+bool DiscoveryBatch::Add(const ClassicDeviceInfo& device) {
+  BdAddr address;
+  if (BdAddr::TryParse(device.address, &address)) {
+    auto it = positions_.find(address);
+    if (it != positions_.end()) {
+      devices_[it->second] = device;
+      return max_devices_ > 0 && devices_.size() >= max_devices_;
+    }
+    positions_.emplace(address, devices_.size());
+  }
+  devices_.push_back(device);
+  return max_devices_ > 0 && devices_.size() >= max_devices_;
+}
+
+bool DiscoveryBatch::Discard(BdAddr address) {
+  auto it = positions_.find(address);
+  if (it == positions_.end()) {
+    return false;
+  }
+  const size_t position = it->second;
+  positions_.erase(it);
+  devices_.erase(devices_.begin() + position);
+  // Keep first-seen order; batches are small, so shifting is cheap
+  for (auto& entry : positions_) {
+    if (entry.second > position) {
+      --entry.second;
+    }
+  }
+  return true;
+}
+
+std::vector<ClassicDeviceInfo> DiscoveryBatch::Take() {
+  std::vector<ClassicDeviceInfo> devices;
+  devices.swap(devices_);
+  positions_.clear();
+  return devices;
+}
+
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,52 @@
+#ifndef FLUTTER_PLUGIN_DISCOVERY_BATCH_H_
+#define FLUTTER_PLUGIN_DISCOVERY_BATCH_H_
+
+#include <chrono>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "bluetooth_address.h"
+#include "bluetooth_device_model.h"
+
+namespace flutter_bluetooth_classic {
+
+// startDiscovery batching; an interval of 0 sends one deviceFound per
+// device as before.
+struct DiscoveryBatchOptions {
+  std::chrono::milliseconds interval{0};
+  // Flush early once this many devices are pending (0: timer only)
+  size_t max_devices = 0;
+};
+
+// Discovery results waiting to be sent as one devicesFound event. A device
+// seen again before the flush replaces its pending entry instead of adding
+// a second one. Not thread-safe.
+class DiscoveryBatch {
+ public:
+  explicit DiscoveryBatch(size_t max_devices = 0) { set_max_devices(max_devices); }
+
+  // 0 means no size limit (flush on the timer only).
+  void set_max_devices(size_t max_devices) { max_devices_ = max_devices; }
+
+  // Adds or replaces device; true once the batch has reached max_devices.
+  bool Add(const ClassicDeviceInfo& device);
+
+  // Drops the pending entry for address; false if there was none.
+  bool Discard(BdAddr address);
+
+  bool Contains(BdAddr address) const { return positions_.count(address) > 0; }
+  bool empty() const { return devices_.empty(); }
+
+  // Pending devices in first-seen order; leaves the batch empty.
+  std::vector<ClassicDeviceInfo> Take();
+
+ private:
+  size_t max_devices_ = 0;
+  std::vector<ClassicDeviceInfo> devices_;
+  std::unordered_map<BdAddr, size_t, BdAddrHash> positions_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_DISCOVERY_BATCH_H_
@@ -0,0 +1,125 @@
+#include "discovery_cache.h"
+
+#include <utility>
+
+namespace flutter_bluetooth_classic {
+
+DiscoveryCache::DiscoveryCache(size_t capacity, Clock::duration max_age)
+    : capacity_(capacity > 0 ? capacity : 1), max_age_(max_age) {}
+
+DiscoveryCache::Change DiscoveryCache::Upsert(const ClassicDeviceInfo& device,
+                                              Clock::time_point now,
+                                              std::vector<ClassicDeviceInfo>* evicted) {
+  BdAddr address;
+  if (!BdAddr::TryParse(device.address, &address)) {
+    return Change::kUnchanged;
+  }
+
+  if (const ClassicDeviceInfo* existing = table_.FindByAddress(address)) {
+    Touch(address, now);
+    if (*existing == device) {
+      return Change::kUnchanged;
+    }
+    table_.Upsert(device);
+    return Change::kUpdated;
+  }
+
+  while (table_.size() >= capacity_ && !lru_.empty()) {
+    ClassicDeviceInfo oldest;
+    Erase(lru_.back(), &oldest);
+    if (evicted != nullptr) {
+      evicted->push_back(std::move(oldest));
+    }
+  }
+  table_.Upsert(device);
+  lru_.push_front(address);
+  entries_[address] = Entry{lru_.begin(), now};
+  return Change::kAdded;
+}
+
+const ClassicDeviceInfo* DiscoveryCache::Update(const std::string& device_id,
+                                                const std::optional<std::string>& name,
+                                                std::optional<bool> paired,
+                                                Clock::time_point now) {
+  const ClassicDeviceInfo* existing = table_.FindByDeviceId(device_id);
+  if (existing == nullptr) {
+    return nullptr;
+  }
+  BdAddr address;
+  BdAddr::TryParse(existing->address, &address);
+  Touch(address, now);
+
+  ClassicDeviceInfo updated = *existing;
+  if (name.has_value()) {
+    updated.name = *name;
+  }
+  if (paired.has_value()) {
+    updated.paired = *paired;
+  }
+  if (updated == *existing) {
+    return nullptr;
+  }
+  return &table_.devices()[table_.Upsert(std::move(updated))];
+}
+
+bool DiscoveryCache::Remove(const std::string& device_id, ClassicDeviceInfo* removed) {
+  const ClassicDeviceInfo* existing = table_.FindByDeviceId(device_id);
+  if (existing == nullptr) {
+    return false;
+  }
+  BdAddr address;
+  BdAddr::TryParse(existing->address, &address);
+  Erase(address, removed);
+  return true;
+}
+
+std::vector<ClassicDeviceInfo> DiscoveryCache::Expire(Clock::time_point now) {
+  std::vector<ClassicDeviceInfo> expired;
+  while (!lru_.empty()) {
+    const BdAddr oldest = lru_.back();
+    if (now - entries_[oldest].last_seen < max_age_) {
+      break;
+    }
+    ClassicDeviceInfo device;
+    Erase(oldest, &device);
+    expired.push_back(std::move(device));
+  }
+  return expired;
+}
+
+const ClassicDeviceInfo* DiscoveryCache::FindByAddress(BdAddr address) const {
+  return table_.FindByAddress(address);
+}
+
+void DiscoveryCache::Clear() {
+  table_.Clear();
+  lru_.clear();
+  entries_.clear();
+}
+
+void DiscoveryCache::Touch(BdAddr address, Clock::time_point now) {
+  auto it = entries_.find(address);
+  if (it == entries_.end()) {
+    return;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  it->second.last_seen = now;
+}
+
+void DiscoveryCache::Erase(BdAddr address, ClassicDeviceInfo* removed) {
+  auto it = entries_.find(address);
+  if (it != entries_.end()) {
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+  }
+  const ClassicDeviceInfo* device = table_.FindByAddress(address);
+  if (device == nullptr) {
+    return;
+  }
+  if (removed != nullptr) {
+    *removed = *device;
+  }
+  table_.EraseAt(table_.PositionOf(*device));
+}
+
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,78 @@
+#ifndef FLUTTER_PLUGIN_DISCOVERY_CACHE_H_
+#define FLUTTER_PLUGIN_DISCOVERY_CACHE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bluetooth_address.h"
+#include "bluetooth_device_model.h"
+#include "device_table.h"
+
+namespace flutter_bluetooth_classic {
+
+// Devices seen during discovery, bounded in count and age.
+//
+// Every sighting (watcher Added or Updated) refreshes a device. Past
+// capacity the least recently seen device is evicted, and Expire() drops
+// devices not seen for max_age. Callers pass the current time, so the
+// policy runs the same under a fake clock. Not thread-safe.
+class DiscoveryCache {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Change { kAdded, kUpdated, kUnchanged };
+
+  DiscoveryCache(size_t capacity, Clock::duration max_age);
+
+  // Records a sighting of device, keyed by its address (devices without
+  // one are ignored and reported unchanged). Devices pushed out to make
+  // room are appended to evicted.
+  Change Upsert(const ClassicDeviceInfo& device, Clock::time_point now,
+                std::vector<ClassicDeviceInfo>* evicted);
+
+  // Applies a watcher update to the device with device_id; unset fields
+  // are left alone. Returns the device if it changed, null otherwise. Any
+  // update counts as a sighting.
+  const ClassicDeviceInfo* Update(const std::string& device_id,
+                                  const std::optional<std::string>& name,
+                                  std::optional<bool> paired,
+                                  Clock::time_point now);
+
+  // Removes the device with device_id; false if it was not present.
+  bool Remove(const std::string& device_id, ClassicDeviceInfo* removed);
+
+  // Removes and returns every device last seen max_age or longer ago,
+  // oldest first.
+  std::vector<ClassicDeviceInfo> Expire(Clock::time_point now);
+
+  const ClassicDeviceInfo* FindByAddress(BdAddr address) const;
+
+  void Clear();
+  size_t size() const { return table_.size(); }
+  Clock::duration max_age() const { return max_age_; }
+
+ private:
+  struct Entry {
+    std::list<BdAddr>::iterator lru;
+    Clock::time_point last_seen;
+  };
+
+  void Touch(BdAddr address, Clock::time_point now);
+  void Erase(BdAddr address, ClassicDeviceInfo* removed);
+
+  size_t capacity_;
+  Clock::duration max_age_;
+  DeviceTable table_;
+  // Most recently seen first
+  std::list<BdAddr> lru_;
+  std::unordered_map<BdAddr, Entry, BdAddrHash> entries_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_DISCOVERY_CACHE_H_
@@ -0,0 +1,61 @@
+#ifndef FLUTTER_PLUGIN_EVENT_STREAM_HANDLER_H_
+#define FLUTTER_PLUGIN_EVENT_STREAM_HANDLER_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/event_sink.h>
+#include <flutter/event_stream_handler.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace flutter_bluetooth_classic {
+
+// EventStreamHandler for managing event channels
+template<typename T = flutter::EncodableValue>
+class EventStreamHandler : public flutter::StreamHandler<T> {
+public:
+  EventStreamHandler() = default;
+  virtual ~EventStreamHandler() = default;
+
+  // Notify listeners with data
+  void Success(const T& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sink_) {
+      sink_->Success(event);
+    }
+  }
+
+  void Error(const std::string& error_code,
+             const std::string& error_message,
+             const T* error_details = nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sink_) {
+      sink_->Error(error_code, error_message, error_details);
+    }
+  }
+
+protected:
+  std::unique_ptr<flutter::StreamHandlerError<T>> OnListenInternal(
+      const T* /*arguments*/,
+      std::unique_ptr<flutter::EventSink<T>>&& events) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink_ = std::move(events);
+    return nullptr;
+  }
+
+  std::unique_ptr<flutter::StreamHandlerError<T>> OnCancelInternal(
+      const T* /*arguments*/) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sink_.reset();
+    return nullptr;
+  }
+
+private:
+  std::unique_ptr<flutter::EventSink<T>> sink_;
+  std::mutex mutex_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_EVENT_STREAM_HANDLER_H_
@@ -18,6 +18,33 @@ constexpr char kStateChannelName[] = "com.flutter_bluetooth_classic.plugin/flutt
 constexpr char kConnectionChannelName[] = "com.flutter_bluetooth_classic.plugin/flutter_bluetooth_classic_connection";
 constexpr char kDataChannelName[] = "com.flutter_bluetooth_classic.plugin/flutter_bluetooth_classic_data";
 
+namespace {
+
+// Reads the optional "connectionId" argument. Absent (or no argument map at
+// all) yields 0, which the manager treats as "the default connection".
+bool ReadConnectionId(const flutter::EncodableValue* arguments, int64_t* connection_id) {
+  *connection_id = 0;
+  const auto* args = arguments ? std::get_if<flutter::EncodableMap>(arguments) : nullptr;
+  if (!args) {
+    return true;
+  }
+  auto id_it = args->find(flutter::EncodableValue("connectionId"));
+  if (id_it == args->end() || id_it->second.IsNull()) {
+    return true;
+  }
+  if (const auto* id32 = std::get_if<int32_t>(&id_it->second)) {
+    *connection_id = *id32;
+    return *id32 > 0;
+  }
+  if (const auto* id64 = std::get_if<int64_t>(&id_it->second)) {
+    *connection_id = *id64;
+    return *id64 > 0;
+  }
+  return false;
+}
+
+}  // namespace
+
 // Static registration
 void FlutterBluetoothClassicPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarWindows* registrar) {
@@ -115,15 +142,47 @@ void FlutterBluetoothClassicPlugin::HandleMethodCall(
                   "Please enable it manually in system settings.");
   }
   else if (method == "getPairedDevices") {
-    bluetooth_manager_->GetPairedDevices(std::move(result));
+    bool progressive = false;
+    const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (args) {
+      auto progressive_it = args->find(flutter::EncodableValue("progressive"));
+      if (progressive_it != args->end()) {
+        const auto* value = std::get_if<bool>(&progressive_it->second);
+        progressive = value && *value;
+      }
+    }
+    bluetooth_manager_->GetPairedDevices(progressive, std::move(result));
   }
   else if (method == "startDiscovery") {
-    bluetooth_manager_->StartDiscovery(std::move(result));
+    const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    DiscoveryBatchOptions batch;
+    if (args) {
+      auto interval_it = args->find(flutter::EncodableValue("batchIntervalMs"));
+      if (interval_it != args->end()) {
+        int64_t value = 0;
+        if (!internal::ReadNonNegativeInt(interval_it->second, &value)) {
+          result->Error("INVALID_ARGUMENT", "batchIntervalMs must be a non-negative integer");
+          return;
+        }
+        batch.interval = std::chrono::milliseconds(value);
+      }
+
+      auto max_devices_it = args->find(flutter::EncodableValue("batchMaxDevices"));
+      if (max_devices_it != args->end()) {
+        int64_t value = 0;
+        if (!internal::ReadNonNegativeInt(max_devices_it->second, &value)) {
+          result->Error("INVALID_ARGUMENT", "batchMaxDevices must be a non-negative integer");
+          return;
+        }
+        batch.max_devices = static_cast<size_t>(value);
+      }
+    }
+    bluetooth_manager_->StartDiscovery(batch, std::move(result));
   }
   else if (method == "stopDiscovery") {
     bluetooth_manager_->StopDiscovery(std::move(result));
   }
-  else if (method == "connect") {
+  else if (method == "connect" || method == "openConnection") {
     const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
     if (!args) {
       result->Error("INVALID_ARGUMENT", "Arguments must be a map");
@@ -142,11 +201,28 @@ void FlutterBluetoothClassicPlugin::HandleMethodCall(
       return;
     }
 
-    bluetooth_manager_->Connect(*address, std::move(result));
+    flutter::EncodableMap options;
+    auto options_it = args->find(flutter::EncodableValue("options"));
+    if (options_it != args->end()) {
+      const auto* options_map = std::get_if<flutter::EncodableMap>(&options_it->second);
+      if (!options_map) {
+        result->Error("INVALID_ARGUMENT", "Connection options must be a map");
+        return;
+      }
+      options = *options_map;
+    }
+
+    if (method == "connect") {
+      bluetooth_manager_->Connect(*address, options, std::move(result));
+    } else {
+      bluetooth_manager_->OpenConnection(*address, options, std::move(result));
+    }
   }
   else if (method == "listen") {
     const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
     std::string app_name = "FlutterBluetoothClassic";
+    size_t max_peers = kDefaultMaxServerPeers;
+    AdmissionPolicy policy = AdmissionPolicy::kReject;
     
     if (args) {
       auto app_name_it = args->find(flutter::EncodableValue("appName"));
@@ -156,12 +232,51 @@ void FlutterBluetoothClassicPlugin::HandleMethodCall(
           app_name = *name;
         }
       }
+
+      auto max_peers_it = args->find(flutter::EncodableValue("maxPeers"));
+      if (max_peers_it != args->end()) {
+        int64_t value = 0;
+        if (!internal::ReadNonNegativeInt(max_peers_it->second, &value) || value == 0) {
+          result->Error("INVALID_ARGUMENT", "maxPeers must be a positive integer");
+          return;
+        }
+        max_peers = static_cast<size_t>(value);
+      }
+
+      auto policy_it = args->find(flutter::EncodableValue("admissionPolicy"));
+      if (policy_it != args->end()) {
+        const auto* policy_name = std::get_if<std::string>(&policy_it->second);
+        if (!policy_name || !ParseAdmissionPolicy(*policy_name, &policy)) {
+          result->Error("INVALID_ARGUMENT", "admissionPolicy must be 'reject' or 'evictOldest'");
+          return;
+        }
+      }
     }
 
-    bluetooth_manager_->Listen(app_name, std::move(result));
+    bluetooth_manager_->Listen(app_name, max_peers, policy, std::move(result));
+  }
+  else if (method == "cancelConnect") {
+    std::string address;
+    if (const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments())) {
+      auto address_it = args->find(flutter::EncodableValue("address"));
+      if (address_it != args->end()) {
+        const auto* value = std::get_if<std::string>(&address_it->second);
+        if (!value) {
+          result->Error("INVALID_ARGUMENT", "Device address must be a string");
+          return;
+        }
+        address = *value;
+      }
+    }
+    bluetooth_manager_->CancelConnect(address, std::move(result));
   }
   else if (method == "disconnect") {
-    bluetooth_manager_->Disconnect(std::move(result));
+    int64_t connection_id = 0;
+    if (!ReadConnectionId(method_call.arguments(), &connection_id)) {
+      result->Error("INVALID_ARGUMENT", "connectionId must be a positive integer");
+      return;
+    }
+    bluetooth_manager_->Disconnect(connection_id, std::move(result));
   }
   else if (method == "stopListen") {
     bluetooth_manager_->StopListen(std::move(result));
@@ -186,7 +301,30 @@ void FlutterBluetoothClassicPlugin::HandleMethodCall(
       return;
     }
 
-    bluetooth_manager_->SendData(*data, std::move(result));
+    int64_t connection_id = 0;
+    if (!ReadConnectionId(method_call.arguments(), &connection_id)) {
+      result->Error("INVALID_ARGUMENT", "connectionId must be a positive integer");
+      return;
+    }
+
+    bluetooth_manager_->SendData(connection_id, *data, std::move(result));
+  }
+  else if (method == "configure") {
+    const auto* args = std::get_if<flutter::EncodableMap>(method_call.arguments());
+    if (!args) {
+      result->Error("INVALID_ARGUMENT", "Arguments must be a map");
+      return;
+    }
+
+    bluetooth_manager_->Configure(*args, std::move(result));
+  }
+  else if (method == "getConnectionStats") {
+    int64_t connection_id = 0;
+    if (!ReadConnectionId(method_call.arguments(), &connection_id)) {
+      result->Error("INVALID_ARGUMENT", "connectionId must be a positive integer");
+      return;
+    }
+    bluetooth_manager_->GetConnectionStats(connection_id, std::move(result));
   }
   else {
     result->NotImplemented();
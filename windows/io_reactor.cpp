@@ -0,0 +1,100 @@
+#include "io_reactor.h"
+
+#include <windows.h>
+
+#include <memory>
+#include <utility>
+
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+constexpr ULONG_PTR kShutdownKey = 1;
+
+// OVERLAPPED must stay the first member: completions hand back its address.
+struct PendingOperation {
+  OVERLAPPED overlapped;
+  IoReactor::CompletionHandler handler;
+};
+
+}  // namespace
+
+IoReactor::IoReactor(WorkerPool* workers) : workers_(workers) {
+  port_ = CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1);
+  if (port_ != nullptr) {
+    thread_ = std::thread([this]() { ReactorMain(); });
+  }
+}
+
+IoReactor::~IoReactor() {
+  if (port_ == nullptr) {
+    return;
+  }
+  PostQueuedCompletionStatus(reinterpret_cast<HANDLE>(port_), 0, kShutdownKey, nullptr);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  CloseHandle(reinterpret_cast<HANDLE>(port_));
+  port_ = nullptr;
+}
+
+bool IoReactor::Associate(void* handle, std::string* error_message) {
+  if (port_ == nullptr ||
+      CreateIoCompletionPort(reinterpret_cast<HANDLE>(handle), reinterpret_cast<HANDLE>(port_), 0, 0) ==
+          nullptr) {
+    if (error_message != nullptr) {
+      *error_message = "IOCP_ASSOCIATE_FAILED (error=" + std::to_string(GetLastError()) + ")";
+    }
+    return false;
+  }
+  return true;
+}
+
+_OVERLAPPED* IoReactor::BeginOperation(CompletionHandler handler) {
+  auto* operation = new PendingOperation();
+  SecureZeroMemory(&operation->overlapped, sizeof(operation->overlapped));
+  operation->handler = std::move(handler);
+  return &operation->overlapped;
+}
+
+void IoReactor::AbandonOperation(_OVERLAPPED* overlapped) {
+  delete reinterpret_cast<PendingOperation*>(overlapped);
+}
+
+void IoReactor::Dispatch(std::function<void()> task) {
+  // Shared so a task the pool refuses is still here to run.
+  auto shared = std::make_shared<std::function<void()>>(std::move(task));
+  if (!workers_->Post([shared]() { (*shared)(); })) {
+    (*shared)();
+  }
+}
+
+void IoReactor::ReactorMain() {
+  HANDLE port = reinterpret_cast<HANDLE>(port_);
+  while (true) {
+    DWORD bytes_transferred = 0;
+    ULONG_PTR key = 0;
+    OVERLAPPED* overlapped = nullptr;
+    const BOOL ok = GetQueuedCompletionStatus(port, &bytes_transferred, &key, &overlapped, INFINITE);
+    if (overlapped == nullptr) {
+      if (key == kShutdownKey || !ok) {
+        return;
+      }
+      continue;
+    }
+
+    const DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+    // Shared so the task stays copyable. A stopping pool refuses it; the
+    // handler then runs here, since it owns an io reference that Close()
+    // waits for.
+    std::shared_ptr<PendingOperation> operation(reinterpret_cast<PendingOperation*>(overlapped));
+    if (!workers_->Post([operation, error, bytes_transferred]() {
+          operation->handler(error, bytes_transferred);
+        })) {
+      operation->handler(error, bytes_transferred);
+    }
+  }
+}
+
+}  // namespace flutter_bluetooth_classic
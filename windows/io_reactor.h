@@ -0,0 +1,60 @@
+#ifndef FLUTTER_PLUGIN_IO_REACTOR_H_
+#define FLUTTER_PLUGIN_IO_REACTOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+struct _OVERLAPPED;
+
+namespace flutter_bluetooth_classic {
+
+class WorkerPool;
+
+// I/O completion port shared by every COM transport.
+//
+// A single thread waits on the port for all associated handles and hands
+// each completion to the worker pool, so an idle link costs no thread and
+// handlers never run on the reactor thread itself.
+class IoReactor {
+ public:
+  // error is a Win32 error code (0 on success; ERROR_OPERATION_ABORTED
+  // after CancelIoEx).
+  using CompletionHandler = std::function<void(uint32_t error, uint32_t bytes_transferred)>;
+
+  explicit IoReactor(WorkerPool* workers);
+  ~IoReactor();
+
+  IoReactor(const IoReactor&) = delete;
+  IoReactor& operator=(const IoReactor&) = delete;
+
+  // Routes completions of overlapped calls on handle to this reactor.
+  // Operations that must not be routed here (plain waits on their own
+  // event) tag the low bit of OVERLAPPED::hEvent.
+  bool Associate(void* handle, std::string* error_message);
+
+  // Returns a zeroed OVERLAPPED for one call on an associated handle.
+  // handler runs exactly once on a worker when the call completes (on the
+  // reactor thread once the pool is stopping); if the call fails to start,
+  // pass the pointer to AbandonOperation instead.
+  _OVERLAPPED* BeginOperation(CompletionHandler handler);
+
+  // Frees an operation whose call never started (no completion is queued).
+  void AbandonOperation(_OVERLAPPED* overlapped);
+
+  // Runs task on the worker pool, e.g. for a result known synchronously;
+  // inline if the pool is stopping.
+  void Dispatch(std::function<void()> task);
+
+ private:
+  void ReactorMain();
+
+  WorkerPool* workers_;
+  void* port_ = nullptr;
+  std::thread thread_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_IO_REACTOR_H_
@@ -0,0 +1,556 @@
+#include "paired_device_index.h"
+
+#include <windows.h>
+
+#include <winrt/Windows.Devices.Bluetooth.h>
+#include <winrt/Windows.Foundation.Collections.h>
+
+#include <chrono>
+#include <optional>
+#include <utility>
+
+#include "bluetooth_address.h"
+#include "bluetooth_classic_registry_enum.h"
+#include "cache_file.h"
+#include "device_cache_format.h"
+#include "winrt_awaitable.h"
+#include "worker_pool.h"
+
+using namespace winrt;
+using namespace Windows::Foundation;
+using namespace Windows::Devices::Bluetooth;
+using namespace Windows::Devices::Enumeration;
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+// A watcher that never completes must not hold connects hostage.
+constexpr std::chrono::seconds kInitialBuildTimeout{10};
+
+// Address lookups in flight at once, and how long each may take.
+constexpr size_t kMaxConcurrentResolves = 4;
+constexpr std::chrono::seconds kResolveTimeout{5};
+
+// Anything larger is not a cache this code wrote
+constexpr size_t kMaxCacheFileSize = 4 * 1024 * 1024;
+
+constexpr wchar_t kBthEnumPath[] = L"SYSTEM\\CurrentControlSet\\Enum\\BTHENUM";
+
+void CALLBACK RegistryChanged(void* context, BOOLEAN /*timed_out*/) {
+  static_cast<PairedDeviceIndex*>(context)->OnRegistrySignaled();
+}
+
+std::string ToUtf8(hstring const& value) {
+  std::wstring wide = value.c_str();
+  return std::string(wide.begin(), wide.end());
+}
+
+std::vector<ClassicDeviceInfo> ReadRegistryDevices() {
+  BluetoothClassicRegistryEnumerator registry_enumerator;
+  auto registry_devices = registry_enumerator.EnumerateClassicSppDevices();
+  std::vector<ClassicDeviceInfo> devices;
+  devices.reserve(registry_devices.size());
+  for (auto& registry_device : registry_devices) {
+    registry_device.address = NormalizeAddress(registry_device.address);
+    registry_device.com_port = NormalizeComPort(registry_device.com_port);
+    if (registry_device.connect_key.empty()) {
+      if (!registry_device.address.empty()) {
+        registry_device.connect_key = registry_device.address;
+      } else if (!registry_device.com_port.empty()) {
+        registry_device.connect_key = "COM:" + registry_device.com_port;
+      }
+    }
+    if (registry_device.connect_key.empty()) {
+      continue;
+    }
+    devices.push_back(std::move(registry_device));
+  }
+  return devices;
+}
+
+}  // namespace
+
+PairedDeviceIndex::PairedDeviceIndex(WorkerPool* workers, std::wstring cache_path)
+    : workers_(workers),
+      snapshot_(std::make_shared<const Snapshot>()),
+      resolves_(kMaxConcurrentResolves),
+      cache_path_(std::move(cache_path)) {}
+
+PairedDeviceIndex::~PairedDeviceIndex() {
+  Stop();
+}
+
+void PairedDeviceIndex::Start() {
+  std::weak_ptr<PairedDeviceIndex> weak_self = weak_from_this();
+
+  LoadCache();
+
+  // Registry: one persistent wait on an auto-reset event; each signal
+  // schedules a re-read, which also re-arms the notification.
+  {
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    HKEY key = nullptr;
+    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, kBthEnumPath, 0, KEY_READ | KEY_NOTIFY, &key) == ERROR_SUCCESS) {
+      registry_key_ = key;
+      registry_event_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+      HANDLE wait = nullptr;
+      if (registry_event_ != nullptr &&
+          RegisterWaitForSingleObject(
+              &wait, static_cast<HANDLE>(registry_event_), &RegistryChanged, this, INFINITE,
+              WT_EXECUTEDEFAULT)) {
+        registry_wait_ = wait;
+      }
+    }
+  }
+  registry_refresh_pending_ = true;
+  workers_->Post([weak_self]() {
+    if (auto self = weak_self.lock()) {
+      self->RefreshRegistry();
+    }
+  });
+
+  // WinRT: the paired-only selector reports unpairing as Removed
+  try {
+    watcher_ = DeviceInformation::CreateWatcher(BluetoothDevice::GetDeviceSelectorFromPairingState(true));
+    watcher_added_token_ = watcher_.Added([weak_self](DeviceWatcher const&, DeviceInformation const& info) {
+      if (auto self = weak_self.lock()) {
+        self->OnWatcherAdded(info);
+      }
+    });
+    watcher_updated_token_ =
+        watcher_.Updated([weak_self](DeviceWatcher const&, DeviceInformationUpdate const& update) {
+          if (auto self = weak_self.lock()) {
+            self->OnWatcherUpdated(update);
+          }
+        });
+    watcher_removed_token_ =
+        watcher_.Removed([weak_self](DeviceWatcher const&, DeviceInformationUpdate const& update) {
+          if (auto self = weak_self.lock()) {
+            self->OnWatcherRemoved(update);
+          }
+        });
+    watcher_completed_token_ =
+        watcher_.EnumerationCompleted([weak_self](DeviceWatcher const&, IInspectable const&) {
+          if (auto self = weak_self.lock()) {
+            self->OnWatcherFinished();
+          }
+        });
+    watcher_stopped_token_ = watcher_.Stopped([weak_self](DeviceWatcher const&, IInspectable const&) {
+      if (auto self = weak_self.lock()) {
+        self->OnWatcherFinished();
+      }
+    });
+    watcher_.Start();
+  }
+  catch (...) {
+    // Registry data alone is still useful
+    OnWatcherFinished();
+  }
+
+  workers_->PostAfter(kInitialBuildTimeout, [weak_self]() {
+    if (auto self = weak_self.lock()) {
+      std::lock_guard<std::mutex> lock(self->mutex_);
+      self->MarkReadyLocked();
+    }
+  });
+}
+
+void PairedDeviceIndex::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+    change_listener_ = nullptr;
+    MarkReadyLocked();
+  }
+
+  if (watcher_) {
+    try {
+      watcher_.Added(watcher_added_token_);
+      watcher_.Updated(watcher_updated_token_);
+      watcher_.Removed(watcher_removed_token_);
+      watcher_.EnumerationCompleted(watcher_completed_token_);
+      watcher_.Stopped(watcher_stopped_token_);
+      if (watcher_.Status() == DeviceWatcherStatus::Started ||
+          watcher_.Status() == DeviceWatcherStatus::EnumerationCompleted) {
+        watcher_.Stop();
+      }
+    }
+    catch (...) {
+      // Ignore errors during cleanup
+    }
+  }
+
+  // Waits for a running RegistryChanged callback before the event goes away
+  if (registry_wait_ != nullptr) {
+    UnregisterWaitEx(static_cast<HANDLE>(registry_wait_), INVALID_HANDLE_VALUE);
+    registry_wait_ = nullptr;
+  }
+  std::lock_guard<std::mutex> lock(registry_mutex_);
+  if (registry_event_ != nullptr) {
+    CloseHandle(static_cast<HANDLE>(registry_event_));
+    registry_event_ = nullptr;
+  }
+  if (registry_key_ != nullptr) {
+    RegCloseKey(static_cast<HKEY>(registry_key_));
+    registry_key_ = nullptr;
+  }
+}
+
+void PairedDeviceIndex::SetChangeListener(ChangeListener listener) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!stopped_) {
+    change_listener_ = std::move(listener);
+  }
+}
+
+std::shared_ptr<const PairedDeviceIndex::Snapshot> PairedDeviceIndex::Current() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return snapshot_;
+}
+
+bool PairedDeviceIndex::IsBuilt() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return built_;
+}
+
+Task<std::shared_ptr<const PairedDeviceIndex::Snapshot>> PairedDeviceIndex::SnapshotAsync(
+    CancellationToken cancel) {
+  co_await ReadyAwaiter{this};
+  cancel.ThrowIfCancelled();
+  co_return Current();
+}
+
+bool PairedDeviceIndex::ReadyAwaiter::await_ready() const {
+  std::lock_guard<std::mutex> lock(index->mutex_);
+  return index->ready_;
+}
+
+bool PairedDeviceIndex::ReadyAwaiter::await_suspend(std::coroutine_handle<> handle) const {
+  std::lock_guard<std::mutex> lock(index->mutex_);
+  if (index->ready_) {
+    return false;
+  }
+  index->ready_waiters_.push_back(handle);
+  return true;
+}
+
+void PairedDeviceIndex::OnRegistrySignaled() {
+  // Runs on the OS wait thread: only hand off, never take the last
+  // reference here (Stop() waits for this callback).
+  if (registry_refresh_pending_.exchange(true)) {
+    return;
+  }
+  std::weak_ptr<PairedDeviceIndex> weak_self = weak_from_this();
+  workers_->Post([weak_self]() {
+    if (auto self = weak_self.lock()) {
+      self->RefreshRegistry();
+    }
+  });
+}
+
+void PairedDeviceIndex::RefreshRegistry() {
+  std::vector<ClassicDeviceInfo> devices;
+  {
+    std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+    registry_refresh_pending_ = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_) {
+        return;
+      }
+    }
+    // Re-arm before reading so a change made during the walk is not lost
+    ArmRegistryNotificationLocked();
+    devices = ReadRegistryDevices();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopped_) {
+    return;
+  }
+  registry_devices_ = std::move(devices);
+  registry_loaded_ = true;
+  PublishLocked();
+  MaybeReadyLocked();
+}
+
+bool PairedDeviceIndex::ArmRegistryNotificationLocked() {
+  if (registry_key_ == nullptr || registry_event_ == nullptr) {
+    return false;
+  }
+  const LONG rc = RegNotifyChangeKeyValue(
+      static_cast<HKEY>(registry_key_), TRUE,
+      REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC,
+      static_cast<HANDLE>(registry_event_), TRUE);
+  return rc == ERROR_SUCCESS;
+}
+
+void PairedDeviceIndex::OnWatcherAdded(DeviceInformation const& info) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      return;
+    }
+    resolves_.Add(ToUtf8(info.Id()), info);
+  }
+  StartQueuedResolves();
+}
+
+void PairedDeviceIndex::StartQueuedResolves() {
+  auto self = shared_from_this();
+  for (;;) {
+    std::optional<ResolveQueue<DeviceInformation>::Started> job;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_) {
+        return;
+      }
+      job = resolves_.StartNext();
+      if (!job) {
+        return;
+      }
+    }
+
+    // Started outside the lock: a lookup that is already complete finishes
+    // inline and re-enters CompleteResolve.
+    Spawn(ResolveAsync(job->job),
+          [self, id = job->id, generation = job->generation](std::future<ClassicDeviceInfo> resolved) {
+            self->CompleteResolve(id, generation, std::move(resolved));
+          });
+  }
+}
+
+Task<ClassicDeviceInfo> PairedDeviceIndex::ResolveAsync(DeviceInformation info) {
+  ClassicDeviceInfo device;
+  device.name = ToUtf8(info.Name());
+  device.paired = true;
+  device.remembered = true;
+  device.source = "winrt-classic";
+  device.device_id = ToUtf8(info.Id());
+
+  // One unreachable device must not hold up the initial build
+  CancellationSource timeout;
+  timeout.CancelAfter(workers_, kResolveTimeout);
+
+  auto bt_device_async = BluetoothDevice::FromIdAsync(info.Id());
+  auto bt_device = co_await AwaitWinRt(bt_device_async, workers_, timeout.token());
+  if (bt_device) {
+    device.address = BdAddr(bt_device.BluetoothAddress()).ToString();
+  }
+  device.connect_key = device.address;
+  co_return device;
+}
+
+void PairedDeviceIndex::CompleteResolve(
+    const std::string& id, uint64_t generation, std::future<ClassicDeviceInfo> resolved) {
+  ClassicDeviceInfo device;
+  try {
+    device = resolved.get();
+  }
+  catch (...) {
+    // Keep going without this device; its address could not be read in time.
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (resolves_.Finish(id, generation) && !stopped_) {
+      if (!device.address.empty()) {
+        winrt_devices_[id] = std::move(device);
+        PublishLocked();
+      }
+      MaybeReadyLocked();
+    }
+  }
+  StartQueuedResolves();
+}
+
+void PairedDeviceIndex::OnWatcherUpdated(DeviceInformationUpdate const& update) {
+  // Only a rename changes what the index reports
+  auto properties = update.Properties();
+  if (!properties.HasKey(L"System.ItemNameDisplay")) {
+    return;
+  }
+  auto name = properties.Lookup(L"System.ItemNameDisplay").try_as<IPropertyValue>();
+  if (!name || name.Type() != PropertyType::String) {
+    return;
+  }
+
+  const std::string id = ToUtf8(update.Id());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = winrt_devices_.find(id);
+  if (stopped_ || it == winrt_devices_.end()) {
+    return;
+  }
+  it->second.name = ToUtf8(name.GetString());
+  PublishLocked();
+}
+
+void PairedDeviceIndex::OnWatcherRemoved(DeviceInformationUpdate const& update) {
+  const std::string id = ToUtf8(update.Id());
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopped_) {
+    return;
+  }
+  resolves_.Remove(id);
+  if (winrt_devices_.erase(id) > 0) {
+    PublishLocked();
+  }
+  MaybeReadyLocked();
+}
+
+void PairedDeviceIndex::OnWatcherFinished() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enumeration_completed_ = true;
+  MaybeReadyLocked();
+}
+
+void PairedDeviceIndex::PublishLocked() {
+  // Registry rows first (they carry the COM port), then WinRT rows fill in
+  // names and ids or add devices without a port.
+  // Ordered by connect key so the list does not depend on completion order
+  std::map<std::string, ClassicDeviceInfo> merged;
+  for (const auto& cached_device : cached_devices_) {
+    merged[cached_device.connect_key] = cached_device;
+  }
+  for (const auto& registry_device : registry_devices_) {
+    merged[registry_device.connect_key] = registry_device;
+  }
+  for (const auto& entry : winrt_devices_) {
+    const ClassicDeviceInfo& device = entry.second;
+    auto it = merged.find(device.connect_key);
+    if (it == merged.end()) {
+      merged[device.connect_key] = device;
+      continue;
+    }
+    ClassicDeviceInfo& existing = it->second;
+    if (existing.name.empty() && !device.name.empty()) {
+      existing.name = device.name;
+    }
+    if (existing.device_id.empty()) {
+      existing.device_id = device.device_id;
+    }
+    existing.paired = existing.paired || device.paired;
+    existing.remembered = existing.remembered || device.remembered;
+    if (existing.source != "winrt-classic") {
+      existing.source = "registry+winrt";
+    }
+  }
+
+  auto snapshot = std::make_shared<Snapshot>();
+  snapshot->Reserve(merged.size());
+  for (auto& entry : merged) {
+    ClassicDeviceInfo& device = entry.second;
+    if (device.address.empty() && !device.com_port.empty()) {
+      device.address = "COM:" + device.com_port;
+    }
+    if (device.connect_key.empty()) {
+      device.connect_key = entry.first;
+    }
+    snapshot->Upsert(std::move(device));
+  }
+
+  Changes changes;
+  std::unordered_map<std::string, const ClassicDeviceInfo*> previous;
+  for (const auto& device : snapshot_->devices()) {
+    previous[device.connect_key] = &device;
+  }
+  for (const auto& device : snapshot->devices()) {
+    auto it = previous.find(device.connect_key);
+    if (it == previous.end() || *it->second != device) {
+      changes.updated.push_back(device);
+    }
+    if (it != previous.end()) {
+      previous.erase(it);
+    }
+  }
+  for (const auto& entry : previous) {
+    changes.removed.push_back(*entry.second);
+  }
+  if (changes.updated.empty() && changes.removed.empty()) {
+    // Nothing visible changed; keep the current snapshot
+    return;
+  }
+  if (change_listener_) {
+    change_listener_(changes);
+  }
+  if (built_) {
+    ScheduleSaveLocked();
+  }
+  snapshot_ = std::move(snapshot);
+}
+
+void PairedDeviceIndex::MaybeReadyLocked() {
+  if (!built_ && registry_loaded_ && enumeration_completed_ && resolves_.Idle()) {
+    FinishBuildLocked();
+  }
+}
+
+void PairedDeviceIndex::FinishBuildLocked() {
+  built_ = true;
+  if (!cached_devices_.empty()) {
+    // Cached entries the live sources did not confirm are gone now
+    cached_devices_.clear();
+    PublishLocked();
+  }
+  if (change_listener_) {
+    Changes changes;
+    changes.complete = true;
+    change_listener_(changes);
+  }
+  ScheduleSaveLocked();
+  MarkReadyLocked();
+}
+
+void PairedDeviceIndex::MarkReadyLocked() {
+  if (ready_) {
+    return;
+  }
+  ready_ = true;
+  for (auto handle : ready_waiters_) {
+    workers_->Post([handle]() { handle.resume(); });
+  }
+  ready_waiters_.clear();
+}
+
+void PairedDeviceIndex::LoadCache() {
+  std::vector<ClassicDeviceInfo> devices;
+  const bool loaded =
+      ReadCacheFile(cache_path_, kMaxCacheFileSize, [&devices](const uint8_t* data, size_t size) {
+        return DecodeDeviceCache(data, size, &devices);
+      });
+
+  // A damaged or outdated file is ignored and rewritten after the build
+  if (!loaded || devices.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopped_ || built_) {
+    return;
+  }
+  cached_devices_ = std::move(devices);
+  PublishLocked();
+  MarkReadyLocked();
+}
+
+void PairedDeviceIndex::ScheduleSaveLocked() {
+  if (cache_path_.empty() || stopped_ || save_pending_.exchange(true)) {
+    return;
+  }
+  std::weak_ptr<PairedDeviceIndex> weak_self = weak_from_this();
+  workers_->Post([weak_self]() {
+    if (auto self = weak_self.lock()) {
+      self->SaveCache();
+    }
+  });
+}
+
+void PairedDeviceIndex::SaveCache() {
+  std::lock_guard<std::mutex> file_lock(cache_file_mutex_);
+  save_pending_ = false;
+  WriteCacheFile(cache_path_, EncodeDeviceCache(Current()->devices()));
+}
+
+}  // namespace flutter_bluetooth_classic
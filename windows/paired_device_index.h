@@ -0,0 +1,166 @@
+#ifndef FLUTTER_PLUGIN_PAIRED_DEVICE_INDEX_H_
+#define FLUTTER_PLUGIN_PAIRED_DEVICE_INDEX_H_
+
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Devices.Enumeration.h>
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "async_task.h"
+#include "bluetooth_device_model.h"
+#include "device_table.h"
+#include "resolve_queue.h"
+
+namespace flutter_bluetooth_classic {
+
+class WorkerPool;
+
+// Paired classic devices, merged from the BTHENUM registry tree (COM
+// ports) and WinRT (paired-device watcher).
+//
+// The merged list is built once and then patched from change notifications:
+// a registry change re-reads BTHENUM and a watcher event adds, renames or
+// drops one device. Readers only copy a shared_ptr to the latest immutable
+// snapshot. Must be held in a shared_ptr.
+//
+// With a cache path the last list is saved to disk and served at startup
+// until the live build has confirmed or dropped each cached entry.
+class PairedDeviceIndex : public std::enable_shared_from_this<PairedDeviceIndex> {
+ public:
+  // Published tables are never modified again
+  using Snapshot = DeviceTable;
+
+
+  // What one publish changed, matched by connect key. A last Changes with
+  // only complete set marks the end of the initial build.
+  struct Changes {
+    std::vector<ClassicDeviceInfo> updated;
+    std::vector<ClassicDeviceInfo> removed;
+    bool complete = false;
+  };
+
+  // Called with the index lock held, so changes arrive in order; it must not
+  // call back into the index.
+  using ChangeListener = std::function<void(const Changes& changes)>;
+
+  // An empty cache_path disables the on-disk cache.
+  PairedDeviceIndex(WorkerPool* workers, std::wstring cache_path);
+  ~PairedDeviceIndex();
+
+  PairedDeviceIndex(const PairedDeviceIndex&) = delete;
+  PairedDeviceIndex& operator=(const PairedDeviceIndex&) = delete;
+
+  // Loads the registry and starts both change sources.
+  void Start();
+
+  // Stops notifications and releases anyone waiting for the first build.
+  void Stop();
+
+  // Replaces the listener (an empty function removes it). Set before Start()
+  // to see the initial build as it fills in.
+  void SetChangeListener(ChangeListener listener);
+
+  // Latest snapshot; empty (never null) before the first build.
+  std::shared_ptr<const Snapshot> Current() const;
+
+  // Whether the initial build has finished and sent its complete Changes.
+  bool IsBuilt() const;
+
+  // Latest snapshot once the on-disk cache is loaded or the initial build
+  // has finished (or given up after kInitialBuildTimeout).
+  Task<std::shared_ptr<const Snapshot>> SnapshotAsync(CancellationToken cancel);
+
+  // Registry wait callback (OS thread pool); schedules one re-read.
+  void OnRegistrySignaled();
+
+ private:
+  // Suspends until ready_; resumed on a worker.
+  struct ReadyAwaiter {
+    PairedDeviceIndex* index;
+    bool await_ready() const;
+    bool await_suspend(std::coroutine_handle<> handle) const;
+    void await_resume() const {}
+  };
+
+  // Registry side
+  void RefreshRegistry();
+  bool ArmRegistryNotificationLocked();
+
+  // Watcher side
+  void OnWatcherAdded(winrt::Windows::Devices::Enumeration::DeviceInformation const& info);
+  void OnWatcherUpdated(winrt::Windows::Devices::Enumeration::DeviceInformationUpdate const& update);
+  void OnWatcherRemoved(winrt::Windows::Devices::Enumeration::DeviceInformationUpdate const& update);
+  void OnWatcherFinished();
+  // Starts queued lookups up to kMaxConcurrentResolves
+  void StartQueuedResolves();
+  Task<ClassicDeviceInfo> ResolveAsync(winrt::Windows::Devices::Enumeration::DeviceInformation info);
+  void CompleteResolve(const std::string& id, uint64_t generation, std::future<ClassicDeviceInfo> resolved);
+
+  // Rebuilds snapshot_ from registry_devices_ and winrt_devices_ (plus
+  // cached_devices_ until built_) and reports the difference to
+  // change_listener_
+  void PublishLocked();
+  void MaybeReadyLocked();
+  void FinishBuildLocked();
+  void MarkReadyLocked();
+
+  // On-disk cache
+  void LoadCache();
+  void ScheduleSaveLocked();
+  void SaveCache();
+
+  WorkerPool* workers_;
+
+  mutable std::mutex mutex_;
+  std::shared_ptr<const Snapshot> snapshot_;
+  std::vector<ClassicDeviceInfo> registry_devices_;
+  // Resolved WinRT devices by DeviceInformation id
+  std::map<std::string, ClassicDeviceInfo> winrt_devices_;
+  // Address lookups of watcher Added devices by id; a Removed or a newer
+  // Added makes a lookup in flight stale.
+  ResolveQueue<winrt::Windows::Devices::Enumeration::DeviceInformation> resolves_;
+  bool registry_loaded_ = false;
+  bool enumeration_completed_ = false;
+  // Both live sources have reported in full
+  bool built_ = false;
+  // Snapshot usable (from the cache or the build); releases ready_waiters_
+  bool ready_ = false;
+  bool stopped_ = false;
+  std::vector<std::coroutine_handle<>> ready_waiters_;
+  ChangeListener change_listener_;
+
+  // Loaded from disk; only used until built_
+  std::wstring cache_path_;
+  std::vector<ClassicDeviceInfo> cached_devices_;
+  // Serializes writers of the cache file; save_pending_ coalesces requests
+  std::mutex cache_file_mutex_;
+  std::atomic<bool> save_pending_{false};
+
+  // Serializes registry walks with Stop() closing the handles below
+  std::mutex registry_mutex_;
+  std::atomic<bool> registry_refresh_pending_{false};
+  void* registry_key_ = nullptr;
+  void* registry_event_ = nullptr;
+  void* registry_wait_ = nullptr;
+
+  winrt::Windows::Devices::Enumeration::DeviceWatcher watcher_{nullptr};
+  winrt::event_token watcher_added_token_{};
+  winrt::event_token watcher_updated_token_{};
+  winrt::event_token watcher_removed_token_{};
+  winrt::event_token watcher_completed_token_{};
+  winrt::event_token watcher_stopped_token_{};
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_PAIRED_DEVICE_INDEX_H_
@@ -0,0 +1,157 @@
+#include "poll_reactor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+
+PollReactor::PollReactor(WorkerPool* workers) : workers_(workers) {
+  int fds[2];
+  if (pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0) {
+    wake_read_ = fds[0];
+    wake_write_ = fds[1];
+    thread_ = std::thread([this]() { ReactorMain(); });
+  }
+}
+
+PollReactor::~PollReactor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  Wake();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  std::unordered_map<int, Registration> remaining;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    remaining.swap(watches_);
+  }
+  for (auto& entry : remaining) {
+    Dispatch([handler = std::move(entry.second.handler)]() { handler(Event::kCancelled, 0); });
+  }
+
+  if (wake_read_ >= 0) {
+    close(wake_read_);
+    close(wake_write_);
+  }
+}
+
+void PollReactor::Watch(int fd, ReadyHandler handler) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopping_ && wake_read_ >= 0 && watches_.count(fd) == 0) {
+      watches_[fd] = Registration{next_watch_id_++, std::move(handler)};
+      handler = nullptr;
+    }
+  }
+  if (handler) {
+    Dispatch([handler = std::move(handler)]() { handler(Event::kCancelled, 0); });
+    return;
+  }
+  Wake();
+}
+
+void PollReactor::Cancel(int fd) {
+  ReadyHandler handler;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = watches_.find(fd);
+    if (it == watches_.end()) {
+      return;
+    }
+    handler = std::move(it->second.handler);
+    watches_.erase(it);
+  }
+  // The reactor thread drops fd from its set on the next pass.
+  Wake();
+  Dispatch([handler = std::move(handler)]() { handler(Event::kCancelled, 0); });
+}
+
+void PollReactor::Dispatch(std::function<void()> task) {
+  // Shared so a task the pool refuses is still here to run.
+  auto shared = std::make_shared<std::function<void()>>(std::move(task));
+  if (!workers_->Post([shared]() { (*shared)(); })) {
+    (*shared)();
+  }
+}
+
+void PollReactor::Wake() {
+  if (wake_write_ < 0) {
+    return;
+  }
+  const char byte = 0;
+  // A full pipe already guarantees a wakeup.
+  [[maybe_unused]] const ssize_t written = write(wake_write_, &byte, 1);
+}
+
+void PollReactor::ReactorMain() {
+  std::vector<pollfd> fds;
+  std::vector<uint64_t> ids;
+  while (true) {
+    fds.assign(1, pollfd{wake_read_, POLLIN, 0});
+    ids.assign(1, 0);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        return;
+      }
+      for (const auto& entry : watches_) {
+        fds.push_back(pollfd{entry.first, POLLIN, 0});
+        ids.push_back(entry.second.id);
+      }
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+
+    if (fds[0].revents != 0) {
+      char buffer[64];
+      while (read(wake_read_, buffer, sizeof(buffer)) > 0) {
+      }
+    }
+
+    for (size_t i = 1; i < fds.size(); ++i) {
+      const short revents = fds[i].revents;
+      if (revents == 0) {
+        continue;
+      }
+      ReadyHandler handler;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = watches_.find(fds[i].fd);
+        // Cancelled, or re-watched after the descriptor number was reused
+        if (it == watches_.end() || it->second.id != ids[i]) {
+          continue;
+        }
+        handler = std::move(it->second.handler);
+        watches_.erase(it);
+      }
+
+      // Input that is still buffered goes first; the read reports a hangup.
+      Event event = Event::kReadable;
+      int error = 0;
+      if ((revents & POLLIN) == 0) {
+        event = Event::kError;
+        error = (revents & POLLNVAL) ? EBADF : (revents & POLLERR) ? EIO : 0;
+      }
+      Dispatch([handler = std::move(handler), event, error]() { handler(event, error); });
+    }
+  }
+}
+
+}  // namespace flutter_bluetooth_classic
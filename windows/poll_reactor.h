@@ -0,0 +1,71 @@
+#ifndef FLUTTER_PLUGIN_POLL_REACTOR_H_
+#define FLUTTER_PLUGIN_POLL_REACTOR_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace flutter_bluetooth_classic {
+
+class WorkerPool;
+
+// poll() counterpart of IoReactor for POSIX serial ports.
+//
+// A single thread polls every watched descriptor plus a wake pipe and hands
+// each readiness to the worker pool, so an idle link costs no CPU and no
+// thread, and handlers never run on the reactor thread itself. A watch is
+// one-shot, like an armed WaitCommEvent.
+class PollReactor {
+ public:
+  enum class Event {
+    kReadable,
+    kError,
+    kCancelled,
+  };
+
+  // error is an errno value for kError (0 when the peer hung up).
+  using ReadyHandler = std::function<void(Event event, int error)>;
+
+  explicit PollReactor(WorkerPool* workers);
+  // Completes the remaining watches with kCancelled.
+  ~PollReactor();
+
+  PollReactor(const PollReactor&) = delete;
+  PollReactor& operator=(const PollReactor&) = delete;
+
+  // handler runs exactly once on a worker: when fd has input or fails, or
+  // when the watch is cancelled. At most one watch per descriptor.
+  void Watch(int fd, ReadyHandler handler);
+
+  // Completes the watch on fd, if any, with kCancelled.
+  void Cancel(int fd);
+
+  // Runs task on the worker pool, or inline once the pool is shutting down
+  // so a handler is never dropped.
+  void Dispatch(std::function<void()> task);
+
+ private:
+  struct Registration {
+    uint64_t id = 0;
+    ReadyHandler handler;
+  };
+
+  void ReactorMain();
+  void Wake();
+
+  WorkerPool* workers_;
+  int wake_read_ = -1;
+  int wake_write_ = -1;
+  std::mutex mutex_;
+  // Ids tell a watch from an earlier one on a reused descriptor number.
+  std::unordered_map<int, Registration> watches_;
+  uint64_t next_watch_id_ = 1;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_POLL_REACTOR_H_
@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_RECEIVE_BUFFER_POOL_H_
+#define FLUTTER_PLUGIN_RECEIVE_BUFFER_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+
+// Per-connection free list of receive buffers.
+//
+// Read loops Acquire() a buffer, fill it, hand it to the data event and
+// Release() it once the codec has serialized the event. After warm-up every
+// Acquire is served from the free list; allocations() counts the times it
+// was not, so a flat counter proves the read path is allocation-free.
+class ReceiveBufferPool {
+ public:
+  ReceiveBufferPool(size_t buffer_capacity, size_t max_pooled_buffers)
+      : buffer_capacity_(buffer_capacity), max_pooled_buffers_(max_pooled_buffers) {
+    free_buffers_.reserve(max_pooled_buffers_);
+  }
+
+  ReceiveBufferPool(const ReceiveBufferPool&) = delete;
+  ReceiveBufferPool& operator=(const ReceiveBufferPool&) = delete;
+
+  // Returns an empty buffer with at least buffer_capacity() reserved.
+  std::vector<uint8_t> Acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_buffers_.empty()) {
+        std::vector<uint8_t> buffer = std::move(free_buffers_.back());
+        free_buffers_.pop_back();
+        return buffer;
+      }
+    }
+
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    std::vector<uint8_t> buffer;
+    buffer.reserve(buffer_capacity_);
+    return buffer;
+  }
+
+  // Buffers that lost their storage (moved-from) or exceed the pool size are
+  // simply dropped.
+  void Release(std::vector<uint8_t> buffer) {
+    if (buffer.capacity() < buffer_capacity_) {
+      return;
+    }
+    buffer.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_buffers_.size() < max_pooled_buffers_) {
+      free_buffers_.push_back(std::move(buffer));
+    }
+  }
+
+  size_t buffer_capacity() const { return buffer_capacity_; }
+  uint64_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+
+ private:
+  const size_t buffer_capacity_;
+  const size_t max_pooled_buffers_;
+  std::mutex mutex_;
+  std::vector<std::vector<uint8_t>> free_buffers_;
+  std::atomic<uint64_t> allocations_{0};
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_RECEIVE_BUFFER_POOL_H_
@@ -0,0 +1,88 @@
+#ifndef FLUTTER_PLUGIN_RESOLVE_QUEUE_H_
+#define FLUTTER_PLUGIN_RESOLVE_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace flutter_bluetooth_classic {
+
+// Keyed lookups run at most max_active at a time; the rest wait in arrival
+// order and start as earlier ones finish.
+//
+// Adding an id again or removing it makes its earlier lookup stale: a
+// queued one is skipped and a running one reports its result as unwanted.
+// Not thread-safe; the owner calls it under its own lock and starts the
+// returned jobs outside of it.
+template <typename Job>
+class ResolveQueue {
+ public:
+  struct Started {
+    std::string id;
+    uint64_t generation;
+    Job job;
+  };
+
+  explicit ResolveQueue(size_t max_active) : max_active_(max_active) {}
+
+  // Queues a lookup for id, superseding any earlier one.
+  void Add(const std::string& id, Job job) {
+    const uint64_t generation = ++next_generation_;
+    pending_[id] = generation;
+    queue_.push_back(Started{id, generation, std::move(job)});
+  }
+
+  // Drops id; its queued or running lookup becomes stale.
+  void Remove(const std::string& id) { pending_.erase(id); }
+
+  // The next lookup to start, or nothing when max_active are running or
+  // none is queued. Every job returned must be passed to Finish.
+  std::optional<Started> StartNext() {
+    if (active_ >= max_active_) {
+      return std::nullopt;
+    }
+    while (!queue_.empty()) {
+      Started next = std::move(queue_.front());
+      queue_.pop_front();
+      auto it = pending_.find(next.id);
+      if (it != pending_.end() && it->second == next.generation) {
+        ++active_;
+        return next;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Ends a started lookup. True if its result is still wanted; id is then
+  // no longer pending.
+  bool Finish(const std::string& id, uint64_t generation) {
+    --active_;
+    auto it = pending_.find(id);
+    if (it == pending_.end() || it->second != generation) {
+      return false;
+    }
+    pending_.erase(it);
+    return true;
+  }
+
+  // No lookup is queued or running that is still wanted.
+  bool Idle() const { return pending_.empty(); }
+
+  size_t active() const { return active_; }
+
+ private:
+  size_t max_active_;
+  // Latest generation per id still waiting for a result
+  std::map<std::string, uint64_t> pending_;
+  uint64_t next_generation_ = 0;
+  std::deque<Started> queue_;
+  size_t active_ = 0;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_RESOLVE_QUEUE_H_
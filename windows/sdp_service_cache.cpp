@@ -0,0 +1,90 @@
+#include "sdp_service_cache.h"
+
+namespace flutter_bluetooth_classic {
+
+SdpServiceCache::SdpServiceCache(size_t capacity, size_t max_queued)
+    : capacity_(capacity > 0 ? capacity : 1), max_queued_(max_queued) {}
+
+bool SdpServiceCache::Lookup(BdAddr address, Choice* choice) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(address);
+  if (it == entries_.end()) {
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  *choice = it->second.choice;
+  return true;
+}
+
+void SdpServiceCache::Record(BdAddr address, Choice choice) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(address);
+  if (it != entries_.end()) {
+    it->second.choice = choice;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return;
+  }
+  while (entries_.size() >= capacity_ && !lru_.empty()) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+  lru_.push_front(address);
+  entries_.emplace(address, Entry{choice, lru_.begin()});
+}
+
+void SdpServiceCache::Forget(BdAddr address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(address);
+  if (it != entries_.end()) {
+    lru_.erase(it->second.lru);
+    entries_.erase(it);
+  }
+}
+
+void SdpServiceCache::CountLookup(bool hit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (hit) {
+    ++stats_.hits;
+  } else {
+    ++stats_.misses;
+  }
+}
+
+void SdpServiceCache::CountWarmup() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++stats_.warmups;
+}
+
+SdpServiceCache::Stats SdpServiceCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+bool SdpServiceCache::QueueWarmup(BdAddr address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.count(address) > 0 || queued_.count(address) > 0 ||
+      warmup_queue_.size() >= max_queued_) {
+    return false;
+  }
+  warmup_queue_.push_back(address);
+  queued_.insert(address);
+  if (warming_) {
+    return false;
+  }
+  warming_ = true;
+  return true;
+}
+
+bool SdpServiceCache::NextWarmup(BdAddr* address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (warmup_queue_.empty()) {
+    warming_ = false;
+    return false;
+  }
+  *address = warmup_queue_.front();
+  warmup_queue_.pop_front();
+  queued_.erase(*address);
+  return true;
+}
+
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,77 @@
+#ifndef FLUTTER_PLUGIN_SDP_SERVICE_CACHE_H_
+#define FLUTTER_PLUGIN_SDP_SERVICE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "bluetooth_address.h"
+
+namespace flutter_bluetooth_classic {
+
+// Which RFCOMM service each device was last reached on, so a WinRT connect
+// can pick it from the system's cached SDP records instead of querying the
+// device over the air. Also keeps the queue of devices to look up in the
+// background before anyone connects. Thread-safe.
+class SdpServiceCache {
+ public:
+  // The service that worked: the Serial Port service, or the one at
+  // fallback_index of the device's list when it has none.
+  struct Choice {
+    bool serial_port = true;
+    uint32_t fallback_index = 0;
+  };
+
+  // One lookup per WinRT connect: a hit found an entry here and connected
+  // on it straight from cached SDP records; anything else is a miss.
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t warmups = 0;
+  };
+
+  // Keeps at most capacity devices (least recently used go first) and
+  // queues at most max_queued warm-ups.
+  SdpServiceCache(size_t capacity, size_t max_queued);
+
+  bool Lookup(BdAddr address, Choice* choice);
+  void Record(BdAddr address, Choice choice);
+  void Forget(BdAddr address);
+
+  void CountLookup(bool hit);
+  void CountWarmup();
+  Stats stats() const;
+
+  // Queues address unless it is known, already queued or the queue is
+  // full. True when no warm-up is running and the caller should start one;
+  // that worker then drains the queue with NextWarmup.
+  bool QueueWarmup(BdAddr address);
+  // False once the queue is empty; the worker stops and the next
+  // QueueWarmup starts a new one.
+  bool NextWarmup(BdAddr* address);
+
+ private:
+  struct Entry {
+    Choice choice;
+    std::list<BdAddr>::iterator lru;
+  };
+
+  size_t capacity_;
+  size_t max_queued_;
+  mutable std::mutex mutex_;
+  // Most recently used first
+  std::list<BdAddr> lru_;
+  std::unordered_map<BdAddr, Entry, BdAddrHash> entries_;
+  std::deque<BdAddr> warmup_queue_;
+  std::unordered_set<BdAddr, BdAddrHash> queued_;
+  bool warming_ = false;
+  Stats stats_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_SDP_SERVICE_CACHE_H_
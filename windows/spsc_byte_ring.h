@@ -0,0 +1,163 @@
+#ifndef FLUTTER_PLUGIN_SPSC_BYTE_RING_H_
+#define FLUTTER_PLUGIN_SPSC_BYTE_RING_H_
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace flutter_bluetooth_classic {
+
+// Fixed-capacity single-producer/single-consumer byte queue.
+//
+// One thread calls TryWrite, one other thread calls Peek/Consume; neither
+// takes a lock. Indices grow monotonically and are masked into a
+// power-of-two buffer, and the producer and consumer state live on separate
+// cache lines so the two sides do not false-share.
+//
+// With count_writes, the ring also keeps one bit per byte marking where each
+// TryWrite payload ended, so Consume can report how many whole payloads it
+// released (for batching stats) without a second queue.
+class SpscByteRing {
+ public:
+  struct Span {
+    const uint8_t* data;
+    size_t size;
+  };
+
+  explicit SpscByteRing(size_t min_capacity, bool count_writes = false)
+      : capacity_(RoundUpToPowerOfTwo(min_capacity)),
+        mask_(capacity_ - 1),
+        buffer_(new uint8_t[capacity_]) {
+    if (count_writes) {
+      write_ends_words_ = (capacity_ + kBitsPerWord - 1) / kBitsPerWord;
+      write_ends_.reset(new std::atomic<uint64_t>[write_ends_words_]);
+      for (size_t i = 0; i < write_ends_words_; ++i) {
+        write_ends_[i].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  SpscByteRing(const SpscByteRing&) = delete;
+  SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+  size_t capacity() const { return capacity_; }
+
+  // Producer side. Copies all of data or nothing.
+  bool TryWrite(const uint8_t* data, size_t size) {
+    const size_t head = producer_.head.load(std::memory_order_relaxed);
+    if (capacity_ - (head - producer_.cached_tail) < size) {
+      producer_.cached_tail = consumer_.tail.load(std::memory_order_acquire);
+      if (capacity_ - (head - producer_.cached_tail) < size) {
+        return false;
+      }
+    }
+
+    const size_t offset = head & mask_;
+    const size_t first = size < capacity_ - offset ? size : capacity_ - offset;
+    std::memcpy(buffer_.get() + offset, data, first);
+    std::memcpy(buffer_.get(), data + first, size - first);
+    if (write_ends_ && size > 0) {
+      const size_t last = (head + size - 1) & mask_;
+      write_ends_[last / kBitsPerWord].fetch_or(uint64_t{1} << (last % kBitsPerWord),
+                                                std::memory_order_relaxed);
+    }
+    producer_.head.store(head + size, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side. Returns the readable bytes up to the end of the buffer;
+  // data past the wrap point is returned by the next Peek after Consume.
+  Span Peek() {
+    const size_t tail = consumer_.tail.load(std::memory_order_relaxed);
+    const size_t offset = tail & mask_;
+    const size_t contiguous = capacity_ - offset;
+    size_t available = consumer_.cached_head - tail;
+    // More than capacity means the cached head is stale behind tail, which
+    // happens when bytes are consumed without a Peek that saw them.
+    if (available < contiguous || available > capacity_) {
+      consumer_.cached_head = producer_.head.load(std::memory_order_acquire);
+      available = consumer_.cached_head - tail;
+    }
+    return Span{buffer_.get() + offset, available < contiguous ? available : contiguous};
+  }
+
+  // Consumer side. Releases bytes previously returned by Peek. Returns how
+  // many payloads ended inside them, or 0 without count_writes.
+  size_t Consume(size_t size) {
+    const size_t tail = consumer_.tail.load(std::memory_order_relaxed);
+    const size_t ended = write_ends_ ? TakeWriteEnds(tail, size) : 0;
+    consumer_.tail.store(tail + size, std::memory_order_release);
+    return ended;
+  }
+
+  // Safe from either side; exact only on the side that is not racing.
+  size_t Size() const {
+    const size_t tail = consumer_.tail.load(std::memory_order_acquire);
+    const size_t head = producer_.head.load(std::memory_order_acquire);
+    return head - tail;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+ private:
+  static constexpr size_t kCacheLineSize = 64;
+  static constexpr size_t kBitsPerWord = 64;
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t capacity = 1;
+    while (capacity < value) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  // Counts and clears the end marks of [begin, begin + size). The producer
+  // only sets bits outside that range, but may share the word.
+  size_t TakeWriteEnds(size_t begin, size_t size) {
+    size_t ended = 0;
+    while (size > 0) {
+      const size_t offset = begin & mask_;
+      const size_t bit = offset % kBitsPerWord;
+      size_t count = kBitsPerWord - bit;
+      if (count > capacity_ - offset) {
+        count = capacity_ - offset;
+      }
+      if (count > size) {
+        count = size;
+      }
+      const uint64_t bits =
+          (count == kBitsPerWord ? ~uint64_t{0} : (uint64_t{1} << count) - 1) << bit;
+      const uint64_t old =
+          write_ends_[offset / kBitsPerWord].fetch_and(~bits, std::memory_order_relaxed);
+      ended += static_cast<size_t>(std::popcount(old & bits));
+      begin += count;
+      size -= count;
+    }
+    return ended;
+  }
+
+  struct alignas(kCacheLineSize) ProducerState {
+    std::atomic<size_t> head{0};
+    size_t cached_tail = 0;
+  };
+
+  struct alignas(kCacheLineSize) ConsumerState {
+    std::atomic<size_t> tail{0};
+    size_t cached_head = 0;
+  };
+
+  ProducerState producer_;
+  ConsumerState consumer_;
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<uint8_t[]> buffer_;
+  std::unique_ptr<std::atomic<uint64_t>[]> write_ends_;
+  size_t write_ends_words_ = 0;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_SPSC_BYTE_RING_H_
@@ -0,0 +1,285 @@
+#include "async_task.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+
+// Runs task to completion from the calling thread and waits for the result.
+template <typename T>
+T RunTask(Task<T> task) {
+  std::promise<T> done;
+  std::future<T> result = done.get_future();
+  Spawn(std::move(task), [&done](std::future<T> finished) {
+    try {
+      if constexpr (std::is_void_v<T>) {
+        finished.get();
+        done.set_value();
+      } else {
+        done.set_value(finished.get());
+      }
+    } catch (...) {
+      done.set_exception(std::current_exception());
+    }
+  });
+  return result.get();
+}
+
+Task<std::thread::id> ThreadAfterHop(WorkerPool* workers) {
+  co_await ResumeOn(workers);
+  co_return std::this_thread::get_id();
+}
+
+Task<int> Add(WorkerPool* workers, int a, int b) {
+  co_await ResumeOn(workers);
+  co_return a + b;
+}
+
+Task<int> Sum(WorkerPool* workers, int count) {
+  int total = 0;
+  for (int i = 0; i < count; ++i) {
+    auto step = Add(workers, total, i);
+    total = co_await std::move(step);
+  }
+  co_return total;
+}
+
+Task<int> Fail(WorkerPool* workers) {
+  co_await ResumeOn(workers);
+  throw std::runtime_error("boom");
+}
+
+TEST(WorkerPoolTest, PostRunsOnAWorker) {
+  WorkerPool workers(2);
+  std::promise<bool> on_worker;
+  workers.Post([&]() { on_worker.set_value(workers.IsWorkerThread()); });
+  EXPECT_TRUE(on_worker.get_future().get());
+  EXPECT_FALSE(workers.IsWorkerThread());
+}
+
+TEST(WorkerPoolTest, TimersFireInDeadlineOrder) {
+  WorkerPool workers(1);
+  std::mutex mutex;
+  std::vector<int> order;
+  std::promise<void> done;
+  workers.PostAfter(30ms, [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(2);
+    done.set_value();
+  });
+  workers.PostAfter(10ms, [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(1);
+  });
+  done.get_future().wait();
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+}
+
+TEST(WorkerPoolTest, ShutdownFinishesQueuedJobsAndRejectsLaterPosts) {
+  auto workers = std::make_unique<WorkerPool>(2);
+  std::atomic<int> ran{0};
+  for (int i = 0; i < 100; ++i) {
+    workers->Post([&ran]() {
+      std::this_thread::sleep_for(100us);
+      ++ran;
+    });
+  }
+  workers->Shutdown();
+  EXPECT_EQ(ran.load(), 100);
+
+  auto marker = std::make_shared<int>(0);
+  std::weak_ptr<int> weak_marker = marker;
+  EXPECT_FALSE(workers->Post([marker]() {}));
+  EXPECT_FALSE(workers->PostAfter(1ms, [marker]() {}));
+  marker.reset();
+  // The rejected jobs were destroyed, not kept around
+  EXPECT_TRUE(weak_marker.expired());
+}
+
+// Jobs that keep reposting themselves must not hold shutdown up; every
+// repost made after shutdown started is refused.
+TEST(WorkerPoolTest, ShutdownWhileJobsRepostThemselves) {
+  WorkerPool workers(4);
+  std::atomic<int> runs{0};
+  std::atomic<int> refused{0};
+  std::function<void()> job;
+  job = [&]() {
+    ++runs;
+    if (!workers.Post(job)) {
+      ++refused;
+    }
+  };
+  for (int i = 0; i < 8; ++i) {
+    workers.Post(job);
+  }
+  std::this_thread::sleep_for(20ms);
+  workers.Shutdown();
+
+  EXPECT_GT(runs.load(), 8);
+  // Each of the 8 chains ended with exactly one refused repost
+  EXPECT_EQ(refused.load(), 8);
+}
+
+TEST(AsyncTaskTest, ContinuationResumesOnTheWorkerThatFinished) {
+  WorkerPool workers(2);
+  const std::thread::id finished_on = RunTask(ThreadAfterHop(&workers));
+  EXPECT_NE(finished_on, std::this_thread::get_id());
+}
+
+TEST(AsyncTaskTest, NestedTasksHandOffResults) {
+  WorkerPool workers(3);
+  EXPECT_EQ(RunTask(Sum(&workers, 100)), 4950);
+}
+
+TEST(AsyncTaskTest, ExceptionsReachTheAwaitingTask) {
+  WorkerPool workers(1);
+  auto caught = [](WorkerPool* workers) -> Task<std::string> {
+    try {
+      auto failing = Fail(workers);
+      co_await std::move(failing);
+    } catch (const std::runtime_error& error) {
+      co_return std::string(error.what());
+    }
+    co_return std::string();
+  };
+  EXPECT_EQ(RunTask(caught(&workers)), "boom");
+}
+
+TEST(AsyncTaskTest, ResumeOnAfterShutdownCompletesCancelled) {
+  WorkerPool workers(1);
+  workers.Shutdown();
+  try {
+    RunTask(ThreadAfterHop(&workers));
+    FAIL() << "expected OperationCancelled";
+  } catch (const OperationCancelled& cancelled) {
+    EXPECT_STREQ(cancelled.what(), "SHUTDOWN");
+  }
+}
+
+TEST(AsyncTaskTest, ResumeOnDuringShutdownCompletesCancelled) {
+  // A job that is still running when shutdown starts hops again; the hop
+  // is refused and the task must finish instead of being dropped.
+  auto workers = std::make_unique<WorkerPool>(1);
+  std::promise<std::string> outcome;
+  workers->Post([&]() {
+    while (workers->Post([]() {})) {
+      std::this_thread::sleep_for(100us);
+    }
+    Spawn(ThreadAfterHop(workers.get()), [&outcome](std::future<std::thread::id> finished) {
+      try {
+        finished.get();
+        outcome.set_value("resumed");
+      } catch (const OperationCancelled& cancelled) {
+        outcome.set_value(cancelled.what());
+      }
+    });
+  });
+  std::thread shutdown([&]() { workers->Shutdown(); });
+  auto result = outcome.get_future();
+  ASSERT_EQ(result.wait_for(5s), std::future_status::ready);
+  EXPECT_EQ(result.get(), "SHUTDOWN");
+  shutdown.join();
+}
+
+TEST(CancellationTest, CallbackRunsOnceWhetherRegisteredBeforeOrAfterCancel) {
+  for (int i = 0; i < 2000; ++i) {
+    CancellationSource source;
+    std::atomic<int> calls{0};
+    std::thread canceller([&]() { source.Cancel(); });
+    CancellationRegistration registration = source.token().OnCancel([&]() { ++calls; });
+    canceller.join();
+    EXPECT_EQ(calls.load(), 1) << "iteration " << i;
+  }
+}
+
+TEST(CancellationTest, TimeoutRacingCancelHasOneWinner) {
+  WorkerPool workers(2);
+  for (int i = 0; i < 500; ++i) {
+    CancellationSource source;
+    source.CancelAfter(&workers, 0ms);
+    if (i % 2 == 0) {
+      std::this_thread::sleep_for(50us);
+    }
+    // Either side may win, but the reason must be the winner's
+    const bool cancelled_here = source.Cancel("CANCELLED");
+    EXPECT_EQ(source.token().reason(), cancelled_here ? "CANCELLED" : "TIMEOUT");
+    EXPECT_TRUE(source.token().IsCancelled());
+  }
+}
+
+// A step that completes on a worker while another thread cancels it: the
+// awaiting coroutine is resumed exactly once, by whichever side wins.
+struct RacingStep {
+  WorkerPool* workers;
+  CancellationToken cancel;
+  std::shared_ptr<std::atomic<bool>> resumed = std::make_shared<std::atomic<bool>>(false);
+  CancellationRegistration registration;
+  bool await_ready() const { return false; }
+  void await_suspend(std::coroutine_handle<> handle) {
+    auto resumed_flag = resumed;
+    registration = cancel.OnCancel([handle, resumed_flag]() {
+      if (!resumed_flag->exchange(true)) {
+        handle.resume();
+      }
+    });
+    workers->Post([handle, resumed_flag]() {
+      if (!resumed_flag->exchange(true)) {
+        handle.resume();
+      }
+    });
+  }
+  void await_resume() {
+    registration.Reset();
+    cancel.ThrowIfCancelled();
+  }
+};
+
+Task<int> RacingTask(WorkerPool* workers, CancellationToken cancel) {
+  RacingStep step{workers, cancel, std::make_shared<std::atomic<bool>>(false), {}};
+  co_await step;
+  co_return 1;
+}
+
+TEST(CancellationTest, CancelRacingCompletionFinishesTheTaskOnce) {
+  WorkerPool workers(4);
+  int completed = 0;
+  int cancelled = 0;
+  for (int i = 0; i < 2000; ++i) {
+    CancellationSource source;
+    std::atomic<int> done_calls{0};
+    std::promise<bool> outcome;
+    Spawn(RacingTask(&workers, source.token()), [&](std::future<int> finished) {
+      ++done_calls;
+      try {
+        finished.get();
+        outcome.set_value(true);
+      } catch (const OperationCancelled&) {
+        outcome.set_value(false);
+      }
+    });
+    source.Cancel();
+    if (outcome.get_future().get()) {
+      ++completed;
+    } else {
+      ++cancelled;
+    }
+    EXPECT_EQ(done_calls.load(), 1);
+  }
+  EXPECT_EQ(completed + cancelled, 2000);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,168 @@
+// BdAddr against the stringstream helpers it replaced (see
+// legacy_bluetooth_address.h), for the calls the manager makes per device:
+// normalize a spelling, format an address, parse one for a connect, and
+// look a device up by address among the known ones.
+#include "bluetooth_address.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "legacy_bluetooth_address.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+// Spellings as they come from WinRT ids, the registry and Dart
+std::vector<std::string> Spellings(size_t count) {
+  std::vector<std::string> spellings;
+  std::mt19937_64 random(17);
+  for (size_t i = 0; i < count; ++i) {
+    const std::string formatted = BdAddr(random()).ToString();
+    switch (i % 3) {
+      case 0:
+        spellings.push_back(formatted);
+        break;
+      case 1: {
+        std::string lower = formatted;
+        for (char& c : lower) {
+          c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        spellings.push_back("Bluetooth#Bluetooth00:11:22:33:44:55-" + lower);
+        break;
+      }
+      default: {
+        std::string bare;
+        for (char c : formatted) {
+          if (c != ':') {
+            bare.push_back(c);
+          }
+        }
+        spellings.push_back(bare);
+        break;
+      }
+    }
+  }
+  return spellings;
+}
+
+std::vector<uint64_t> Values(size_t count) {
+  std::vector<uint64_t> values;
+  std::mt19937_64 random(48);
+  for (size_t i = 0; i < count; ++i) {
+    values.push_back(random() & BdAddr::kMask);
+  }
+  return values;
+}
+
+void BM_Normalize_Legacy(benchmark::State& state) {
+  const auto spellings = Spellings(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::NormalizeAddress(spellings[i++ & 1023]));
+  }
+}
+BENCHMARK(BM_Normalize_Legacy);
+
+void BM_Normalize_BdAddr(benchmark::State& state) {
+  const auto spellings = Spellings(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(NormalizeAddress(spellings[i++ & 1023]));
+  }
+}
+BENCHMARK(BM_Normalize_BdAddr);
+
+void BM_Format_Legacy(benchmark::State& state) {
+  const auto values = Values(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::BluetoothAddressToString(values[i++ & 1023]));
+  }
+}
+BENCHMARK(BM_Format_Legacy);
+
+void BM_Format_BdAddrString(benchmark::State& state) {
+  const auto values = Values(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BluetoothAddressToString(values[i++ & 1023]));
+  }
+}
+BENCHMARK(BM_Format_BdAddrString);
+
+// Into a caller's buffer, as the cache encoder does
+void BM_Format_BdAddrBuffer(benchmark::State& state) {
+  const auto values = Values(1024);
+  char buffer[BdAddr::kFormattedLength];
+  size_t i = 0;
+  for (auto _ : state) {
+    BdAddr(values[i++ & 1023]).Format(buffer);
+    benchmark::DoNotOptimize(buffer);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(BM_Format_BdAddrBuffer);
+
+void BM_Parse_Legacy(benchmark::State& state) {
+  const auto spellings = Spellings(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::StringToBluetoothAddress(spellings[i++ & 1023]));
+  }
+}
+BENCHMARK(BM_Parse_Legacy);
+
+void BM_Parse_BdAddr(benchmark::State& state) {
+  const auto spellings = Spellings(1024);
+  size_t i = 0;
+  for (auto _ : state) {
+    BdAddr address;
+    benchmark::DoNotOptimize(BdAddr::TryParse(spellings[i++ & 1023], &address));
+    benchmark::DoNotOptimize(address);
+  }
+}
+BENCHMARK(BM_Parse_BdAddr);
+
+// Finding a device from an incoming spelling among range(0) known ones:
+// normalize and look up a string key, against parse and look up a BdAddr.
+void BM_Lookup_LegacyStringKey(benchmark::State& state) {
+  const auto spellings = Spellings(static_cast<size_t>(state.range(0)));
+  std::map<std::string, size_t> known;
+  for (size_t i = 0; i < spellings.size(); ++i) {
+    known[legacy::NormalizeAddress(spellings[i])] = i;
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    auto it = known.find(legacy::NormalizeAddress(spellings[i++ % spellings.size()]));
+    benchmark::DoNotOptimize(it);
+  }
+}
+BENCHMARK(BM_Lookup_LegacyStringKey)->Arg(16)->Arg(512);
+
+void BM_Lookup_BdAddrKey(benchmark::State& state) {
+  const auto spellings = Spellings(static_cast<size_t>(state.range(0)));
+  std::unordered_map<BdAddr, size_t, BdAddrHash> known;
+  for (size_t i = 0; i < spellings.size(); ++i) {
+    BdAddr address;
+    BdAddr::TryParse(spellings[i], &address);
+    known[address] = i;
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    BdAddr address;
+    BdAddr::TryParse(spellings[i++ % spellings.size()], &address);
+    auto it = known.find(address);
+    benchmark::DoNotOptimize(it);
+  }
+}
+BENCHMARK(BM_Lookup_BdAddrKey)->Arg(16)->Arg(512);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
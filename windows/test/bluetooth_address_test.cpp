@@ -0,0 +1,69 @@
+#include "bluetooth_address.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "legacy_bluetooth_address.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+const std::vector<std::string> kSpellings = {
+    "00:1A:7D:DA:71:13",
+    "00:1a:7d:da:71:13",
+    "001A7DDA7113",
+    "00-1A-7D-DA-71-13",
+    "(00:1a:7d:da:71:13)",
+    "Bluetooth#Bluetooth00:1a:7d:da:71:13",
+    "FF:FF:FF:FF:FF:FF",
+    "00:00:00:00:00:00",
+    "00:1A:7D:DA:71",
+    "00:1A:7D:DA:71:13:00",
+    "not an address",
+    "",
+    "0x001A7DDA7113",
+};
+
+TEST(BdAddrTest, NormalizeMatchesTheStringstreamVersion) {
+  for (const auto& spelling : kSpellings) {
+    EXPECT_EQ(NormalizeAddress(spelling), legacy::NormalizeAddress(spelling)) << spelling;
+  }
+}
+
+TEST(BdAddrTest, ParseMatchesTheStringstreamVersion) {
+  for (const auto& spelling : kSpellings) {
+    BdAddr parsed;
+    const bool ok = BdAddr::TryParse(spelling, &parsed);
+    EXPECT_EQ(ok, !legacy::NormalizeAddress(spelling).empty()) << spelling;
+    if (ok) {
+      EXPECT_EQ(parsed.value(), legacy::StringToBluetoothAddress(spelling)) << spelling;
+    }
+  }
+}
+
+TEST(BdAddrTest, FormatMatchesTheStringstreamVersion) {
+  std::mt19937_64 random(17);
+  for (int i = 0; i < 10000; ++i) {
+    const uint64_t value = random() & BdAddr::kMask;
+    ASSERT_EQ(BluetoothAddressToString(value), legacy::BluetoothAddressToString(value)) << value;
+  }
+  // Bits above 48 are dropped, as the old shifts did
+  EXPECT_EQ(BluetoothAddressToString(0xFFFF001A7DDA7113ull), "00:1A:7D:DA:71:13");
+}
+
+TEST(BdAddrTest, RoundTripsAndOrdersByValue) {
+  constexpr BdAddr a(0x001A7DDA7113ull);
+  static_assert(a.value() == 0x001A7DDA7113ull);
+  BdAddr parsed;
+  ASSERT_TRUE(BdAddr::TryParse(a.ToString(), &parsed));
+  EXPECT_EQ(parsed, a);
+  EXPECT_LT(BdAddr(1), BdAddr(2));
+  EXPECT_NE(BdAddrHash()(BdAddr(0x001A7D000001ull)), BdAddrHash()(BdAddr(0x002A7D000001ull)));
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
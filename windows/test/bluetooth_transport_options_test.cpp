@@ -0,0 +1,39 @@
+#include "bluetooth_transport_options.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+flutter::EncodableMap Args(const char* key, int64_t value) {
+  return flutter::EncodableMap{{flutter::EncodableValue(key), flutter::EncodableValue(value)}};
+}
+
+TEST(TransportOptionsTest, AcceptsASendQueueUpToTheBound) {
+  TransportOptions options;
+  std::string error;
+  ASSERT_TRUE(ApplyTransportOptions(
+      Args("sendQueueMaxBytes", static_cast<int64_t>(kMaxSendQueueBytes)), &options, &error))
+      << error;
+  EXPECT_EQ(options.send_queue_max_bytes, kMaxSendQueueBytes);
+}
+
+TEST(TransportOptionsTest, RejectsASendQueueAboveTheBound) {
+  TransportOptions options;
+  std::string error;
+  EXPECT_FALSE(ApplyTransportOptions(
+      Args("sendQueueMaxBytes", static_cast<int64_t>(kMaxSendQueueBytes) + 1), &options, &error));
+  EXPECT_EQ(error, "sendQueueMaxBytes must be at most " + std::to_string(kMaxSendQueueBytes));
+}
+
+TEST(TransportOptionsTest, RejectsANegativeSendQueue) {
+  TransportOptions options;
+  std::string error;
+  EXPECT_FALSE(ApplyTransportOptions(Args("sendQueueMaxBytes", -1), &options, &error));
+  EXPECT_EQ(error, "sendQueueMaxBytes must be a non-negative integer");
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,147 @@
+#include "connect_history.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+using Path = ConnectHistory::Path;
+
+// Every call takes the time explicitly; this is the fake clock.
+class ConnectHistoryTest : public ::testing::Test {
+ protected:
+  // Same capacity as BluetoothManager uses
+  static constexpr size_t kCapacity = 64;
+
+  ConnectHistory::Clock::time_point At(std::chrono::milliseconds offset) const {
+    return start_ + offset;
+  }
+
+  // Fails path n times in a row, the last one at when.
+  void FailTimes(BdAddr address, Path path, int n, ConnectHistory::Clock::time_point when) {
+    for (int i = 0; i < n; ++i) {
+      history_.RecordFailure(address, path, when);
+    }
+  }
+
+  // Whether path is left out of the race at when (the other path is fine)
+  bool SkipsPath(BdAddr address, Path path, ConnectHistory::Clock::time_point when) const {
+    const ConnectHistory::Plan plan = history_.PlanFor(address, when);
+    return !plan.race && plan.first != path;
+  }
+
+  const ConnectHistory::Clock::time_point start_ =
+      ConnectHistory::Clock::time_point(std::chrono::hours(24 * 365 * 50));
+  const BdAddr device_{0x001A7DDA7113ull};
+  ConnectHistory history_{kCapacity};
+};
+
+TEST_F(ConnectHistoryTest, UnknownDeviceRacesComFirst) {
+  const ConnectHistory::Plan plan = history_.PlanFor(device_, At(0ms));
+  EXPECT_EQ(plan.first, Path::kCom);
+  EXPECT_TRUE(plan.race);
+}
+
+TEST_F(ConnectHistoryTest, ProvenPathLeads) {
+  history_.RecordSuccess(device_, Path::kWinRt, 900ms, At(0ms));
+  ConnectHistory::Plan plan = history_.PlanFor(device_, At(1s));
+  EXPECT_EQ(plan.first, Path::kWinRt);
+  EXPECT_TRUE(plan.race);
+
+  // Both proven: the faster one leads
+  history_.RecordSuccess(device_, Path::kCom, 300ms, At(2s));
+  plan = history_.PlanFor(device_, At(3s));
+  EXPECT_EQ(plan.first, Path::kCom);
+  EXPECT_TRUE(plan.race);
+}
+
+TEST_F(ConnectHistoryTest, OneFailureBacksOffFor30Seconds) {
+  history_.RecordFailure(device_, Path::kCom, At(0ms));
+  EXPECT_TRUE(SkipsPath(device_, Path::kCom, At(0ms)));
+  EXPECT_TRUE(SkipsPath(device_, Path::kCom, At(29999ms)));
+  EXPECT_FALSE(SkipsPath(device_, Path::kCom, At(30s)));
+  EXPECT_TRUE(history_.PlanFor(device_, At(30s)).race);
+}
+
+TEST_F(ConnectHistoryTest, BackoffDoublesWithEveryFailure) {
+  auto backoff = ConnectHistory::kFailureBackoff;
+  for (int failures = 1; failures <= 5; ++failures) {
+    ConnectHistory history(kCapacity);
+    for (int i = 0; i < failures; ++i) {
+      history.RecordFailure(device_, Path::kWinRt, At(0ms));
+    }
+    ConnectHistory::PathStats stats = history.Records()[0].paths[static_cast<int>(Path::kWinRt)];
+    EXPECT_TRUE(ConnectHistory::IsBackingOff(stats, At(backoff - 1ms))) << failures;
+    EXPECT_FALSE(ConnectHistory::IsBackingOff(stats, At(backoff))) << failures;
+    backoff *= 2;
+  }
+}
+
+TEST_F(ConnectHistoryTest, BackoffIsCappedAtTenMinutes) {
+  FailTimes(device_, Path::kCom, 40, At(0ms));
+  EXPECT_TRUE(SkipsPath(device_, Path::kCom, At(10min - 1ms)));
+  EXPECT_FALSE(SkipsPath(device_, Path::kCom, At(10min)));
+}
+
+TEST_F(ConnectHistoryTest, SuccessClearsTheBackoff) {
+  FailTimes(device_, Path::kCom, 3, At(0ms));
+  history_.RecordSuccess(device_, Path::kCom, 200ms, At(1s));
+  EXPECT_FALSE(SkipsPath(device_, Path::kCom, At(2s)));
+  // The next failure starts over at the base backoff
+  history_.RecordFailure(device_, Path::kCom, At(3s));
+  EXPECT_TRUE(SkipsPath(device_, Path::kCom, At(3s + 29s)));
+  EXPECT_FALSE(SkipsPath(device_, Path::kCom, At(3s + 30s)));
+}
+
+TEST_F(ConnectHistoryTest, BothPathsBackingOffStillRaces) {
+  history_.RecordFailure(device_, Path::kCom, At(0ms));
+  history_.RecordFailure(device_, Path::kWinRt, At(0ms));
+  EXPECT_TRUE(history_.PlanFor(device_, At(1s)).race);
+}
+
+TEST_F(ConnectHistoryTest, ClockSetBackEndsTheBackoff) {
+  history_.RecordFailure(device_, Path::kCom, At(10s));
+  EXPECT_FALSE(SkipsPath(device_, Path::kCom, At(5s)));
+}
+
+TEST_F(ConnectHistoryTest, EvictsTheLeastRecentlyUsedPast64) {
+  for (uint64_t i = 0; i < kCapacity; ++i) {
+    history_.RecordSuccess(BdAddr(i + 1), Path::kCom, 100ms, At(std::chrono::seconds(i)));
+  }
+  // Touching device 1 makes device 2 the oldest
+  history_.RecordFailure(BdAddr(1), Path::kWinRt, At(100s));
+  history_.RecordSuccess(BdAddr(1000), Path::kCom, 100ms, At(101s));
+
+  const std::vector<ConnectHistory::Record> records = history_.Records();
+  ASSERT_EQ(records.size(), kCapacity);
+  EXPECT_EQ(records.front().address, BdAddr(1000));
+  EXPECT_EQ(records[1].address, BdAddr(1));
+  for (const auto& record : records) {
+    EXPECT_NE(record.address, BdAddr(2));
+  }
+  // An evicted device has no history left
+  EXPECT_TRUE(history_.PlanFor(BdAddr(2), At(102s)).race);
+}
+
+TEST_F(ConnectHistoryTest, RestoreKeepsOrderAndCapacity) {
+  std::vector<ConnectHistory::Record> saved;
+  for (uint64_t i = 0; i < kCapacity + 10; ++i) {
+    ConnectHistory::Record record;
+    record.address = BdAddr(i + 1);
+    record.paths[0].successes = 1;
+    saved.push_back(record);
+  }
+  saved.push_back(saved.front());
+  history_.Restore(saved);
+  const std::vector<ConnectHistory::Record> records = history_.Records();
+  ASSERT_EQ(records.size(), kCapacity);
+  EXPECT_EQ(records.front().address, BdAddr(1));
+  EXPECT_EQ(records.back().address, BdAddr(kCapacity));
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,404 @@
+#include "connect_race.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "async_task.h"
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+
+// What a fake connect leg produces; ok plays the role of "connected".
+struct FakeLink {
+  bool ok = false;
+  std::string detail;
+};
+
+// A connect attempt the test finishes by hand. Await-style legs (like the
+// WinRT path) also finish early, unconnected, when their token is cancelled.
+class FakeTransport {
+ public:
+  explicit FakeTransport(WorkerPool* workers) : workers_(workers) {}
+
+  // Suspends until Finish or until cancel fires; a cancelled attempt
+  // reports the reason as its detail.
+  Task<FakeLink> Connect(CancellationToken cancel) {
+    started_.set_value();
+    Awaiter awaiter{this, cancel, FakeLink{}, {}};
+    FakeLink link = co_await awaiter;
+    outcome_.set_value(link.detail);
+    co_return link;
+  }
+
+  // Blocks the worker it runs on until Finish, like a COM port open that
+  // cannot be interrupted.
+  Task<FakeLink> ConnectBlocking(CancellationToken) {
+    started_.set_value();
+    FakeLink link = blocking_result_.get_future().get();
+    outcome_.set_value(link.detail);
+    co_return link;
+  }
+
+  // Call at most once.
+  void Finish(bool ok, const std::string& detail) {
+    FakeLink link{ok, detail};
+    blocking_result_.set_value(link);
+    Resume(link);
+  }
+
+  bool WaitStarted(std::chrono::milliseconds timeout) const {
+    return started_future_.wait_for(timeout) == std::future_status::ready;
+  }
+  bool started() const { return WaitStarted(0ms); }
+
+  // What the attempt itself ended with, before the race looked at it.
+  std::string WaitOutcome() const {
+    if (outcome_future_.wait_for(5s) != std::future_status::ready) {
+      return "<still running>";
+    }
+    return outcome_future_.get();
+  }
+
+ private:
+  struct Awaiter {
+    FakeTransport* transport;
+    CancellationToken cancel;
+    FakeLink result;
+    CancellationRegistration registration;
+
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      // Held until the registration is stored: a cancel that fires inline
+      // cannot resume the coroutine under this awaiter's feet.
+      std::lock_guard<std::mutex> lock(transport->mutex_);
+      if (transport->early_result_) {
+        // Finished between started() and here
+        result = *transport->early_result_;
+        return false;
+      }
+      transport->waiter_ = handle;
+      transport->waiter_result_ = &result;
+      FakeTransport* owner = transport;
+      CancellationToken token = cancel;
+      registration = cancel.OnCancel([owner, token]() {
+        owner->workers_->Post([owner, token]() { owner->Resume(FakeLink{false, token.reason()}); });
+      });
+      return true;
+    }
+    FakeLink await_resume() {
+      registration.Reset();
+      return result;
+    }
+  };
+
+  // Hands link to the suspended Connect on a worker, or keeps it for a
+  // Connect that has not suspended yet. Only the first link counts.
+  void Resume(const FakeLink& link) {
+    std::coroutine_handle<> handle;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!waiter_) {
+        if (!early_result_) {
+          early_result_ = link;
+        }
+        return;
+      }
+      handle = std::exchange(waiter_, {});
+      *waiter_result_ = link;
+    }
+    workers_->Post([handle]() { handle.resume(); });
+  }
+
+  WorkerPool* workers_;
+  std::promise<void> started_;
+  std::shared_future<void> started_future_ = started_.get_future().share();
+  std::promise<std::string> outcome_;
+  std::shared_future<std::string> outcome_future_ = outcome_.get_future().share();
+  std::promise<FakeLink> blocking_result_;
+  std::mutex mutex_;
+  std::coroutine_handle<> waiter_;
+  FakeLink* waiter_result_ = nullptr;
+  std::optional<FakeLink> early_result_;
+};
+
+class ConnectRaceTest : public ::testing::Test {
+ protected:
+  // Long enough that a second leg starting early can only be the race
+  // reacting to the first one failing.
+  static constexpr auto kLongStagger = std::chrono::seconds(30);
+
+  using Leg = std::function<Task<FakeLink>(CancellationToken)>;
+
+  static Leg Awaiting(FakeTransport* transport) {
+    return [transport](CancellationToken cancel) { return transport->Connect(cancel); };
+  }
+  static Leg Blocking(FakeTransport* transport) {
+    return [transport](CancellationToken cancel) { return transport->ConnectBlocking(cancel); };
+  }
+
+  std::future<RaceResult<FakeLink>> Start(Leg first, Leg second,
+                                          WorkerPool::Clock::duration stagger,
+                                          CancellationToken cancel = CancellationToken()) {
+    auto done = std::make_shared<std::promise<RaceResult<FakeLink>>>();
+    std::future<RaceResult<FakeLink>> result = done->get_future();
+    Spawn(RaceStaggered<FakeLink>(
+              std::move(first), std::move(second), stagger, &workers_, cancel,
+              [](const FakeLink& link) { return link.ok; },
+              [this](FakeLink late) {
+                std::lock_guard<std::mutex> lock(discard_mutex_);
+                discarded_.push_back(late.detail);
+                discard_cv_.notify_all();
+              }),
+          [done](std::future<RaceResult<FakeLink>> finished) {
+            try {
+              done->set_value(finished.get());
+            } catch (...) {
+              done->set_exception(std::current_exception());
+            }
+          });
+    return result;
+  }
+
+  // The planned path without a race: second only after first failed
+  std::future<RaceResult<FakeLink>> StartFallBack(Leg first, Leg second,
+                                                  CancellationToken cancel = CancellationToken()) {
+    auto done = std::make_shared<std::promise<RaceResult<FakeLink>>>();
+    std::future<RaceResult<FakeLink>> result = done->get_future();
+    Spawn(FallBack<FakeLink>(
+              std::move(first), std::move(second), cancel, [](const FakeLink& link) { return link.ok; }),
+          [done](std::future<RaceResult<FakeLink>> finished) {
+            try {
+              done->set_value(finished.get());
+            } catch (...) {
+              done->set_exception(std::current_exception());
+            }
+          });
+    return result;
+  }
+
+  static RaceResult<FakeLink> Await(std::future<RaceResult<FakeLink>>& race) {
+    EXPECT_EQ(race.wait_for(5s), std::future_status::ready) << "race did not finish";
+    return race.get();
+  }
+
+  bool WaitForDiscards(size_t count) {
+    std::unique_lock<std::mutex> lock(discard_mutex_);
+    return discard_cv_.wait_for(lock, 5s, [&]() { return discarded_.size() >= count; });
+  }
+
+  std::vector<std::string> Discarded() {
+    std::lock_guard<std::mutex> lock(discard_mutex_);
+    return discarded_;
+  }
+
+  // Declared before the pool, so they outlive every job it still runs
+  // while shutting down.
+  std::mutex discard_mutex_;
+  std::condition_variable discard_cv_;
+  std::vector<std::string> discarded_;
+  FakeTransport com_{&workers_};
+  FakeTransport winrt_{&workers_};
+  WorkerPool workers_{4};
+};
+
+TEST_F(ConnectRaceTest, FirstLegWinsBeforeTheStagger) {
+  auto race = Start(Awaiting(&com_), Awaiting(&winrt_), kLongStagger);
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  com_.Finish(true, "com");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, 0);
+  EXPECT_EQ(result.legs[0]->detail, "com");
+  EXPECT_FALSE(winrt_.started());
+}
+
+TEST_F(ConnectRaceTest, FirstLegFailingBeforeTheStaggerStartsTheSecondAtOnce) {
+  auto race = Start(Awaiting(&com_), Awaiting(&winrt_), kLongStagger);
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  EXPECT_FALSE(winrt_.started());
+  com_.Finish(false, "port gone");
+
+  // Nowhere near the 30 s stagger
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  winrt_.Finish(true, "winrt");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, 1);
+  ASSERT_TRUE(result.legs[0]);
+  EXPECT_EQ(result.legs[0]->detail, "port gone");
+  EXPECT_EQ(result.legs[1]->detail, "winrt");
+}
+
+TEST_F(ConnectRaceTest, SecondLegStartsWhenTheStaggerRunsOut) {
+  auto race = Start(Awaiting(&com_), Awaiting(&winrt_), 20ms);
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  winrt_.Finish(true, "winrt");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, 1);
+  // The awaiting loser saw the cancel and failed, so there is nothing to
+  // discard
+  EXPECT_EQ(com_.WaitOutcome(), "LOST_RACE");
+  EXPECT_TRUE(Discarded().empty());
+}
+
+TEST_F(ConnectRaceTest, LoserIsCancelledWithLostRace) {
+  auto race = Start(Awaiting(&com_), Awaiting(&winrt_), 0ms);
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  com_.Finish(true, "com");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, 0);
+  EXPECT_EQ(winrt_.WaitOutcome(), "LOST_RACE");
+  // The loser's own result is not part of the outcome
+  EXPECT_FALSE(result.legs[1]);
+}
+
+TEST_F(ConnectRaceTest, LateWinnerGoesToDiscard) {
+  // COM blocks and cannot see the cancel; WinRT wins meanwhile
+  auto race = Start(Blocking(&com_), Awaiting(&winrt_), 0ms);
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  winrt_.Finish(true, "winrt");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, 1);
+
+  com_.Finish(true, "late com link");
+  ASSERT_TRUE(WaitForDiscards(1));
+  EXPECT_EQ(Discarded(), (std::vector<std::string>{"late com link"}));
+}
+
+TEST_F(ConnectRaceTest, OuterCancelDuringABlockingLegEndsTheRaceAtOnce) {
+  CancellationSource outer;
+  auto race = Start(Blocking(&com_), Awaiting(&winrt_), kLongStagger, outer.token());
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  outer.Cancel("TIMEOUT");
+
+  // Finishes while COM is still stuck
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, -1);
+  EXPECT_FALSE(result.legs[0]);
+
+  // The stuck open succeeding afterwards is torn down, not leaked, and the
+  // second leg never starts
+  com_.Finish(true, "com after timeout");
+  ASSERT_TRUE(WaitForDiscards(1));
+  EXPECT_EQ(Discarded(), (std::vector<std::string>{"com after timeout"}));
+  EXPECT_FALSE(winrt_.started());
+}
+
+TEST_F(ConnectRaceTest, OuterCancelReachesBothAwaitingLegs) {
+  CancellationSource outer;
+  auto race = Start(Awaiting(&com_), Awaiting(&winrt_), 0ms, outer.token());
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  outer.Cancel("CANCELLED");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, -1);
+  // Both legs got the outer reason, not LOST_RACE, and failed
+  EXPECT_EQ(com_.WaitOutcome(), "CANCELLED");
+  EXPECT_EQ(winrt_.WaitOutcome(), "CANCELLED");
+  EXPECT_TRUE(Discarded().empty());
+}
+
+TEST_F(ConnectRaceTest, BothLegsFail) {
+  auto race = Start(Awaiting(&com_), Awaiting(&winrt_), kLongStagger);
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  com_.Finish(false, "com failed");
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  winrt_.Finish(false, "winrt failed");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, -1);
+  ASSERT_TRUE(result.legs[0]);
+  ASSERT_TRUE(result.legs[1]);
+  EXPECT_EQ(result.legs[0]->detail, "com failed");
+  EXPECT_EQ(result.legs[1]->detail, "winrt failed");
+}
+
+TEST_F(ConnectRaceTest, ALegThatThrowsCountsAsFailed) {
+  Leg throwing = [](CancellationToken) -> Task<FakeLink> {
+    throw std::runtime_error("no port");
+    co_return FakeLink{};
+  };
+  auto race = Start(throwing, Awaiting(&winrt_), kLongStagger);
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  winrt_.Finish(true, "winrt");
+
+  RaceResult<FakeLink> result = Await(race);
+  EXPECT_EQ(result.winner, 1);
+  EXPECT_FALSE(result.legs[0]);
+}
+
+TEST_F(ConnectRaceTest, FallBackStopsAtAFirstLegThatConnects) {
+  auto attempts = StartFallBack(Awaiting(&com_), Awaiting(&winrt_));
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  com_.Finish(true, "com");
+
+  RaceResult<FakeLink> result = Await(attempts);
+  EXPECT_EQ(result.winner, 0);
+  EXPECT_EQ(result.legs[0]->detail, "com");
+  EXPECT_FALSE(result.legs[1]);
+  EXPECT_FALSE(winrt_.started());
+}
+
+TEST_F(ConnectRaceTest, FallBackTriesTheSecondLegOnlyAfterTheFirstFails) {
+  auto attempts = StartFallBack(Awaiting(&winrt_), Awaiting(&com_));
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  EXPECT_FALSE(com_.started());
+  winrt_.Finish(false, "winrt failed");
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  com_.Finish(true, "com");
+
+  RaceResult<FakeLink> result = Await(attempts);
+  EXPECT_EQ(result.winner, 1);
+  EXPECT_EQ(result.legs[0]->detail, "winrt failed");
+  EXPECT_EQ(result.legs[1]->detail, "com");
+}
+
+TEST_F(ConnectRaceTest, FallBackReportsBothFailures) {
+  Leg throwing = [](CancellationToken) -> Task<FakeLink> {
+    throw std::runtime_error("no port");
+    co_return FakeLink{};
+  };
+  auto attempts = StartFallBack(throwing, Awaiting(&winrt_));
+  ASSERT_TRUE(winrt_.WaitStarted(5s));
+  winrt_.Finish(false, "winrt failed");
+
+  RaceResult<FakeLink> result = Await(attempts);
+  EXPECT_EQ(result.winner, -1);
+  EXPECT_FALSE(result.legs[0]);
+  EXPECT_EQ(result.legs[1]->detail, "winrt failed");
+}
+
+TEST_F(ConnectRaceTest, FallBackDoesNotStartTheSecondLegOnceCancelled) {
+  CancellationSource outer;
+  auto attempts = StartFallBack(Awaiting(&com_), Awaiting(&winrt_), outer.token());
+  ASSERT_TRUE(com_.WaitStarted(5s));
+  outer.Cancel("TIMEOUT");
+
+  RaceResult<FakeLink> result = Await(attempts);
+  EXPECT_EQ(result.winner, -1);
+  EXPECT_EQ(result.legs[0]->detail, "TIMEOUT");
+  EXPECT_FALSE(result.legs[1]);
+  EXPECT_FALSE(winrt_.started());
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
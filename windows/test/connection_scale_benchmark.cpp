@@ -0,0 +1,258 @@
+// Threads and throughput with 1 to 1000 simulated links, each a pseudo
+// terminal.
+//
+//   Shared: every link is a BluetoothClassicComTransport on one PollReactor
+//     and a WorkerPool of WorkerPool::DefaultThreadCount() threads, as the
+//     plugin runs them.
+//   ThreadPerLink: the layout the pool replaced, a blocking reader thread
+//     and a writer thread with its own queue per link.
+//
+// BM_Receive: every device sends 64 bytes, until all of it is delivered.
+// BM_Send: 64 bytes queued on every link, until every device has them.
+// The threads counter is the process thread count with the links open.
+#include "bluetooth_classic_com_transport.h"
+#include "bluetooth_classic_posix_serial_port.h"
+#include "event_stream_handler.h"
+#include "poll_reactor.h"
+#include "pty.h"
+#include "worker_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+constexpr size_t kMessageSize = 64;
+
+// Counts received bytes and wakes the benchmark thread.
+class Arrivals {
+ public:
+  void Add(size_t bytes) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      received_ += bytes;
+    }
+    cv_.notify_one();
+  }
+
+  void WaitFor(size_t total) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]() { return received_ >= total; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t received_ = 0;
+};
+
+class CountingSink : public flutter::EventSink<flutter::EncodableValue> {
+ public:
+  explicit CountingSink(Arrivals* arrivals) : arrivals_(arrivals) {}
+
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* event) override {
+    if (arrivals_ == nullptr) {
+      return;
+    }
+    const auto& map = std::get<flutter::EncodableMap>(*event);
+    auto it = map.find(flutter::EncodableValue("data"));
+    if (it != map.end()) {
+      arrivals_->Add(std::get<std::vector<uint8_t>>(it->second).size());
+    }
+  }
+  void ErrorInternal(const std::string&, const std::string&, const flutter::EncodableValue*) override {}
+  void EndOfStreamInternal() override {}
+
+ private:
+  Arrivals* arrivals_;
+};
+
+class SharedLinks {
+ public:
+  SharedLinks(size_t count, Arrivals* arrivals) : ptys_(count) {
+    connection_handler_.OnListen(nullptr, std::make_unique<CountingSink>(nullptr));
+    data_handler_.OnListen(nullptr, std::make_unique<CountingSink>(arrivals));
+    for (auto& pty : ptys_) {
+      auto transport = std::make_shared<BluetoothClassicComTransport>(
+          std::make_unique<PosixSerialPort>(pty.slave_path(), &reactor_), "PTY", "00:00:00:00:00:00",
+          0, &workers_, &connection_handler_, &data_handler_);
+      std::string error;
+      transport->Open(&error);
+      transports_.push_back(std::move(transport));
+    }
+  }
+
+  ~SharedLinks() {
+    for (auto& transport : transports_) {
+      transport->Close();
+    }
+  }
+
+  Pty& pty(size_t i) { return ptys_[i]; }
+  void Write(size_t i, const std::vector<uint8_t>& data) { transports_[i]->WriteData(data); }
+
+ private:
+  std::vector<Pty> ptys_;
+  EventStreamHandler<flutter::EncodableValue> connection_handler_;
+  EventStreamHandler<flutter::EncodableValue> data_handler_;
+  WorkerPool workers_{WorkerPool::DefaultThreadCount()};
+  PollReactor reactor_{&workers_};
+  std::vector<std::shared_ptr<BluetoothClassicComTransport>> transports_;
+};
+
+class ThreadPerLinkLinks {
+ public:
+  ThreadPerLinkLinks(size_t count, Arrivals* arrivals) : ptys_(count), links_(count) {
+    for (size_t i = 0; i < count; ++i) {
+      Link& link = links_[i];
+      link.fd = open(ptys_[i].slave_path().c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+      termios settings;
+      tcgetattr(link.fd, &settings);
+      cfmakeraw(&settings);
+      tcsetattr(link.fd, TCSANOW, &settings);
+
+      link.reader = std::thread([this, &link, arrivals]() {
+        uint8_t buffer[4096];
+        while (!stop_) {
+          // Timed so the thread notices stop_
+          pollfd fd{link.fd, POLLIN, 0};
+          if (poll(&fd, 1, 100) <= 0) {
+            continue;
+          }
+          const ssize_t n = read(link.fd, buffer, sizeof(buffer));
+          if (n > 0) {
+            arrivals->Add(static_cast<size_t>(n));
+          }
+        }
+      });
+      link.writer = std::thread([this, &link]() {
+        std::unique_lock<std::mutex> lock(link.mutex);
+        while (true) {
+          link.cv.wait(lock, [&]() { return stop_ || !link.queue.empty(); });
+          if (stop_) {
+            return;
+          }
+          std::vector<uint8_t> data = std::move(link.queue.front());
+          link.queue.pop_front();
+          lock.unlock();
+          [[maybe_unused]] const ssize_t written = write(link.fd, data.data(), data.size());
+          lock.lock();
+        }
+      });
+    }
+  }
+
+  ~ThreadPerLinkLinks() {
+    stop_ = true;
+    for (auto& link : links_) {
+      {
+        std::lock_guard<std::mutex> lock(link.mutex);
+      }
+      link.cv.notify_all();
+      link.reader.join();
+      link.writer.join();
+      close(link.fd);
+    }
+  }
+
+  Pty& pty(size_t i) { return ptys_[i]; }
+  void Write(size_t i, const std::vector<uint8_t>& data) {
+    Link& link = links_[i];
+    {
+      std::lock_guard<std::mutex> lock(link.mutex);
+      link.queue.push_back(data);
+    }
+    link.cv.notify_one();
+  }
+
+ private:
+  struct Link {
+    int fd = -1;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::vector<uint8_t>> queue;
+    std::thread reader;
+    std::thread writer;
+  };
+
+  std::vector<Pty> ptys_;
+  std::vector<Link> links_;
+  std::atomic<bool> stop_{false};
+};
+
+int ProcessThreadCount() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("Threads:", 0) == 0) {
+      return std::stoi(line.substr(8));
+    }
+  }
+  return 0;
+}
+
+template <typename Links>
+void BM_Receive(benchmark::State& state) {
+  const size_t count = static_cast<size_t>(state.range(0));
+  Arrivals arrivals;
+  Links links(count, &arrivals);
+  const std::vector<uint8_t> message(kMessageSize, 0x5a);
+  size_t expected = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      links.pty(i).Write(message);
+    }
+    expected += count * kMessageSize;
+    arrivals.WaitFor(expected);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(expected));
+  state.counters["threads"] = ProcessThreadCount();
+}
+
+template <typename Links>
+void BM_Send(benchmark::State& state) {
+  const size_t count = static_cast<size_t>(state.range(0));
+  Arrivals arrivals;
+  Links links(count, &arrivals);
+  const std::vector<uint8_t> message(kMessageSize, 0xa5);
+  size_t sent = 0;
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      links.Write(i, message);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      benchmark::DoNotOptimize(links.pty(i).Read(kMessageSize));
+    }
+    sent += count * kMessageSize;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(sent));
+  state.counters["threads"] = ProcessThreadCount();
+}
+
+BENCHMARK_TEMPLATE(BM_Receive, SharedLinks)
+    ->RangeMultiplier(10)->Range(1, 1000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_Receive, ThreadPerLinkLinks)
+    ->RangeMultiplier(10)->Range(1, 1000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_Send, SharedLinks)
+    ->RangeMultiplier(10)->Range(1, 1000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_Send, ThreadPerLinkLinks)
+    ->RangeMultiplier(10)->Range(1, 1000)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
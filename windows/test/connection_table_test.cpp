@@ -0,0 +1,127 @@
+#include "connection_table.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+struct FakeEntry {
+  int name = 0;
+  bool connected = true;
+  bool server_peer = false;
+
+  bool IsConnected() const { return connected; }
+};
+
+using Table = ConnectionTable<FakeEntry>;
+
+int64_t Add(Table* table, int name, bool legacy = false, bool server_peer = false) {
+  int64_t connection_id = 0;
+  if (!table->Reserve(&connection_id)) {
+    return 0;
+  }
+  FakeEntry entry;
+  entry.name = name;
+  entry.server_peer = server_peer;
+  table->Commit(connection_id, &entry, legacy);
+  return connection_id;
+}
+
+TEST(ConnectionTableTest, ReservationsCountTowardsTheLimit) {
+  Table table(2);
+  int64_t first = 0;
+  int64_t second = 0;
+  ASSERT_TRUE(table.Reserve(&first));
+  ASSERT_TRUE(table.Reserve(&second));
+  EXPECT_NE(first, second);
+  int64_t third = 0;
+  EXPECT_FALSE(table.Reserve(&third));
+
+  // A failed connect gives its slot back
+  table.Commit(first, nullptr, false);
+  EXPECT_TRUE(table.Reserve(&third));
+  EXPECT_GT(third, second);
+}
+
+TEST(ConnectionTableTest, HandlesAreNeverReused) {
+  Table table(1);
+  const int64_t first = Add(&table, 1);
+  table.Take(first);
+  const int64_t second = Add(&table, 2);
+  EXPECT_NE(second, 0);
+  EXPECT_NE(second, first);
+  FakeEntry entry;
+  EXPECT_FALSE(table.Find(first, &entry));
+}
+
+TEST(ConnectionTableTest, HandleLessLookupsPreferTheLegacyLinkThenTheNewestOpenOne) {
+  Table table(4);
+  Add(&table, 1);
+  const int64_t legacy = Add(&table, 2, true);
+  Add(&table, 3);
+  FakeEntry entry;
+  ASSERT_TRUE(table.Find(0, &entry));
+  EXPECT_EQ(entry.name, 2);
+
+  EXPECT_EQ(table.TakeLegacy().name, 2);
+  EXPECT_FALSE(table.Find(legacy, &entry));
+  ASSERT_TRUE(table.Find(0, &entry));
+  EXPECT_EQ(entry.name, 3);
+  EXPECT_EQ(table.TakeLegacy().name, 0);
+}
+
+TEST(ConnectionTableTest, DroppedLinksStayFindableUntilTheNextReservation) {
+  Table table(2);
+  const int64_t dropped = Add(&table, 1, true);
+  Add(&table, 2);
+  FakeEntry entry;
+  ASSERT_TRUE(table.Find(dropped, &entry));
+  const_cast<FakeEntry&>(table.entries().at(dropped)).connected = false;
+
+  // sendData still sees the row and answers NOT_CONNECTED
+  ASSERT_TRUE(table.Find(dropped, &entry));
+  EXPECT_FALSE(entry.IsConnected());
+  EXPECT_TRUE(table.Full());
+
+  EXPECT_NE(Add(&table, 3), 0);
+  EXPECT_FALSE(table.Find(dropped, &entry));
+  // The legacy link went with it
+  ASSERT_TRUE(table.Find(0, &entry));
+  EXPECT_EQ(entry.name, 3);
+}
+
+TEST(ConnectionTableTest, TakesTheOldestMatchAndEverything) {
+  Table table(8);
+  Add(&table, 1);
+  Add(&table, 2, false, true);
+  Add(&table, 3, false, true);
+  const auto is_peer = [](const FakeEntry& entry) { return entry.server_peer; };
+  EXPECT_EQ(table.Count(is_peer), 2u);
+  EXPECT_EQ(table.TakeOldest(is_peer).name, 2);
+  EXPECT_EQ(table.Count(is_peer), 1u);
+
+  std::vector<FakeEntry> all = table.TakeAll();
+  ASSERT_EQ(all.size(), 2u);
+  EXPECT_EQ(all[0].name, 1);
+  EXPECT_EQ(all[1].name, 3);
+  EXPECT_TRUE(table.entries().empty());
+}
+
+TEST(ConnectionTableTest, LoweringTheLimitKeepsOpenLinks) {
+  Table table(3);
+  Add(&table, 1);
+  Add(&table, 2);
+  table.set_max_connections(1);
+  EXPECT_EQ(table.entries().size(), 2u);
+  EXPECT_EQ(Add(&table, 3), 0);
+  table.TakeOldest([](const FakeEntry&) { return true; });
+  EXPECT_EQ(Add(&table, 3), 0);
+  table.TakeAll();
+  EXPECT_NE(Add(&table, 3), 0);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,170 @@
+// Cost of a received-data event before it reaches Dart: building the
+// payload EncodableValue (one byte vector vs one boxed int per byte) and
+// serializing the event.
+//
+// Against the stub header the serialization is WireEncode below, which
+// writes the StandardMessageCodec layout for the types a data event uses
+// (type tag, size, payload; ints as 4 bytes each), so the per-element work
+// is the same shape as the real codec. Configure with
+// -DFLUTTER_CLIENT_WRAPPER_DIR=<wrapper include dir> to also measure
+// flutter::StandardMessageCodec itself (BM_StandardCodec*).
+#include "bluetooth_transport_options.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef HAVE_FLUTTER_STANDARD_CODEC
+#include <flutter/standard_message_codec.h>
+#endif
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+// Type tags of the standard codec
+enum : uint8_t {
+  kNull = 0,
+  kTrue = 1,
+  kFalse = 2,
+  kInt32 = 3,
+  kInt64 = 4,
+  kString = 7,
+  kUInt8List = 8,
+  kList = 12,
+  kMap = 13,
+};
+
+void WriteSize(size_t size, std::vector<uint8_t>* out) {
+  if (size < 254) {
+    out->push_back(static_cast<uint8_t>(size));
+  } else if (size <= 0xffff) {
+    out->push_back(254);
+    out->push_back(static_cast<uint8_t>(size));
+    out->push_back(static_cast<uint8_t>(size >> 8));
+  } else {
+    out->push_back(255);
+    for (int i = 0; i < 4; ++i) {
+      out->push_back(static_cast<uint8_t>(size >> (8 * i)));
+    }
+  }
+}
+
+void WriteBytes(const void* data, size_t size, std::vector<uint8_t>* out) {
+  const size_t at = out->size();
+  out->resize(at + size);
+  std::memcpy(out->data() + at, data, size);
+}
+
+void WireEncode(const flutter::EncodableValue& value, std::vector<uint8_t>* out) {
+  if (const auto* v = std::get_if<int32_t>(&value)) {
+    out->push_back(kInt32);
+    WriteBytes(v, sizeof(*v), out);
+  } else if (const auto* v = std::get_if<int64_t>(&value)) {
+    out->push_back(kInt64);
+    WriteBytes(v, sizeof(*v), out);
+  } else if (const auto* v = std::get_if<bool>(&value)) {
+    out->push_back(*v ? kTrue : kFalse);
+  } else if (const auto* v = std::get_if<std::string>(&value)) {
+    out->push_back(kString);
+    WriteSize(v->size(), out);
+    WriteBytes(v->data(), v->size(), out);
+  } else if (const auto* v = std::get_if<std::vector<uint8_t>>(&value)) {
+    out->push_back(kUInt8List);
+    WriteSize(v->size(), out);
+    WriteBytes(v->data(), v->size(), out);
+  } else if (const auto* v = std::get_if<flutter::EncodableList>(&value)) {
+    out->push_back(kList);
+    WriteSize(v->size(), out);
+    for (const auto& element : *v) {
+      WireEncode(element, out);
+    }
+  } else if (const auto* v = std::get_if<flutter::EncodableMap>(&value)) {
+    out->push_back(kMap);
+    WriteSize(v->size(), out);
+    for (const auto& entry : *v) {
+      WireEncode(entry.first, out);
+      WireEncode(entry.second, out);
+    }
+  } else {
+    out->push_back(kNull);
+  }
+}
+
+std::vector<uint8_t> Received(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i) {
+    data[i] = static_cast<uint8_t>(i * 31);
+  }
+  return data;
+}
+
+// The event map the transports keep and refill for every read
+flutter::EncodableValue DataEvent(flutter::EncodableValue** data_slot) {
+  flutter::EncodableMap data_map;
+  data_map[flutter::EncodableValue("deviceAddress")] = flutter::EncodableValue("00:1A:7D:DA:71:13");
+  data_map[flutter::EncodableValue("comPort")] = flutter::EncodableValue("COM7");
+  data_map[flutter::EncodableValue("connectionId")] = flutter::EncodableValue(int64_t{1});
+  data_map[flutter::EncodableValue("data")] = flutter::EncodableValue(std::vector<uint8_t>());
+  flutter::EncodableValue event(std::move(data_map));
+  *data_slot = &std::get<flutter::EncodableMap>(event)[flutter::EncodableValue("data")];
+  return event;
+}
+
+// Building the payload value only
+void BM_BuildPayload(benchmark::State& state, DataEventFormat format) {
+  const std::vector<uint8_t> data = Received(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    flutter::EncodableValue payload = EncodeDataPayload(data, format);
+    benchmark::DoNotOptimize(payload);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK_CAPTURE(BM_BuildPayload, bytes, DataEventFormat::kBytes)
+    ->RangeMultiplier(8)->Range(64, 64 << 10);
+BENCHMARK_CAPTURE(BM_BuildPayload, int_list, DataEventFormat::kIntList)
+    ->RangeMultiplier(8)->Range(64, 64 << 10);
+
+// A whole event as the transports send it: fill the reused map, serialize
+void BM_EncodeEvent(benchmark::State& state, DataEventFormat format) {
+  const std::vector<uint8_t> data = Received(static_cast<size_t>(state.range(0)));
+  flutter::EncodableValue* data_slot = nullptr;
+  flutter::EncodableValue event = DataEvent(&data_slot);
+  std::vector<uint8_t> wire;
+  for (auto _ : state) {
+    *data_slot = EncodeDataPayload(data, format);
+    wire.clear();
+    WireEncode(event, &wire);
+    benchmark::DoNotOptimize(wire.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+  state.counters["wire_bytes"] = static_cast<double>(wire.size());
+}
+BENCHMARK_CAPTURE(BM_EncodeEvent, bytes, DataEventFormat::kBytes)
+    ->RangeMultiplier(8)->Range(64, 64 << 10);
+BENCHMARK_CAPTURE(BM_EncodeEvent, int_list, DataEventFormat::kIntList)
+    ->RangeMultiplier(8)->Range(64, 64 << 10);
+
+#ifdef HAVE_FLUTTER_STANDARD_CODEC
+void BM_StandardCodec(benchmark::State& state, DataEventFormat format) {
+  const std::vector<uint8_t> data = Received(static_cast<size_t>(state.range(0)));
+  const flutter::StandardMessageCodec& codec = flutter::StandardMessageCodec::GetInstance();
+  flutter::EncodableValue* data_slot = nullptr;
+  flutter::EncodableValue event = DataEvent(&data_slot);
+  for (auto _ : state) {
+    *data_slot = EncodeDataPayload(data, format);
+    std::unique_ptr<std::vector<uint8_t>> wire = codec.EncodeMessage(event);
+    benchmark::DoNotOptimize(wire->data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK_CAPTURE(BM_StandardCodec, bytes, DataEventFormat::kBytes)
+    ->RangeMultiplier(8)->Range(64, 64 << 10);
+BENCHMARK_CAPTURE(BM_StandardCodec, int_list, DataEventFormat::kIntList)
+    ->RangeMultiplier(8)->Range(64, 64 << 10);
+#endif
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
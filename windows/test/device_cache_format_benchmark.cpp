@@ -0,0 +1,77 @@
+// Cold-start cost of the paired-device cache: loading and decoding the saved
+// file, which is what the first getPairedDevices waits on instead of a full
+// enumeration. File reads go through the C library here; the plugin maps
+// the file instead.
+#include "device_cache_format.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+std::vector<ClassicDeviceInfo> SampleDevices(size_t count) {
+  std::vector<ClassicDeviceInfo> devices(count);
+  for (size_t i = 0; i < count; ++i) {
+    devices[i].name = "Headset " + std::to_string(i);
+    devices[i].address = BdAddr(0x001A7DDA7100ull + i).ToString();
+    devices[i].device_id = "Bluetooth#Bluetooth00:11:22:33:44:55-" + devices[i].address;
+    devices[i].source = "paired";
+    devices[i].connect_key = devices[i].address;
+    devices[i].paired = true;
+  }
+  return devices;
+}
+
+void BM_EncodeDeviceCache(benchmark::State& state) {
+  const std::vector<ClassicDeviceInfo> devices = SampleDevices(state.range(0));
+  size_t bytes = 0;
+  for (auto _ : state) {
+    std::vector<uint8_t> file = EncodeDeviceCache(devices);
+    bytes = file.size();
+    benchmark::DoNotOptimize(file.data());
+  }
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_EncodeDeviceCache)->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_DecodeDeviceCache(benchmark::State& state) {
+  const std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(state.range(0)));
+  for (auto _ : state) {
+    std::vector<ClassicDeviceInfo> devices;
+    benchmark::DoNotOptimize(DecodeDeviceCache(file.data(), file.size(), &devices));
+  }
+  state.SetBytesProcessed(state.iterations() * file.size());
+}
+BENCHMARK(BM_DecodeDeviceCache)->Arg(16)->Arg(256)->Arg(4096);
+
+// Open, read and decode, as at startup (warm page cache).
+void BM_ColdStartLoad(benchmark::State& state) {
+  const std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(state.range(0)));
+  const std::string path = "device_cache_benchmark_" + std::to_string(state.range(0)) + ".bin";
+  {
+    FILE* out = std::fopen(path.c_str(), "wb");
+    std::fwrite(file.data(), 1, file.size(), out);
+    std::fclose(out);
+  }
+  std::vector<uint8_t> buffer(file.size());
+  for (auto _ : state) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    const size_t read = std::fread(buffer.data(), 1, buffer.size(), in);
+    std::fclose(in);
+    std::vector<ClassicDeviceInfo> devices;
+    if (!DecodeDeviceCache(buffer.data(), read, &devices)) {
+      state.SkipWithError("decode failed");
+      break;
+    }
+    benchmark::DoNotOptimize(devices.data());
+  }
+  std::remove(path.c_str());
+}
+BENCHMARK(BM_ColdStartLoad)->Arg(16)->Arg(256)->Arg(4096);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,200 @@
+#include "device_cache_format.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+std::vector<ClassicDeviceInfo> SampleDevices(size_t count) {
+  std::vector<ClassicDeviceInfo> devices;
+  for (size_t i = 0; i < count; ++i) {
+    ClassicDeviceInfo device;
+    device.name = "Device " + std::to_string(i);
+    device.address = BdAddr(0x001A7DDA7100ull + i).ToString();
+    device.com_port = i % 3 == 0 ? "COM" + std::to_string(3 + i) : "";
+    device.device_id = "Bluetooth#Bluetooth00:11:22:33:44:55-" + device.address;
+    device.source = i % 2 == 0 ? "paired" : "remembered";
+    device.connect_key = device.address;
+    device.paired = i % 2 == 0;
+    device.remembered = i % 2 == 1;
+    devices.push_back(device);
+  }
+  return devices;
+}
+
+std::vector<ConnectHistory::Record> SampleHistory(size_t count) {
+  std::vector<ConnectHistory::Record> records(count);
+  for (size_t i = 0; i < count; ++i) {
+    records[i].address = BdAddr(0x001A7DDA7100ull + i);
+    records[i].paths[0].successes = static_cast<uint32_t>(i);
+    records[i].paths[1].failures = static_cast<uint32_t>(i + 1);
+    records[i].paths[1].last_failure_ms = 1700000000000 + static_cast<int64_t>(i);
+  }
+  return records;
+}
+
+// Standard CRC-32, to forge files whose checksum is right but whose
+// contents are not.
+uint32_t Crc32(const uint8_t* data, size_t size) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k) {
+      crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+
+void Reseal(std::vector<uint8_t>* file) {
+  std::vector<uint8_t> checked(file->begin(), file->begin() + 16);
+  checked.insert(checked.end(), file->begin() + 20, file->end());
+  const uint32_t crc = Crc32(checked.data(), checked.size());
+  for (int i = 0; i < 4; ++i) {
+    (*file)[16 + i] = static_cast<uint8_t>(crc >> (8 * i));
+  }
+}
+
+TEST(DeviceCacheFormatTest, RoundTripsDevices) {
+  const std::vector<ClassicDeviceInfo> devices = SampleDevices(50);
+  const std::vector<uint8_t> file = EncodeDeviceCache(devices);
+  std::vector<ClassicDeviceInfo> decoded;
+  ASSERT_TRUE(DecodeDeviceCache(file.data(), file.size(), &decoded));
+  EXPECT_EQ(decoded, devices);
+}
+
+TEST(DeviceCacheFormatTest, RoundTripsAnEmptyList) {
+  const std::vector<uint8_t> file = EncodeDeviceCache({});
+  std::vector<ClassicDeviceInfo> decoded = SampleDevices(1);
+  ASSERT_TRUE(DecodeDeviceCache(file.data(), file.size(), &decoded));
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(DeviceCacheFormatTest, RoundTripsConnectHistory) {
+  const std::vector<ConnectHistory::Record> records = SampleHistory(20);
+  const std::vector<uint8_t> file = EncodeConnectHistory(records);
+  std::vector<ConnectHistory::Record> decoded;
+  ASSERT_TRUE(DecodeConnectHistory(file.data(), file.size(), &decoded));
+  ASSERT_EQ(decoded.size(), records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(decoded[i].address, records[i].address);
+    EXPECT_EQ(decoded[i].paths[0].successes, records[i].paths[0].successes);
+    EXPECT_EQ(decoded[i].paths[1].failures, records[i].paths[1].failures);
+    EXPECT_EQ(decoded[i].paths[1].last_failure_ms, records[i].paths[1].last_failure_ms);
+  }
+}
+
+TEST(DeviceCacheFormatTest, RejectsNull) {
+  std::vector<ClassicDeviceInfo> decoded;
+  EXPECT_FALSE(DecodeDeviceCache(nullptr, 0, &decoded));
+}
+
+// Every single-bit flip, header included, must be caught and must leave the
+// output untouched.
+TEST(DeviceCacheFormatTest, RejectsEveryBitFlip) {
+  const std::vector<ClassicDeviceInfo> original = SampleDevices(4);
+  const std::vector<uint8_t> file = EncodeDeviceCache(original);
+  const std::vector<ClassicDeviceInfo> sentinel = SampleDevices(1);
+  for (size_t byte = 0; byte < file.size(); ++byte) {
+    for (int bit = 0; bit < 8; ++bit) {
+      std::vector<uint8_t> damaged = file;
+      damaged[byte] ^= static_cast<uint8_t>(1u << bit);
+      std::vector<ClassicDeviceInfo> decoded = sentinel;
+      EXPECT_FALSE(DecodeDeviceCache(damaged.data(), damaged.size(), &decoded))
+          << "byte " << byte << " bit " << bit;
+      EXPECT_EQ(decoded, sentinel);
+    }
+  }
+}
+
+TEST(DeviceCacheFormatTest, RejectsEveryTruncationAndExtension) {
+  const std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(4));
+  std::vector<ClassicDeviceInfo> decoded;
+  for (size_t size = 0; size < file.size(); ++size) {
+    EXPECT_FALSE(DecodeDeviceCache(file.data(), size, &decoded)) << "size " << size;
+  }
+  std::vector<uint8_t> longer = file;
+  longer.push_back(0);
+  EXPECT_FALSE(DecodeDeviceCache(longer.data(), longer.size(), &decoded));
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(DeviceCacheFormatTest, RejectsReservedFieldEvenWithAValidChecksum) {
+  std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(2));
+  file[6] = 1;
+  Reseal(&file);
+  std::vector<ClassicDeviceInfo> decoded;
+  EXPECT_FALSE(DecodeDeviceCache(file.data(), file.size(), &decoded));
+
+  // Sanity check on Reseal: the same forgery without the reserved bit passes
+  file[6] = 0;
+  Reseal(&file);
+  EXPECT_TRUE(DecodeDeviceCache(file.data(), file.size(), &decoded));
+}
+
+TEST(DeviceCacheFormatTest, RejectsRecordsThatDoNotMatchTheCount) {
+  for (const uint32_t count : {0u, 1u, 3u, 0xFFFFFFFFu}) {
+    std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(2));
+    for (int i = 0; i < 4; ++i) {
+      file[8 + i] = static_cast<uint8_t>(count >> (8 * i));
+    }
+    Reseal(&file);
+    std::vector<ClassicDeviceInfo> decoded;
+    EXPECT_FALSE(DecodeDeviceCache(file.data(), file.size(), &decoded)) << "count " << count;
+  }
+}
+
+TEST(DeviceCacheFormatTest, RejectsAnOlderVersionAndTheOtherMagic) {
+  std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(2));
+  file[4] = static_cast<uint8_t>(kDeviceCacheVersion - 1);
+  Reseal(&file);
+  std::vector<ClassicDeviceInfo> devices;
+  EXPECT_FALSE(DecodeDeviceCache(file.data(), file.size(), &devices));
+
+  const std::vector<uint8_t> history = EncodeConnectHistory(SampleHistory(2));
+  EXPECT_FALSE(DecodeDeviceCache(history.data(), history.size(), &devices));
+  std::vector<ConnectHistory::Record> records;
+  const std::vector<uint8_t> cache = EncodeDeviceCache(SampleDevices(2));
+  EXPECT_FALSE(DecodeConnectHistory(cache.data(), cache.size(), &records));
+}
+
+TEST(DeviceCacheFormatTest, ConnectHistoryRejectsEveryBitFlip) {
+  const std::vector<uint8_t> file = EncodeConnectHistory(SampleHistory(2));
+  for (size_t byte = 0; byte < file.size(); ++byte) {
+    std::vector<uint8_t> damaged = file;
+    damaged[byte] ^= 0x10;
+    std::vector<ConnectHistory::Record> decoded;
+    EXPECT_FALSE(DecodeConnectHistory(damaged.data(), damaged.size(), &decoded))
+        << "byte " << byte;
+    EXPECT_TRUE(decoded.empty());
+  }
+}
+
+// Resealed random damage gets past the checksum, so the record parser
+// itself has to stay in bounds (run under ASan) and fail cleanly.
+TEST(DeviceCacheFormatTest, SurvivesResealedRandomDamage) {
+  const std::vector<uint8_t> file = EncodeDeviceCache(SampleDevices(8));
+  std::mt19937 random(1234);
+  std::uniform_int_distribution<size_t> position(20, file.size() - 1);
+  std::uniform_int_distribution<int> value(0, 255);
+  for (int round = 0; round < 5000; ++round) {
+    std::vector<uint8_t> damaged = file;
+    for (int edits = 1 + round % 4; edits > 0; --edits) {
+      damaged[position(random)] = static_cast<uint8_t>(value(random));
+    }
+    Reseal(&damaged);
+    std::vector<ClassicDeviceInfo> decoded;
+    if (DecodeDeviceCache(damaged.data(), damaged.size(), &decoded)) {
+      // Only string bytes changed; the layout must still be intact
+      EXPECT_EQ(decoded.size(), 8u);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,219 @@
+// DeviceTable against the string-keyed map it replaced, with 10k synthetic
+// devices (what a test rig sees over one discovery session).
+//
+// The old layout kept a full ClassicDeviceInfo under each lookup key: the
+// connect key, the normalized address and "COM:" + port. Heap use is
+// counted by a replacement operator new; counters heap_bytes and
+// bytes_per_device.
+#include "device_table.h"
+
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<int64_t> g_heap_bytes{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  g_heap_bytes.fetch_add(static_cast<int64_t>(malloc_usable_size(p)), std::memory_order_relaxed);
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  if (p != nullptr) {
+    g_heap_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(p)), std::memory_order_relaxed);
+    std::free(p);
+  }
+}
+
+void operator delete(void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+constexpr size_t kDevices = 10000;
+
+// Every tenth device is a paired one with a COM port
+std::vector<ClassicDeviceInfo> SyntheticDevices(size_t count) {
+  std::vector<ClassicDeviceInfo> devices;
+  devices.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    ClassicDeviceInfo device;
+    device.name = "Synthetic device " + std::to_string(i);
+    device.address = BdAddr(0x001A7D000000ull + i * 7919).ToString();
+    device.com_port = i % 10 == 0 ? "COM" + std::to_string(3 + i / 10) : "";
+    device.device_id = "Bluetooth#Bluetooth00:11:22:33:44:55-" + device.address;
+    device.source = i % 10 == 0 ? "paired" : "winrt-discovery";
+    device.connect_key = device.address;
+    device.paired = i % 10 == 0;
+    devices.push_back(device);
+  }
+  return devices;
+}
+
+using LegacyMap = std::map<std::string, ClassicDeviceInfo>;
+
+void LegacyInsert(LegacyMap* map, const ClassicDeviceInfo& device) {
+  (*map)[device.connect_key] = device;
+  const std::string address = NormalizeAddress(device.address);
+  if (!address.empty()) {
+    (*map)[address] = device;
+  }
+  if (!device.com_port.empty()) {
+    (*map)["COM:" + NormalizeComPort(device.com_port)] = device;
+  }
+}
+
+const ClassicDeviceInfo* LegacyFind(const LegacyMap& map, const std::string& address_or_port) {
+  const std::string address = NormalizeAddress(address_or_port);
+  auto it = map.find(address.empty() ? "COM:" + NormalizeComPort(address_or_port) : address);
+  return it != map.end() ? &it->second : nullptr;
+}
+
+void ReportHeap(benchmark::State& state, int64_t bytes) {
+  state.counters["heap_bytes"] = static_cast<double>(bytes);
+  state.counters["bytes_per_device"] = static_cast<double>(bytes) / kDevices;
+}
+
+// Building the structure; heap measured once it is complete. Reserved is
+// how PairedDeviceIndex builds each snapshot.
+void BM_Build_LegacyMap(benchmark::State& state) {
+  const auto devices = SyntheticDevices(kDevices);
+  int64_t heap = 0;
+  for (auto _ : state) {
+    const int64_t before = g_heap_bytes.load();
+    LegacyMap map;
+    for (const auto& device : devices) {
+      LegacyInsert(&map, device);
+    }
+    heap = g_heap_bytes.load() - before;
+    benchmark::DoNotOptimize(map);
+  }
+  ReportHeap(state, heap);
+}
+BENCHMARK(BM_Build_LegacyMap)->Unit(benchmark::kMillisecond);
+
+void BM_Build_Table(benchmark::State& state, bool reserve) {
+  const auto devices = SyntheticDevices(kDevices);
+  int64_t heap = 0;
+  for (auto _ : state) {
+    const int64_t before = g_heap_bytes.load();
+    DeviceTable table;
+    if (reserve) {
+      table.Reserve(devices.size());
+    }
+    for (const auto& device : devices) {
+      table.Upsert(device);
+    }
+    heap = g_heap_bytes.load() - before;
+    benchmark::DoNotOptimize(table);
+  }
+  ReportHeap(state, heap);
+}
+BENCHMARK_CAPTURE(BM_Build_Table, reserved, true)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Build_Table, grown, false)->Unit(benchmark::kMillisecond);
+
+// Lookups of known addresses in the lower-case spelling Dart may send
+std::vector<std::string> LookupKeys(const std::vector<ClassicDeviceInfo>& devices) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < devices.size(); i += 7) {
+    std::string key = devices[i].address;
+    for (char& c : key) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+void BM_Find_LegacyMap(benchmark::State& state) {
+  const auto devices = SyntheticDevices(kDevices);
+  LegacyMap map;
+  for (const auto& device : devices) {
+    LegacyInsert(&map, device);
+  }
+  const auto keys = LookupKeys(devices);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(LegacyFind(map, keys[i++ % keys.size()]));
+  }
+}
+BENCHMARK(BM_Find_LegacyMap);
+
+void BM_Find_TableByString(benchmark::State& state) {
+  const auto devices = SyntheticDevices(kDevices);
+  DeviceTable table;
+  for (const auto& device : devices) {
+    table.Upsert(device);
+  }
+  const auto keys = LookupKeys(devices);
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.Find(keys[i++ % keys.size()]));
+  }
+}
+BENCHMARK(BM_Find_TableByString);
+
+void BM_Find_TableByAddress(benchmark::State& state) {
+  const auto devices = SyntheticDevices(kDevices);
+  DeviceTable table;
+  std::vector<BdAddr> addresses;
+  for (size_t i = 0; i < devices.size(); ++i) {
+    table.Upsert(devices[i]);
+    if (i % 7 == 0) {
+      BdAddr address;
+      BdAddr::TryParse(devices[i].address, &address);
+      addresses.push_back(address);
+    }
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.FindByAddress(addresses[i++ % addresses.size()]));
+  }
+}
+BENCHMARK(BM_Find_TableByAddress);
+
+void BM_Find_TableByDeviceId(benchmark::State& state) {
+  const auto devices = SyntheticDevices(kDevices);
+  DeviceTable table;
+  for (const auto& device : devices) {
+    table.Upsert(device);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.FindByDeviceId(devices[(i++ * 7) % devices.size()].device_id));
+  }
+}
+BENCHMARK(BM_Find_TableByDeviceId);
+
+void BM_Find_TableByComPort(benchmark::State& state) {
+  const auto devices = SyntheticDevices(kDevices);
+  DeviceTable table;
+  for (const auto& device : devices) {
+    table.Upsert(device);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(table.FindByComPort("COM" + std::to_string(3 + i++ % (kDevices / 10))));
+  }
+}
+BENCHMARK(BM_Find_TableByComPort);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,129 @@
+#include "device_table.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <string>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+ClassicDeviceInfo Device(uint64_t n, const std::string& com_port = "") {
+  ClassicDeviceInfo device;
+  device.name = "Device " + std::to_string(n);
+  device.address = BdAddr(0x001A7DDA0000ull + n).ToString();
+  device.com_port = com_port;
+  device.device_id = "Bluetooth#Bluetooth00:11:22:33:44:55-" + device.address;
+  device.connect_key = device.address;
+  return device;
+}
+
+ClassicDeviceInfo PortOnly(const std::string& com_port) {
+  ClassicDeviceInfo device;
+  device.name = "Port " + com_port;
+  device.com_port = com_port;
+  device.connect_key = "COM:" + com_port;
+  return device;
+}
+
+TEST(DeviceTableTest, FindsByEveryKey) {
+  DeviceTable table;
+  table.Upsert(Device(1, "COM7"));
+  table.Upsert(PortOnly("COM9"));
+  ASSERT_EQ(table.size(), 2u);
+
+  const ClassicDeviceInfo* device = table.FindByAddress(BdAddr(0x001A7DDA0001ull));
+  ASSERT_NE(device, nullptr);
+  EXPECT_EQ(device->name, "Device 1");
+  EXPECT_EQ(table.Find("00:1a:7d:da:00:01"), device);
+  EXPECT_EQ(table.FindByComPort("\\\\.\\com7"), device);
+  EXPECT_EQ(table.FindByDeviceId(Device(1).device_id), device);
+  EXPECT_EQ(table.Find("COM:COM9")->name, "Port COM9");
+  EXPECT_EQ(table.Find("COM3"), nullptr);
+  EXPECT_EQ(table.FindByDeviceId("unknown"), nullptr);
+}
+
+TEST(DeviceTableTest, UpsertReplacesTheSameAddressOrPortOnlyDevice) {
+  DeviceTable table;
+  table.Upsert(Device(1, "COM7"));
+  ClassicDeviceInfo renamed = Device(1, "COM8");
+  renamed.name = "Renamed";
+  EXPECT_EQ(table.Upsert(renamed), 0u);
+  EXPECT_EQ(table.size(), 1u);
+  EXPECT_EQ(table.FindByComPort("COM7"), nullptr);
+  EXPECT_EQ(table.FindByComPort("COM8")->name, "Renamed");
+
+  table.Upsert(PortOnly("COM9"));
+  ClassicDeviceInfo port = PortOnly("com9");
+  port.name = "Again";
+  table.Upsert(port);
+  EXPECT_EQ(table.size(), 2u);
+  EXPECT_EQ(table.FindByComPort("COM9")->name, "Again");
+}
+
+TEST(DeviceTableTest, AnAddressedDeviceDoesNotReplaceAPortOnlyOne) {
+  DeviceTable table;
+  table.Upsert(PortOnly("COM7"));
+  table.Upsert(Device(1, "COM7"));
+  EXPECT_EQ(table.size(), 2u);
+  // The port points at the later device
+  EXPECT_EQ(table.FindByComPort("COM7")->name, "Device 1");
+}
+
+TEST(DeviceTableTest, EraseMovesTheLastEntryAndKeepsItFindable) {
+  DeviceTable table;
+  for (uint64_t n = 0; n < 4; ++n) {
+    table.Upsert(Device(n, "COM" + std::to_string(n + 3)));
+  }
+  EXPECT_TRUE(table.EraseAt(1));
+  EXPECT_FALSE(table.EraseAt(3));
+  EXPECT_EQ(table.size(), 3u);
+  EXPECT_EQ(table.devices()[1].name, "Device 3");
+  EXPECT_EQ(table.FindByAddress(BdAddr(0x001A7DDA0003ull)), &table.devices()[1]);
+  EXPECT_EQ(table.FindByComPort("COM6"), &table.devices()[1]);
+  EXPECT_EQ(table.FindByDeviceId(Device(3).device_id), &table.devices()[1]);
+  EXPECT_EQ(table.FindByAddress(BdAddr(0x001A7DDA0001ull)), nullptr);
+  EXPECT_EQ(table.FindByComPort("COM4"), nullptr);
+}
+
+// Random upserts and erases against a map keyed the same way; every index
+// must agree with the storage after each step.
+TEST(DeviceTableTest, IndicesStayConsistentUnderChurn) {
+  DeviceTable table;
+  std::map<uint64_t, std::string> expected;  // address -> name
+  std::mt19937 random(18);
+  for (int step = 0; step < 20000; ++step) {
+    const uint64_t n = random() % 300;
+    if (random() % 3 == 0) {
+      const ClassicDeviceInfo* device = table.FindByAddress(BdAddr(0x001A7DDA0000ull + n));
+      if (device != nullptr) {
+        ASSERT_TRUE(table.EraseAt(static_cast<size_t>(device - table.devices().data())));
+      }
+      expected.erase(n);
+    } else {
+      ClassicDeviceInfo device = Device(n, "COM" + std::to_string(random() % 50));
+      device.name += "/" + std::to_string(step);
+      table.Upsert(device);
+      expected[n] = device.name;
+    }
+    ASSERT_EQ(table.size(), expected.size());
+  }
+
+  for (const auto& [n, name] : expected) {
+    const ClassicDeviceInfo* device = table.FindByAddress(BdAddr(0x001A7DDA0000ull + n));
+    ASSERT_NE(device, nullptr);
+    EXPECT_EQ(device->name, name);
+    EXPECT_EQ(table.FindByDeviceId(device->device_id), device);
+  }
+  for (int port = 0; port < 50; ++port) {
+    // A shared port points at the latest device given it, if still present
+    const std::string name = "COM" + std::to_string(port);
+    if (const ClassicDeviceInfo* by_port = table.FindByComPort(name)) {
+      EXPECT_EQ(by_port->com_port, name);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
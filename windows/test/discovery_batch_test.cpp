@@ -0,0 +1,94 @@
+#include "discovery_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+ClassicDeviceInfo Device(uint64_t n, const std::string& name = "") {
+  ClassicDeviceInfo device;
+  device.address = BdAddr(0x001A7DDA0000ull + n).ToString();
+  device.name = name.empty() ? "Device " + std::to_string(n) : name;
+  device.source = "winrt-discovery";
+  return device;
+}
+
+BdAddr Address(uint64_t n) { return BdAddr(0x001A7DDA0000ull + n); }
+
+std::vector<std::string> Names(const std::vector<ClassicDeviceInfo>& devices) {
+  std::vector<std::string> names;
+  for (const auto& device : devices) {
+    names.push_back(device.name);
+  }
+  return names;
+}
+
+TEST(DiscoveryBatchTest, ARepeatedAddressReplacesItsPendingEntry) {
+  DiscoveryBatch batch;
+  batch.Add(Device(1));
+  batch.Add(Device(2));
+  batch.Add(Device(1, "Renamed"));
+
+  const std::vector<ClassicDeviceInfo> devices = batch.Take();
+  EXPECT_EQ(Names(devices), (std::vector<std::string>{"Renamed", "Device 2"}));
+  EXPECT_TRUE(batch.empty());
+  EXPECT_FALSE(batch.Contains(Address(1)));
+}
+
+TEST(DiscoveryBatchTest, DiscardKeepsFirstSeenOrder) {
+  DiscoveryBatch batch;
+  for (uint64_t n = 1; n <= 4; ++n) {
+    batch.Add(Device(n));
+  }
+  EXPECT_TRUE(batch.Discard(Address(2)));
+  EXPECT_FALSE(batch.Discard(Address(2)));
+  EXPECT_FALSE(batch.Contains(Address(2)));
+
+  // Later entries moved up one slot; a repeat must still land on its own
+  batch.Add(Device(4, "Renamed 4"));
+  batch.Add(Device(3, "Renamed 3"));
+  EXPECT_EQ(Names(batch.Take()),
+            (std::vector<std::string>{"Device 1", "Renamed 3", "Renamed 4"}));
+}
+
+TEST(DiscoveryBatchTest, AddReportsFullExactlyAtMaxDevices) {
+  DiscoveryBatch batch(3);
+  EXPECT_FALSE(batch.Add(Device(1)));
+  EXPECT_FALSE(batch.Add(Device(2)));
+  // A replacement does not grow the batch
+  EXPECT_FALSE(batch.Add(Device(2, "Again")));
+  EXPECT_TRUE(batch.Add(Device(3)));
+
+  batch.Take();
+  EXPECT_FALSE(batch.Add(Device(4)));
+}
+
+TEST(DiscoveryBatchTest, NoSizeLimitWhenMaxDevicesIsZero) {
+  DiscoveryBatch batch(0);
+  for (uint64_t n = 0; n < 1000; ++n) {
+    EXPECT_FALSE(batch.Add(Device(n)));
+  }
+  EXPECT_EQ(batch.Take().size(), 1000u);
+}
+
+TEST(DiscoveryBatchTest, UnparseableAddressesAreKeptButNotIndexed) {
+  DiscoveryBatch batch;
+  ClassicDeviceInfo unnamed;
+  unnamed.address = "not an address";
+  unnamed.name = "First";
+  batch.Add(unnamed);
+  unnamed.name = "Second";
+  batch.Add(unnamed);
+  batch.Add(Device(1));
+
+  // Neither copy replaced the other, and discarding an indexed entry
+  // leaves them where they are
+  EXPECT_TRUE(batch.Discard(Address(1)));
+  EXPECT_EQ(Names(batch.Take()), (std::vector<std::string>{"First", "Second"}));
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
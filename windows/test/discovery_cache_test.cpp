@@ -0,0 +1,195 @@
+#include "discovery_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+using Change = DiscoveryCache::Change;
+
+// Every call takes the time explicitly; this is the fake clock.
+class DiscoveryCacheTest : public ::testing::Test {
+ protected:
+  // Same policy as BluetoothManager uses
+  static constexpr size_t kCapacity = 512;
+  static constexpr std::chrono::seconds kMaxAge{120};
+  static constexpr std::chrono::seconds kSweepInterval{15};
+
+  DiscoveryCache::Clock::time_point At(std::chrono::milliseconds offset) const {
+    return start_ + offset;
+  }
+
+  static ClassicDeviceInfo Device(uint64_t n) {
+    ClassicDeviceInfo device;
+    device.address = BdAddr(0x001A7DDA0000ull + n).ToString();
+    device.name = "Device " + std::to_string(n);
+    device.device_id = "Bluetooth#Bluetooth00:11:22:33:44:55-" + device.address;
+    device.source = "winrt-discovery";
+    device.connect_key = device.address;
+    return device;
+  }
+
+  Change Add(uint64_t n, std::chrono::milliseconds when,
+             std::vector<ClassicDeviceInfo>* evicted = nullptr) {
+    return cache_.Upsert(Device(n), At(when), evicted);
+  }
+
+  bool Has(uint64_t n) const {
+    return cache_.FindByAddress(BdAddr(0x001A7DDA0000ull + n)) != nullptr;
+  }
+
+  static std::vector<std::string> Names(const std::vector<ClassicDeviceInfo>& devices) {
+    std::vector<std::string> names;
+    for (const auto& device : devices) {
+      names.push_back(device.name);
+    }
+    return names;
+  }
+
+  const DiscoveryCache::Clock::time_point start_ =
+      DiscoveryCache::Clock::time_point(std::chrono::hours(24));
+  DiscoveryCache cache_{kCapacity, kMaxAge};
+};
+
+TEST_F(DiscoveryCacheTest, ReportsAddedUpdatedAndUnchanged) {
+  EXPECT_EQ(Add(1, 0ms), Change::kAdded);
+  EXPECT_EQ(Add(1, 1s), Change::kUnchanged);
+  ClassicDeviceInfo renamed = Device(1);
+  renamed.name = "Renamed";
+  EXPECT_EQ(cache_.Upsert(renamed, At(2s), nullptr), Change::kUpdated);
+  EXPECT_EQ(cache_.size(), 1u);
+}
+
+TEST_F(DiscoveryCacheTest, IgnoresDevicesWithoutAnAddress) {
+  ClassicDeviceInfo device = Device(1);
+  device.address = "not an address";
+  EXPECT_EQ(cache_.Upsert(device, At(0ms), nullptr), Change::kUnchanged);
+  EXPECT_EQ(cache_.size(), 0u);
+}
+
+TEST_F(DiscoveryCacheTest, AgesOutAfter120Seconds) {
+  Add(1, 0ms);
+  EXPECT_TRUE(cache_.Expire(At(kMaxAge - 1ms)).empty());
+  EXPECT_TRUE(Has(1));
+  EXPECT_EQ(Names(cache_.Expire(At(kMaxAge))), (std::vector<std::string>{"Device 1"}));
+  EXPECT_FALSE(Has(1));
+  EXPECT_EQ(cache_.size(), 0u);
+}
+
+TEST_F(DiscoveryCacheTest, EverySightingRestartsTheAge) {
+  Add(1, 0ms);
+  Add(1, 100s);  // Seen again, unchanged
+  EXPECT_TRUE(cache_.Expire(At(150s)).empty());
+
+  // A watcher update counts too
+  EXPECT_NE(cache_.Update(Device(1).device_id, std::string("Renamed"), std::nullopt, At(200s)),
+            nullptr);
+  EXPECT_TRUE(cache_.Expire(At(200s + kMaxAge - 1ms)).empty());
+  EXPECT_EQ(cache_.Expire(At(200s + kMaxAge)).size(), 1u);
+}
+
+TEST_F(DiscoveryCacheTest, ExpireReturnsTheOldestFirstAndKeepsTheRest) {
+  Add(1, 0ms);
+  Add(2, 10s);
+  Add(3, 20s);
+  Add(4, 60s);
+  EXPECT_EQ(Names(cache_.Expire(At(140s))),
+            (std::vector<std::string>{"Device 1", "Device 2", "Device 3"}));
+  EXPECT_TRUE(Has(4));
+}
+
+// Drives Expire the way BluetoothManager's sweep does: every 15 s. A device
+// disappears on the first sweep at least 120 s after it was last seen, so
+// never early and never more than one interval late.
+TEST_F(DiscoveryCacheTest, FifteenSecondSweepDropsDevicesWithinOneInterval) {
+  std::vector<std::chrono::milliseconds> last_seen;
+  for (uint64_t n = 0; n < 40; ++n) {
+    // Spread over several sweep intervals, off the sweep grid
+    last_seen.push_back(std::chrono::milliseconds(n * 1700 + 3));
+    Add(n, last_seen.back());
+  }
+
+  std::vector<std::chrono::milliseconds> dropped_at(last_seen.size(), -1ms);
+  for (auto sweep = kSweepInterval; sweep <= 10min; sweep += kSweepInterval) {
+    for (const auto& device : cache_.Expire(At(sweep))) {
+      BdAddr address;
+      ASSERT_TRUE(BdAddr::TryParse(device.address, &address));
+      dropped_at[address.value() - 0x001A7DDA0000ull] = sweep;
+    }
+  }
+
+  EXPECT_EQ(cache_.size(), 0u);
+  for (size_t n = 0; n < last_seen.size(); ++n) {
+    ASSERT_GE(dropped_at[n], 0ms) << "device " << n;
+    EXPECT_GE(dropped_at[n] - last_seen[n], kMaxAge) << "device " << n;
+    EXPECT_LT(dropped_at[n] - last_seen[n], kMaxAge + kSweepInterval) << "device " << n;
+  }
+}
+
+TEST_F(DiscoveryCacheTest, EvictsTheLeastRecentlySeenPast512) {
+  for (uint64_t n = 0; n < kCapacity; ++n) {
+    EXPECT_EQ(Add(n, std::chrono::milliseconds(n)), Change::kAdded);
+  }
+  // Seeing device 0 again makes device 1 the oldest
+  Add(0, 1000s);
+
+  std::vector<ClassicDeviceInfo> evicted;
+  EXPECT_EQ(Add(kCapacity, 1001s, &evicted), Change::kAdded);
+  EXPECT_EQ(Names(evicted), (std::vector<std::string>{"Device 1"}));
+  EXPECT_EQ(cache_.size(), kCapacity);
+  EXPECT_TRUE(Has(0));
+  EXPECT_FALSE(Has(1));
+  EXPECT_TRUE(Has(kCapacity));
+}
+
+TEST_F(DiscoveryCacheTest, StaysAt512UnderABurst) {
+  std::vector<ClassicDeviceInfo> evicted;
+  for (uint64_t n = 0; n < 2000; ++n) {
+    Add(n, std::chrono::milliseconds(n), &evicted);
+    ASSERT_LE(cache_.size(), kCapacity);
+  }
+  EXPECT_EQ(cache_.size(), kCapacity);
+  ASSERT_EQ(evicted.size(), 2000 - kCapacity);
+  // Evicted in the order they were seen; the newest 512 remain
+  EXPECT_EQ(evicted.front().name, "Device 0");
+  EXPECT_EQ(evicted.back().name, "Device " + std::to_string(2000 - kCapacity - 1));
+  EXPECT_FALSE(Has(2000 - kCapacity - 1));
+  EXPECT_TRUE(Has(2000 - kCapacity));
+  EXPECT_TRUE(Has(1999));
+}
+
+TEST_F(DiscoveryCacheTest, EvictedAndRemovedDevicesNoLongerAge) {
+  Add(1, 0ms);
+  Add(2, 1s);
+  ClassicDeviceInfo removed;
+  ASSERT_TRUE(cache_.Remove(Device(1).device_id, &removed));
+  EXPECT_EQ(removed.name, "Device 1");
+  EXPECT_FALSE(cache_.Remove(Device(1).device_id, &removed));
+  EXPECT_EQ(Names(cache_.Expire(At(10min))), (std::vector<std::string>{"Device 2"}));
+}
+
+TEST_F(DiscoveryCacheTest, UpdateOfAnUnknownOrUnchangedDeviceReportsNothing) {
+  EXPECT_EQ(cache_.Update("unknown", std::string("Name"), true, At(0ms)), nullptr);
+  Add(1, 0ms);
+  EXPECT_EQ(cache_.Update(Device(1).device_id, Device(1).name, false, At(1s)), nullptr);
+  const ClassicDeviceInfo* updated = cache_.Update(Device(1).device_id, std::nullopt, true, At(2s));
+  ASSERT_NE(updated, nullptr);
+  EXPECT_TRUE(updated->paired);
+  EXPECT_EQ(updated->name, "Device 1");
+}
+
+TEST_F(DiscoveryCacheTest, ClearForgetsAges) {
+  Add(1, 0ms);
+  cache_.Clear();
+  EXPECT_TRUE(cache_.Expire(At(10min)).empty());
+  EXPECT_EQ(Add(1, 10min), Change::kAdded);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
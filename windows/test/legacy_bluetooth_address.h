@@ -0,0 +1,72 @@
+// The stringstream address helpers BdAddr replaced, kept verbatim so the
+// test can check that outputs match and the benchmark can compare speed.
+#ifndef FLUTTER_PLUGIN_TEST_LEGACY_BLUETOOTH_ADDRESS_H_
+#define FLUTTER_PLUGIN_TEST_LEGACY_BLUETOOTH_ADDRESS_H_
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace flutter_bluetooth_classic {
+namespace legacy {
+
+inline std::string BluetoothAddressToString(uint64_t address) {
+  std::stringstream ss;
+  ss << std::hex << std::setfill('0');
+
+  // Format as XX:XX:XX:XX:XX:XX
+  for (int i = 5; i >= 0; i--) {
+    ss << std::setw(2) << ((address >> (i * 8)) & 0xFF);
+    if (i > 0) ss << ":";
+  }
+
+  std::string result = ss.str();
+  // Convert to uppercase
+  std::transform(result.begin(), result.end(), result.begin(), ::toupper);
+  return result;
+}
+
+inline std::string NormalizeAddress(const std::string& address) {
+  std::string hex_only;
+  hex_only.reserve(address.size());
+  for (char c : address) {
+    if (std::isxdigit(static_cast<unsigned char>(c))) {
+      hex_only.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    }
+  }
+
+  if (hex_only.size() != 12) {
+    return "";
+  }
+
+  std::stringstream formatted;
+  for (size_t i = 0; i < hex_only.size(); ++i) {
+    formatted << hex_only[i];
+    if (i % 2 == 1 && i < hex_only.size() - 1) {
+      formatted << ":";
+    }
+  }
+  return formatted.str();
+}
+
+// Was BluetoothManager::StringToBluetoothAddress
+inline uint64_t StringToBluetoothAddress(const std::string& address) {
+  uint64_t result = 0;
+  std::string addr_no_colons = NormalizeAddress(address);
+  addr_no_colons.erase(std::remove(addr_no_colons.begin(), addr_no_colons.end(), ':'), addr_no_colons.end());
+
+  // Parse hex string
+  std::stringstream ss;
+  ss << std::hex << addr_no_colons;
+  ss >> result;
+
+  return result;
+}
+
+}  // namespace legacy
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_TEST_LEGACY_BLUETOOTH_ADDRESS_H_
@@ -0,0 +1,267 @@
+// N links in a ConnectionTable, each a BluetoothClassicComTransport over a
+// pseudo terminal whose far end echoes everything back, all on one
+// PollReactor and the shared WorkerPool as the plugin runs them. Every link
+// sends bytes equal to the low byte of its handle, so a data event carrying
+// another link's bytes counts as misrouted.
+#ifndef FLUTTER_PLUGIN_TEST_LOOPBACK_LINKS_H_
+#define FLUTTER_PLUGIN_TEST_LOOPBACK_LINKS_H_
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bluetooth_classic_com_transport.h"
+#include "bluetooth_classic_posix_serial_port.h"
+#include "connection_table.h"
+#include "event_stream_handler.h"
+#include "poll_reactor.h"
+#include "pty.h"
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+
+// Echoes whatever arrives on the pty masters. Never blocks on one link:
+// what a master cannot take yet waits in that link's backlog, as each
+// device would hold it on its own.
+class EchoDevices {
+ public:
+  explicit EchoDevices(std::vector<Pty>* ptys)
+      : ptys_(ptys), hung_up_(ptys->size(), false), backlog_(ptys->size()) {
+    thread_ = std::thread([this]() { Run(); });
+  }
+
+  ~EchoDevices() {
+    stop_ = true;
+    thread_.join();
+  }
+
+  // Closes the master of link i, which the port sees as a hangup.
+  void HangUp(size_t i) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    (*ptys_)[i].HangUp();
+    hung_up_[i] = true;
+  }
+
+ private:
+  void Run() {
+    std::vector<pollfd> fds;
+    std::vector<size_t> links;
+    uint8_t buffer[4096];
+    while (!stop_) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fds.clear();
+      links.clear();
+      for (size_t i = 0; i < ptys_->size(); ++i) {
+        if (!hung_up_[i]) {
+          const short events = backlog_[i].empty() ? POLLIN : POLLIN | POLLOUT;
+          fds.push_back(pollfd{(*ptys_)[i].master(), events, 0});
+          links.push_back(i);
+        }
+      }
+      if (poll(fds.data(), fds.size(), 10) <= 0) {
+        continue;
+      }
+      for (size_t k = 0; k < fds.size(); ++k) {
+        std::vector<uint8_t>& backlog = backlog_[links[k]];
+        if (fds[k].revents & POLLIN) {
+          const ssize_t n = read(fds[k].fd, buffer, sizeof(buffer));
+          if (n > 0) {
+            backlog.insert(backlog.end(), buffer, buffer + n);
+          }
+        }
+        if (!backlog.empty()) {
+          const ssize_t written = write(fds[k].fd, backlog.data(), backlog.size());
+          if (written > 0) {
+            backlog.erase(backlog.begin(), backlog.begin() + written);
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<Pty>* ptys_;
+  std::mutex mutex_;
+  std::vector<bool> hung_up_;
+  std::vector<std::vector<uint8_t>> backlog_;
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+};
+
+// Bytes each handle got back, from the shared data channel.
+class EchoCounts {
+ public:
+  void Add(int64_t connection_id, const std::vector<uint8_t>& data) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (uint8_t byte : data) {
+        if (byte != static_cast<uint8_t>(connection_id)) {
+          ++misrouted_;
+        }
+      }
+      received_[connection_id] += data.size();
+      total_ += data.size();
+    }
+    cv_.notify_all();
+  }
+
+  bool WaitForTotal(size_t total, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, [&]() { return total_ >= total; });
+  }
+
+  size_t Received(int64_t connection_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = received_.find(connection_id);
+    return it != received_.end() ? it->second : 0;
+  }
+
+  size_t total() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+  }
+
+  size_t misrouted() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return misrouted_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::map<int64_t, size_t> received_;
+  size_t total_ = 0;
+  size_t misrouted_ = 0;
+};
+
+class EchoCountingSink : public flutter::EventSink<flutter::EncodableValue> {
+ public:
+  explicit EchoCountingSink(EchoCounts* counts) : counts_(counts) {}
+
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* event) override {
+    const auto& map = std::get<flutter::EncodableMap>(*event);
+    auto data = map.find(flutter::EncodableValue("data"));
+    auto id = map.find(flutter::EncodableValue("connectionId"));
+    if (data != map.end() && id != map.end()) {
+      counts_->Add(id->second.LongValue(), std::get<std::vector<uint8_t>>(data->second));
+    }
+  }
+  void ErrorInternal(const std::string&, const std::string&, const flutter::EncodableValue*) override {}
+  void EndOfStreamInternal() override {}
+
+ private:
+  EchoCounts* counts_;
+};
+
+class NullEventSink : public flutter::EventSink<flutter::EncodableValue> {
+ protected:
+  void SuccessInternal(const flutter::EncodableValue*) override {}
+  void ErrorInternal(const std::string&, const std::string&, const flutter::EncodableValue*) override {}
+  void EndOfStreamInternal() override {}
+};
+
+class LoopbackLinks {
+ public:
+  struct Entry {
+    std::shared_ptr<BluetoothClassicComTransport> com;
+
+    bool IsConnected() const { return com && com->IsConnected(); }
+    void Close() const {
+      if (com) {
+        com->Close();
+      }
+    }
+  };
+
+  // Opens count links in a table of capacity max_connections (count if 0).
+  explicit LoopbackLinks(size_t count, size_t max_connections = 0)
+      : ptys_(count), echo_(&ptys_), table_(max_connections != 0 ? max_connections : count) {
+    connection_handler_.OnListen(nullptr, std::make_unique<NullEventSink>());
+    data_handler_.OnListen(nullptr, std::make_unique<EchoCountingSink>(&counts_));
+    for (size_t i = 0; i < count; ++i) {
+      handles_.push_back(Open(i));
+    }
+  }
+
+  ~LoopbackLinks() {
+    for (const Entry& entry : table_.TakeAll()) {
+      entry.Close();
+    }
+  }
+
+  // Reserves a slot and opens a transport on pty i; its handle, or 0 when
+  // the table is full.
+  int64_t Open(size_t i) {
+    int64_t connection_id = 0;
+    {
+      std::lock_guard<std::mutex> lock(table_mutex_);
+      if (!table_.Reserve(&connection_id)) {
+        return 0;
+      }
+    }
+    Entry entry;
+    entry.com = std::make_shared<BluetoothClassicComTransport>(
+        std::make_unique<PosixSerialPort>(ptys_[i].slave_path(), &reactor_), "PTY", "00:00:00:00:00:00",
+        connection_id, &workers_, &connection_handler_, &data_handler_);
+    std::string error;
+    const bool opened = entry.com->Open(&error);
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    table_.Commit(connection_id, opened ? &entry : nullptr, false);
+    return opened ? connection_id : 0;
+  }
+
+  // sendData: looks the handle up and queues the bytes. One caller per
+  // handle at a time (the transport's single-producer rule).
+  bool Send(int64_t connection_id, size_t size) {
+    Entry entry;
+    {
+      std::lock_guard<std::mutex> lock(table_mutex_);
+      if (!table_.Find(connection_id, &entry) || !entry.IsConnected()) {
+        return false;
+      }
+    }
+    entry.com->WriteData(std::vector<uint8_t>(size, static_cast<uint8_t>(connection_id)));
+    return true;
+  }
+
+  void Close(int64_t connection_id) {
+    Entry entry;
+    {
+      std::lock_guard<std::mutex> lock(table_mutex_);
+      entry = table_.Take(connection_id);
+    }
+    entry.Close();
+  }
+
+  const std::vector<int64_t>& handles() const { return handles_; }
+  // Unlocked; only while no other thread opens, sends or closes
+  ConnectionTable<Entry>& table() { return table_; }
+  EchoDevices& echo() { return echo_; }
+  EchoCounts& counts() { return counts_; }
+
+ private:
+  std::vector<Pty> ptys_;
+  EchoDevices echo_;
+  EchoCounts counts_;
+  EventStreamHandler<flutter::EncodableValue> connection_handler_;
+  EventStreamHandler<flutter::EncodableValue> data_handler_;
+  WorkerPool workers_{WorkerPool::DefaultThreadCount()};
+  PollReactor reactor_{&workers_};
+  std::mutex table_mutex_;
+  ConnectionTable<Entry> table_;
+  std::vector<int64_t> handles_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_TEST_LOOPBACK_LINKS_H_
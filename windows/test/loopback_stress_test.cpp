@@ -0,0 +1,93 @@
+// Many links at once through a ConnectionTable, over echoing pseudo
+// terminals (loopback_links.h): every handle gets back exactly what it sent
+// and nothing of anyone else's.
+#include "loopback_links.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr size_t kLinks = 8;
+constexpr size_t kMessages = 500;
+constexpr size_t kMessageSize = 64;
+
+TEST(LoopbackStressTest, EveryHandleGetsBackOnlyItsOwnBytes) {
+  LoopbackLinks links(kLinks);
+  for (int64_t handle : links.handles()) {
+    ASSERT_NE(handle, 0);
+  }
+
+  // One sender per link, all at once
+  std::vector<std::thread> senders;
+  for (int64_t handle : links.handles()) {
+    senders.emplace_back([&links, handle]() {
+      for (size_t i = 0; i < kMessages; ++i) {
+        while (true) {
+          try {
+            ASSERT_TRUE(links.Send(handle, kMessageSize));
+            break;
+          } catch (const std::runtime_error&) {
+            // Send queue full: let the writer catch up
+            std::this_thread::sleep_for(1ms);
+          }
+        }
+      }
+    });
+  }
+  for (auto& sender : senders) {
+    sender.join();
+  }
+
+  ASSERT_TRUE(links.counts().WaitForTotal(kLinks * kMessages * kMessageSize, 30s));
+  for (int64_t handle : links.handles()) {
+    EXPECT_EQ(links.counts().Received(handle), kMessages * kMessageSize) << "handle " << handle;
+  }
+  EXPECT_EQ(links.counts().misrouted(), 0u);
+}
+
+TEST(LoopbackStressTest, AFullTableTakesANewLinkOnceOneCloses) {
+  LoopbackLinks links(3, 2);
+  const std::vector<int64_t>& handles = links.handles();
+  ASSERT_NE(handles[0], 0);
+  ASSERT_NE(handles[1], 0);
+  EXPECT_EQ(handles[2], 0);
+
+  links.Close(handles[0]);
+  EXPECT_FALSE(links.Send(handles[0], kMessageSize));
+  const int64_t reopened = links.Open(2);
+  ASSERT_NE(reopened, 0);
+  EXPECT_GT(reopened, handles[1]);
+
+  ASSERT_TRUE(links.Send(reopened, kMessageSize));
+  ASSERT_TRUE(links.counts().WaitForTotal(kMessageSize, 5s));
+  EXPECT_EQ(links.counts().Received(reopened), kMessageSize);
+}
+
+TEST(LoopbackStressTest, ALinkTheDeviceDroppedFreesItsSlot) {
+  LoopbackLinks links(2, 1);
+  const int64_t first = links.handles()[0];
+  ASSERT_NE(first, 0);
+  EXPECT_EQ(links.Open(1), 0);
+
+  links.echo().HangUp(0);
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (links.Send(first, 1) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(5ms);
+  }
+  // Pruned by the next reservation, which then has room
+  const int64_t second = links.Open(1);
+  ASSERT_NE(second, 0);
+  ASSERT_TRUE(links.Send(second, kMessageSize));
+  ASSERT_TRUE(links.counts().WaitForTotal(kMessageSize, 5s));
+  EXPECT_EQ(links.counts().Received(second), kMessageSize);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,205 @@
+// Receive latency and idle CPU of the reactor-driven serial backend against
+// a reader thread that polls the port every millisecond, which is how links
+// were served before the reactor. Both run over pseudo terminals; the
+// benchmark writes on the master side and waits for the data event.
+//
+//   BM_ReceiveLatency/<reader>: one byte from the device to the data event.
+//   BM_IdleCpu/<reader>/<ports>: process CPU time per wall second with that
+//     many open, silent links (counter cpu_ms_per_s).
+#include "bluetooth_classic_com_transport.h"
+#include "bluetooth_classic_posix_serial_port.h"
+#include "event_stream_handler.h"
+#include "poll_reactor.h"
+#include "pty.h"
+#include "worker_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+
+// Counts received bytes and wakes the benchmark thread.
+class Arrivals {
+ public:
+  void Add(size_t bytes) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      received_ += bytes;
+    }
+    cv_.notify_one();
+  }
+
+  void WaitFor(size_t total) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]() { return received_ >= total; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t received_ = 0;
+};
+
+class CountingSink : public flutter::EventSink<flutter::EncodableValue> {
+ public:
+  explicit CountingSink(Arrivals* arrivals) : arrivals_(arrivals) {}
+
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* event) override {
+    const auto& map = std::get<flutter::EncodableMap>(*event);
+    auto it = map.find(flutter::EncodableValue("data"));
+    if (it != map.end()) {
+      arrivals_->Add(std::get<std::vector<uint8_t>>(it->second).size());
+    }
+  }
+  void ErrorInternal(const std::string&, const std::string&, const flutter::EncodableValue*) override {}
+  void EndOfStreamInternal() override {}
+
+ private:
+  Arrivals* arrivals_;
+};
+
+class NullSink : public flutter::EventSink<flutter::EncodableValue> {
+ protected:
+  void SuccessInternal(const flutter::EncodableValue*) override {}
+  void ErrorInternal(const std::string&, const std::string&, const flutter::EncodableValue*) override {}
+  void EndOfStreamInternal() override {}
+};
+
+// N links over ptys, served by the reactor and the shared pool.
+class ReactorLinks {
+ public:
+  ReactorLinks(size_t count, Arrivals* arrivals) : ptys_(count) {
+    connection_handler_.OnListen(nullptr, std::make_unique<NullSink>());
+    data_handler_.OnListen(nullptr, std::make_unique<CountingSink>(arrivals));
+    for (auto& pty : ptys_) {
+      auto transport = std::make_shared<BluetoothClassicComTransport>(
+          std::make_unique<PosixSerialPort>(pty.slave_path(), &reactor_), "PTY", "00:00:00:00:00:00",
+          0, &workers_, &connection_handler_, &data_handler_);
+      std::string error;
+      transport->Open(&error);
+      transports_.push_back(std::move(transport));
+    }
+  }
+
+  ~ReactorLinks() {
+    for (auto& transport : transports_) {
+      transport->Close();
+    }
+  }
+
+  int master(size_t i) const { return ptys_[i].master(); }
+
+ private:
+  std::vector<Pty> ptys_;
+  EventStreamHandler<flutter::EncodableValue> connection_handler_;
+  EventStreamHandler<flutter::EncodableValue> data_handler_;
+  WorkerPool workers_{4};
+  PollReactor reactor_{&workers_};
+  std::vector<std::shared_ptr<BluetoothClassicComTransport>> transports_;
+};
+
+// One thread per link: non-blocking read, sleep 1 ms when there is nothing.
+class PollingLinks {
+ public:
+  PollingLinks(size_t count, Arrivals* arrivals) : ptys_(count) {
+    for (auto& pty : ptys_) {
+      const int fd = open(pty.slave_path().c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+      termios settings;
+      tcgetattr(fd, &settings);
+      cfmakeraw(&settings);
+      tcsetattr(fd, TCSANOW, &settings);
+      fds_.push_back(fd);
+      threads_.emplace_back([this, fd, arrivals]() {
+        uint8_t buffer[4096];
+        while (!stop_) {
+          const ssize_t n = read(fd, buffer, sizeof(buffer));
+          if (n > 0) {
+            arrivals->Add(static_cast<size_t>(n));
+          } else {
+            std::this_thread::sleep_for(1ms);
+          }
+        }
+      });
+    }
+  }
+
+  ~PollingLinks() {
+    stop_ = true;
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    for (int fd : fds_) {
+      close(fd);
+    }
+  }
+
+  int master(size_t i) const { return ptys_[i].master(); }
+
+ private:
+  std::vector<Pty> ptys_;
+  std::vector<int> fds_;
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+double ProcessCpuSeconds() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+         (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+template <typename LinksT>
+void BM_ReceiveLatency(benchmark::State& state) {
+  Arrivals arrivals;
+  LinksT links(1, &arrivals);
+  const uint8_t byte = 0x5a;
+  size_t sent = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(write(links.master(0), &byte, 1));
+    arrivals.WaitFor(++sent);
+  }
+}
+BENCHMARK_TEMPLATE(BM_ReceiveLatency, ReactorLinks)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_ReceiveLatency, PollingLinks)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+template <typename LinksT>
+void BM_IdleCpu(benchmark::State& state) {
+  Arrivals arrivals;
+  LinksT links(static_cast<size_t>(state.range(0)), &arrivals);
+  std::this_thread::sleep_for(50ms);
+  double cpu = 0;
+  double wall = 0;
+  for (auto _ : state) {
+    const double cpu_start = ProcessCpuSeconds();
+    const auto wall_start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(200ms);
+    cpu += ProcessCpuSeconds() - cpu_start;
+    wall += std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  }
+  state.counters["cpu_ms_per_s"] = 1000 * cpu / wall;
+}
+BENCHMARK_TEMPLATE(BM_IdleCpu, ReactorLinks)
+    ->Arg(1)->Arg(16)->Arg(64)->Iterations(5)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_IdleCpu, PollingLinks)
+    ->Arg(1)->Arg(16)->Arg(64)->Iterations(5)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,481 @@
+// PosixSerialPort and BluetoothClassicComTransport against a pseudo
+// terminal: the test holds the master side and plays the remote device.
+#include "bluetooth_classic_com_transport.h"
+#include "bluetooth_classic_posix_serial_port.h"
+#include "event_stream_handler.h"
+#include "poll_reactor.h"
+#include "pty.h"
+#include "worker_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+using WaitResult = SerialPort::WaitResult;
+
+constexpr std::chrono::milliseconds kTimeout = 5s;
+
+std::vector<uint8_t> Pattern(size_t size, uint32_t seed) {
+  std::vector<uint8_t> data(size);
+  std::mt19937 random(seed);
+  for (auto& byte : data) {
+    byte = static_cast<uint8_t>(random());
+  }
+  return data;
+}
+
+// Events one EventStreamHandler delivered, in order.
+class EventLog {
+ public:
+  void Add(const flutter::EncodableValue& event) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      events_.push_back(event);
+    }
+    cv_.notify_all();
+  }
+
+  std::vector<flutter::EncodableValue> Events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+  }
+
+  // Waits until pred holds for the events so far.
+  bool WaitFor(const std::function<bool(const std::vector<flutter::EncodableValue>&)>& pred,
+               std::chrono::milliseconds timeout = kTimeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, [&]() { return pred(events_); });
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<flutter::EncodableValue> events_;
+};
+
+class RecordingSink : public flutter::EventSink<flutter::EncodableValue> {
+ public:
+  explicit RecordingSink(std::shared_ptr<EventLog> log) : log_(std::move(log)) {}
+
+ protected:
+  void SuccessInternal(const flutter::EncodableValue* event) override {
+    log_->Add(event != nullptr ? *event : flutter::EncodableValue());
+  }
+  void ErrorInternal(const std::string&, const std::string&, const flutter::EncodableValue*) override {}
+  void EndOfStreamInternal() override {}
+
+ private:
+  std::shared_ptr<EventLog> log_;
+};
+
+const flutter::EncodableValue* Field(const flutter::EncodableValue& event, const char* key) {
+  const auto* map = std::get_if<flutter::EncodableMap>(&event);
+  if (map == nullptr) {
+    return nullptr;
+  }
+  auto it = map->find(flutter::EncodableValue(key));
+  return it == map->end() ? nullptr : &it->second;
+}
+
+std::string StringField(const flutter::EncodableValue& event, const char* key) {
+  const auto* value = Field(event, key);
+  const auto* string = value != nullptr ? std::get_if<std::string>(value) : nullptr;
+  return string != nullptr ? *string : "";
+}
+
+bool IsConnectionState(const flutter::EncodableValue& event, bool connected) {
+  const auto* value = Field(event, "isConnected");
+  return value != nullptr && std::get<bool>(*value) == connected;
+}
+
+std::vector<uint8_t> ReceivedBytes(const std::vector<flutter::EncodableValue>& events) {
+  std::vector<uint8_t> bytes;
+  for (const auto& event : events) {
+    if (const auto* data = Field(event, "data")) {
+      const auto& chunk = std::get<std::vector<uint8_t>>(*data);
+      bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+    }
+  }
+  return bytes;
+}
+
+int64_t Stat(const flutter::EncodableMap& stats, const char* key) {
+  return stats.at(flutter::EncodableValue(key)).LongValue();
+}
+
+class PosixSerialPortTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(pty_.ok()) << "no pseudo terminal available"; }
+
+  // Waits for the port's next wait result.
+  WaitResult Wait(SerialPort& port) {
+    std::promise<WaitResult> result;
+    port.BeginWaitForData([&result](WaitResult value, const std::string&) { result.set_value(value); });
+    std::future<WaitResult> future = result.get_future();
+    EXPECT_EQ(future.wait_for(kTimeout), std::future_status::ready);
+    return future.get();
+  }
+
+  WorkerPool workers_{2};
+  PollReactor reactor_{&workers_};
+  Pty pty_;
+};
+
+TEST_F(PosixSerialPortTest, OpenFailsForAMissingDevice) {
+  PosixSerialPort port("/dev/does-not-exist", &reactor_);
+  std::string error;
+  EXPECT_FALSE(port.Open(&error));
+  EXPECT_EQ(error.rfind("COM_OPEN_FAILED", 0), 0u) << error;
+}
+
+TEST_F(PosixSerialPortTest, WaitCompletesWhenDataArrives) {
+  PosixSerialPort port(pty_.slave_path(), &reactor_);
+  std::string error;
+  ASSERT_TRUE(port.Open(&error)) << error;
+
+  std::promise<WaitResult> result;
+  port.BeginWaitForData([&result](WaitResult value, const std::string&) { result.set_value(value); });
+  std::future<WaitResult> future = result.get_future();
+  // Nothing to read yet: the wait stays armed
+  EXPECT_EQ(future.wait_for(50ms), std::future_status::timeout);
+
+  pty_.Write({1, 2, 3});
+  ASSERT_EQ(future.wait_for(kTimeout), std::future_status::ready);
+  EXPECT_EQ(future.get(), WaitResult::kDataAvailable);
+
+  uint8_t buffer[16];
+  size_t bytes_read = 0;
+  ASSERT_TRUE(port.Read(buffer, sizeof(buffer), &bytes_read, &error)) << error;
+  EXPECT_EQ(std::vector<uint8_t>(buffer, buffer + bytes_read), (std::vector<uint8_t>{1, 2, 3}));
+  // Drained: the next read returns nothing instead of blocking
+  ASSERT_TRUE(port.Read(buffer, sizeof(buffer), &bytes_read, &error)) << error;
+  EXPECT_EQ(bytes_read, 0u);
+}
+
+TEST_F(PosixSerialPortTest, InputQueuedBeforeTheWaitCompletesItAtOnce) {
+  PosixSerialPort port(pty_.slave_path(), &reactor_);
+  std::string error;
+  ASSERT_TRUE(port.Open(&error)) << error;
+  pty_.Write({42});
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(Wait(port), WaitResult::kDataAvailable);
+}
+
+TEST_F(PosixSerialPortTest, CancelCompletesTheWaitAndLaterWaits) {
+  PosixSerialPort port(pty_.slave_path(), &reactor_);
+  std::string error;
+  ASSERT_TRUE(port.Open(&error)) << error;
+
+  std::promise<WaitResult> result;
+  port.BeginWaitForData([&result](WaitResult value, const std::string&) { result.set_value(value); });
+  port.Cancel();
+  std::future<WaitResult> future = result.get_future();
+  ASSERT_EQ(future.wait_for(kTimeout), std::future_status::ready);
+  EXPECT_EQ(future.get(), WaitResult::kCancelled);
+
+  pty_.Write({1});
+  EXPECT_EQ(Wait(port), WaitResult::kCancelled);
+}
+
+TEST_F(PosixSerialPortTest, HangupFailsTheWaitOrTheRead) {
+  PosixSerialPort port(pty_.slave_path(), &reactor_);
+  std::string error;
+  ASSERT_TRUE(port.Open(&error)) << error;
+  pty_.ReleaseSlave();
+  pty_.HangUp();
+
+  if (Wait(port) == WaitResult::kError) {
+    return;
+  }
+  uint8_t buffer[16];
+  size_t bytes_read = 0;
+  EXPECT_FALSE(port.Read(buffer, sizeof(buffer), &bytes_read, &error));
+  EXPECT_NE(error.find("hung up"), std::string::npos) << error;
+}
+
+TEST_F(PosixSerialPortTest, WriteWaitsForRoomInTheOutputQueue) {
+  PosixSerialPort port(pty_.slave_path(), &reactor_);
+  std::string error;
+  ASSERT_TRUE(port.Open(&error)) << error;
+
+  // Far more than the pty buffers, so Write has to wait for the reader
+  const std::vector<uint8_t> data = Pattern(1 << 20, 7);
+  std::future<std::vector<uint8_t>> received =
+      std::async(std::launch::async, [this, &data]() { return pty_.Read(data.size()); });
+  EXPECT_TRUE(port.Write(data.data(), data.size(), &error)) << error;
+  EXPECT_EQ(received.get(), data);
+}
+
+TEST_F(PosixSerialPortTest, CancelAbortsABlockedWrite) {
+  PosixSerialPort port(pty_.slave_path(), &reactor_);
+  std::string error;
+  ASSERT_TRUE(port.Open(&error)) << error;
+
+  const std::vector<uint8_t> data = Pattern(1 << 20, 8);
+  std::future<bool> written = std::async(std::launch::async, [&]() {
+    return port.Write(data.data(), data.size(), &error);
+  });
+  EXPECT_EQ(written.wait_for(100ms), std::future_status::timeout);
+  port.Cancel();
+  ASSERT_EQ(written.wait_for(kTimeout), std::future_status::ready);
+  EXPECT_FALSE(written.get());
+  EXPECT_EQ(error.rfind("WRITE_ERROR", 0), 0u) << error;
+}
+
+class PosixComTransportTest : public PosixSerialPortTest {
+ protected:
+  PosixComTransportTest() {
+    connection_handler_.OnListen(nullptr, std::make_unique<RecordingSink>(connection_events_));
+    data_handler_.OnListen(nullptr, std::make_unique<RecordingSink>(data_events_));
+  }
+
+  std::shared_ptr<BluetoothClassicComTransport> Connect(
+      const TransportOptions& options = TransportOptions()) {
+    auto transport = std::make_shared<BluetoothClassicComTransport>(
+        std::make_unique<PosixSerialPort>(pty_.slave_path(), &reactor_),
+        "PTY", "00:1A:7D:DA:71:13", 7, &workers_,
+        &connection_handler_, &data_handler_, options);
+    std::string error;
+    EXPECT_TRUE(transport->Open(&error)) << error;
+    return transport;
+  }
+
+  static bool HasEvent(const std::vector<flutter::EncodableValue>& events, const char* name) {
+    for (const auto& event : events) {
+      if (StringField(event, "event") == name) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool WaitForEvent(const char* name) {
+    return connection_events_->WaitFor([name](const auto& events) { return HasEvent(events, name); });
+  }
+
+  bool WaitForDisconnect() {
+    return connection_events_->WaitFor([](const auto& events) {
+      return !events.empty() && IsConnectionState(events.back(), false);
+    });
+  }
+
+  std::shared_ptr<EventLog> connection_events_ = std::make_shared<EventLog>();
+  std::shared_ptr<EventLog> data_events_ = std::make_shared<EventLog>();
+  EventStreamHandler<flutter::EncodableValue> connection_handler_;
+  EventStreamHandler<flutter::EncodableValue> data_handler_;
+};
+
+TEST_F(PosixComTransportTest, OpenAnnouncesTheLink) {
+  auto transport = Connect();
+  EXPECT_TRUE(transport->IsConnected());
+  const auto events = connection_events_->Events();
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_TRUE(IsConnectionState(events[0], true));
+  EXPECT_EQ(StringField(events[0], "status"), "CONNECTED: COM(PTY)");
+  EXPECT_EQ(StringField(events[0], "deviceAddress"), "00:1A:7D:DA:71:13");
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, DeliversReceivedDataInOrder) {
+  auto transport = Connect();
+  const std::vector<uint8_t> sent = Pattern(256 * 1024, 1);
+  std::mt19937 random(2);
+  for (size_t offset = 0; offset < sent.size();) {
+    const size_t chunk = std::min<size_t>(1 + random() % 3000, sent.size() - offset);
+    pty_.Write(std::vector<uint8_t>(sent.begin() + offset, sent.begin() + offset + chunk));
+    offset += chunk;
+  }
+  ASSERT_TRUE(data_events_->WaitFor(
+      [&sent](const auto& events) { return ReceivedBytes(events).size() >= sent.size(); }));
+  EXPECT_EQ(ReceivedBytes(data_events_->Events()), sent);
+
+  const auto event = data_events_->Events().front();
+  EXPECT_EQ(StringField(event, "comPort"), "PTY");
+  EXPECT_EQ(Field(event, "connectionId")->LongValue(), 7);
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, ReadsReuseReceiveBuffersAfterWarmUp) {
+  auto transport = Connect();
+  // One chunk at a time, each delivered before the next is written, so
+  // every read sees the buffers the earlier events gave back.
+  size_t expected = 0;
+  auto push_reads = [&](int count) {
+    for (int i = 0; i < count; ++i) {
+      pty_.Write(Pattern(512, i));
+      expected += 512;
+      ASSERT_TRUE(data_events_->WaitFor(
+          [expected](const auto& events) { return ReceivedBytes(events).size() >= expected; }));
+    }
+  };
+  push_reads(16);
+  const int64_t warmed_up = Stat(transport->GetStats(), "rxBufferAllocations");
+  EXPECT_GT(warmed_up, 0);
+
+  push_reads(200);
+  const flutter::EncodableMap stats = transport->GetStats();
+  EXPECT_EQ(Stat(stats, "rxBufferAllocations"), warmed_up);
+  EXPECT_GE(Stat(stats, "rxEvents"), 216);
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, WriteDataReachesTheDevice) {
+  auto transport = Connect();
+  std::vector<uint8_t> expected;
+  for (uint32_t i = 0; i < 100; ++i) {
+    const std::vector<uint8_t> payload = Pattern(1 + i * 13 % 700, i);
+    transport->WriteData(payload);
+    expected.insert(expected.end(), payload.begin(), payload.end());
+  }
+  EXPECT_EQ(pty_.Read(expected.size()), expected);
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, CoalescesSmallWritesIntoBatches) {
+  TransportOptions options;
+  options.write_coalesce_max_bytes = 4096;
+  options.write_coalesce_latency_us = 20000;
+  auto transport = Connect(options);
+  for (uint32_t i = 0; i < 100; ++i) {
+    transport->WriteData(Pattern(10, i));
+  }
+  EXPECT_EQ(pty_.Read(1000).size(), 1000u);
+  // A batch is counted after its write returns; Close waits for the drain job.
+  transport->Close();
+
+  const flutter::EncodableMap stats = transport->GetStats();
+  EXPECT_EQ(Stat(stats, "writePayloads"), 100);
+  EXPECT_EQ(Stat(stats, "writeBytes"), 1000);
+  EXPECT_LT(Stat(stats, "writeBatches"), 100);
+  EXPECT_GT(Stat(stats, "maxBatchPayloads"), 1);
+}
+
+TEST_F(PosixComTransportTest, SendsAPayloadLargerThanTheQueueOnItsOwn) {
+  TransportOptions options;
+  options.send_queue_max_bytes = 4096;
+  options.send_queue_high_watermark_bytes = 0;
+  auto transport = Connect(options);
+  const std::vector<uint8_t> payload = Pattern(64 * 1024, 3);
+  transport->WriteData(payload);
+  EXPECT_EQ(pty_.Read(payload.size()), payload);
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, RejectsWritesOnceTheQueueIsFull) {
+  TransportOptions options;
+  options.send_queue_max_bytes = 4096;
+  options.send_queue_high_watermark_bytes = 0;
+  auto transport = Connect(options);
+  // Nobody reads the master, so the pty and then the queue fill up
+  bool rejected = false;
+  for (int i = 0; i < 100000 && !rejected; ++i) {
+    try {
+      transport->WriteData(Pattern(1024, i));
+    } catch (const std::runtime_error& e) {
+      EXPECT_STREQ(e.what(), "COM send queue is full");
+      rejected = true;
+    }
+  }
+  EXPECT_TRUE(rejected);
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, ClampsALargeSendQueueToTheRing) {
+  TransportOptions options;
+  options.send_queue_max_bytes = kMaxSendQueueBytes;
+  options.send_queue_high_watermark_bytes = kMaxSendQueueBytes / 2;
+  options.send_queue_low_watermark_bytes = 0;
+  auto transport = Connect(options);
+  // Nobody reads the master: the queue fills at the ring's 1 MiB, well
+  // before the requested budget, and still reports backpressure there
+  size_t sent = 0;
+  bool rejected = false;
+  while (sent < kMaxSendQueueBytes && !rejected) {
+    try {
+      transport->WriteData(Pattern(1024, 0));
+      sent += 1024;
+    } catch (const std::runtime_error& e) {
+      EXPECT_STREQ(e.what(), "COM send queue is full");
+      rejected = true;
+    }
+  }
+  EXPECT_TRUE(rejected);
+  EXPECT_LT(sent, 2u * 1024 * 1024);
+  EXPECT_TRUE(WaitForEvent("backpressure"));
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, ReportsBackpressureAndThenWritable) {
+  TransportOptions options;
+  options.send_queue_max_bytes = 16 * 1024;
+  options.send_queue_high_watermark_bytes = 4096;
+  options.send_queue_low_watermark_bytes = 1024;
+  auto transport = Connect(options);
+
+  size_t sent = 0;
+  for (int i = 0; i < 100000 && !HasEvent(connection_events_->Events(), "backpressure"); ++i) {
+    try {
+      transport->WriteData(Pattern(512, i));
+      sent += 512;
+    } catch (const std::runtime_error&) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+  ASSERT_TRUE(WaitForEvent("backpressure"));
+
+  // Reading on the device side drains the queue below the low watermark
+  EXPECT_EQ(pty_.Read(sent).size(), sent);
+  ASSERT_TRUE(WaitForEvent("writable"));
+  transport->Close();
+}
+
+TEST_F(PosixComTransportTest, CloseReportsDisconnectedOnce) {
+  auto transport = Connect();
+  transport->Close();
+  transport->Close();
+  EXPECT_FALSE(transport->IsConnected());
+  const auto events = connection_events_->Events();
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_TRUE(IsConnectionState(events[1], false));
+  EXPECT_EQ(StringField(events[1], "status"), "DISCONNECTED");
+}
+
+TEST_F(PosixComTransportTest, CloseDoesNotWaitForABlockedWrite) {
+  auto transport = Connect();
+  // Far more than the pty buffers; nobody reads it
+  for (int i = 0; i < 8; ++i) {
+    transport->WriteData(Pattern(64 * 1024, i));
+  }
+  std::this_thread::sleep_for(50ms);
+  auto closed = std::async(std::launch::async, [&transport]() { transport->Close(); });
+  EXPECT_EQ(closed.wait_for(kTimeout), std::future_status::ready);
+}
+
+TEST_F(PosixComTransportTest, DeviceHangupReportsADisconnect) {
+  auto transport = Connect();
+  pty_.ReleaseSlave();
+  pty_.HangUp();
+  ASSERT_TRUE(WaitForDisconnect());
+  EXPECT_FALSE(transport->IsConnected());
+  EXPECT_NE(StringField(connection_events_->Events().back(), "status").find("hung up"),
+            std::string::npos);
+  transport->Close();
+  EXPECT_EQ(connection_events_->Events().size(), 2u);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
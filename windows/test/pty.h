@@ -0,0 +1,104 @@
+// Pseudo terminal for the serial backend tests and benchmarks. The test
+// holds the master side and plays the remote device.
+#ifndef FLUTTER_PLUGIN_TEST_PTY_H_
+#define FLUTTER_PLUGIN_TEST_PTY_H_
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+
+// Master side of a pty; the slave path is what the port opens.
+class Pty {
+ public:
+  Pty() {
+    master_ = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master_ >= 0 && grantpt(master_) == 0 && unlockpt(master_) == 0) {
+      if (const char* name = ptsname(master_)) {
+        slave_path_ = name;
+      }
+    }
+    // Keeps the slave from reporting a hangup until the port has it open
+    if (!slave_path_.empty()) {
+      keep_open_ = open(slave_path_.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    }
+    if (master_ >= 0) {
+      fcntl(master_, F_SETFL, fcntl(master_, F_GETFL) | O_NONBLOCK);
+    }
+  }
+
+  ~Pty() {
+    HangUp();
+    if (keep_open_ >= 0) {
+      close(keep_open_);
+    }
+  }
+
+  Pty(const Pty&) = delete;
+  Pty& operator=(const Pty&) = delete;
+
+  bool ok() const { return master_ >= 0 && keep_open_ >= 0; }
+  int master() const { return master_; }
+  const std::string& slave_path() const { return slave_path_; }
+
+  // Lets the port be the only holder of the slave side.
+  void ReleaseSlave() {
+    close(keep_open_);
+    keep_open_ = -1;
+  }
+
+  void Write(const std::vector<uint8_t>& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+      const ssize_t written = write(master_, data.data() + offset, data.size() - offset);
+      if (written > 0) {
+        offset += static_cast<size_t>(written);
+      } else {
+        pollfd fd{master_, POLLOUT, 0};
+        poll(&fd, 1, 100);
+      }
+    }
+  }
+
+  // Reads until size bytes arrived or timeout elapsed.
+  std::vector<uint8_t> Read(size_t size, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    std::vector<uint8_t> data;
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    uint8_t buffer[4096];
+    while (data.size() < size && std::chrono::steady_clock::now() < deadline) {
+      pollfd fd{master_, POLLIN, 0};
+      if (poll(&fd, 1, 10) <= 0) {
+        continue;
+      }
+      const ssize_t n = read(master_, buffer, std::min(sizeof(buffer), size - data.size()));
+      if (n > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+      }
+    }
+    return data;
+  }
+
+  void HangUp() {
+    if (master_ >= 0) {
+      close(master_);
+      master_ = -1;
+    }
+  }
+
+ private:
+  int master_ = -1;
+  int keep_open_ = -1;
+  std::string slave_path_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_TEST_PTY_H_
@@ -0,0 +1,74 @@
+#include "receive_buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+TEST(ReceiveBufferPoolTest, AcquireAllocatesWhileTheFreeListIsEmpty) {
+  ReceiveBufferPool pool(64, 2);
+  std::vector<uint8_t> first = pool.Acquire();
+  std::vector<uint8_t> second = pool.Acquire();
+  EXPECT_TRUE(first.empty());
+  EXPECT_GE(first.capacity(), 64u);
+  EXPECT_GE(second.capacity(), 64u);
+  EXPECT_EQ(pool.allocations(), 2u);
+}
+
+TEST(ReceiveBufferPoolTest, ReleasedBuffersAreReusedEmpty) {
+  ReceiveBufferPool pool(64, 2);
+  std::vector<uint8_t> buffer = pool.Acquire();
+  buffer.assign(64, 0xAB);
+  const uint8_t* storage = buffer.data();
+  pool.Release(std::move(buffer));
+
+  std::vector<uint8_t> reused = pool.Acquire();
+  EXPECT_EQ(reused.data(), storage);
+  EXPECT_TRUE(reused.empty());
+  EXPECT_EQ(pool.allocations(), 1u);
+}
+
+TEST(ReceiveBufferPoolTest, SteadyAcquireReleaseStopsAllocating) {
+  ReceiveBufferPool pool(64, 2);
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<uint8_t> buffer = pool.Acquire();
+    buffer.resize(32);
+    pool.Release(std::move(buffer));
+  }
+  EXPECT_EQ(pool.allocations(), 1u);
+}
+
+TEST(ReceiveBufferPoolTest, KeepsAtMostMaxPooledBuffers) {
+  ReceiveBufferPool pool(64, 2);
+  std::vector<std::vector<uint8_t>> held;
+  for (int i = 0; i < 4; ++i) {
+    held.push_back(pool.Acquire());
+  }
+  for (auto& buffer : held) {
+    pool.Release(std::move(buffer));
+  }
+  held.clear();
+  ASSERT_EQ(pool.allocations(), 4u);
+
+  // Two came back from the free list; the other two were dropped
+  for (int i = 0; i < 4; ++i) {
+    held.push_back(pool.Acquire());
+  }
+  EXPECT_EQ(pool.allocations(), 6u);
+}
+
+TEST(ReceiveBufferPoolTest, DropsBuffersWithoutEnoughStorage) {
+  ReceiveBufferPool pool(64, 2);
+  std::vector<uint8_t> held = pool.Acquire();
+  pool.Release(std::vector<uint8_t>());  // as a buffer moved into an event
+  pool.Release(std::vector<uint8_t>(8));
+
+  pool.Acquire();
+  EXPECT_EQ(pool.allocations(), 2u);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
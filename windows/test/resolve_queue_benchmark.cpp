@@ -0,0 +1,127 @@
+// Wall time of the paired-device address lookups against a fake resolver.
+//
+// Each of 40 devices takes 5-15 ms to resolve (sum ~400 ms, max 15 ms), and
+// ResolveQueue runs them the way PairedDeviceIndex does: a lookup is started
+// from StartNext outside the lock and reported back through Finish. The
+// fake lookup is a pool timer, given up at the timeout like FromIdAsync.
+//
+//   BM_ResolveAll/<max_active>/<stuck>: with stuck set, one device never
+//   answers and is only dropped at the 100 ms timeout.
+// Counters: sum_ms and max_ms of the injected latencies.
+#include "resolve_queue.h"
+#include "worker_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr size_t kDevices = 40;
+constexpr auto kTimeout = 100ms;
+constexpr auto kNeverAnswers = 1h;
+
+class FakeIndex : public std::enable_shared_from_this<FakeIndex> {
+ public:
+  FakeIndex(WorkerPool* workers, size_t max_active) : workers_(workers), resolves_(max_active) {}
+
+  void Add(const std::string& id, std::chrono::milliseconds latency) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      resolves_.Add(id, latency);
+    }
+    StartQueuedResolves();
+  }
+
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this]() { return resolves_.Idle(); });
+  }
+
+ private:
+  void StartQueuedResolves() {
+    auto self = shared_from_this();
+    for (;;) {
+      std::optional<ResolveQueue<std::chrono::milliseconds>::Started> job;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job = resolves_.StartNext();
+        if (!job) {
+          return;
+        }
+      }
+      const auto latency = std::min<std::chrono::milliseconds>(job->job, kTimeout);
+      workers_->PostAfter(latency, [self, id = job->id, generation = job->generation]() {
+        self->CompleteResolve(id, generation);
+      });
+    }
+  }
+
+  void CompleteResolve(const std::string& id, uint64_t generation) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      resolves_.Finish(id, generation);
+      if (resolves_.Idle()) {
+        idle_cv_.notify_all();
+      }
+    }
+    StartQueuedResolves();
+  }
+
+  WorkerPool* workers_;
+  std::mutex mutex_;
+  std::condition_variable idle_cv_;
+  ResolveQueue<std::chrono::milliseconds> resolves_;
+};
+
+void BM_ResolveAll(benchmark::State& state) {
+  const size_t max_active = static_cast<size_t>(state.range(0));
+  const bool stuck = state.range(1) != 0;
+
+  std::vector<std::chrono::milliseconds> latencies;
+  std::mt19937 random(40);
+  for (size_t i = 0; i < kDevices; ++i) {
+    latencies.push_back(std::chrono::milliseconds(5 + random() % 11));
+  }
+  if (stuck) {
+    latencies[kDevices / 2] = kNeverAnswers;
+  }
+
+  WorkerPool workers(4);
+  for (auto _ : state) {
+    auto index = std::make_shared<FakeIndex>(&workers, max_active);
+    for (size_t i = 0; i < kDevices; ++i) {
+      index->Add("device" + std::to_string(i), latencies[i]);
+    }
+    index->WaitIdle();
+  }
+
+  std::chrono::milliseconds sum{0};
+  std::chrono::milliseconds max{0};
+  for (const auto latency : latencies) {
+    sum += std::min<std::chrono::milliseconds>(latency, kTimeout);
+    max = std::max<std::chrono::milliseconds>(max, std::min<std::chrono::milliseconds>(latency, kTimeout));
+  }
+  state.counters["sum_ms"] = static_cast<double>(sum.count());
+  state.counters["max_ms"] = static_cast<double>(max.count());
+}
+BENCHMARK(BM_ResolveAll)
+    ->ArgNames({"max_active", "stuck"})
+    ->ArgsProduct({{1, 4, 40}, {0, 1}})
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,93 @@
+#include "resolve_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using Queue = ResolveQueue<int>;
+
+std::vector<int> StartAll(Queue* queue) {
+  std::vector<int> jobs;
+  while (std::optional<Queue::Started> started = queue->StartNext()) {
+    jobs.push_back(started->job);
+  }
+  return jobs;
+}
+
+TEST(ResolveQueueTest, StartsAtMostMaxActiveInArrivalOrder) {
+  Queue queue(2);
+  for (int i = 0; i < 5; ++i) {
+    queue.Add("id" + std::to_string(i), i);
+  }
+  EXPECT_EQ(StartAll(&queue), (std::vector<int>{0, 1}));
+  EXPECT_EQ(queue.active(), 2u);
+
+  EXPECT_TRUE(queue.Finish("id0", 1));
+  EXPECT_EQ(StartAll(&queue), (std::vector<int>{2}));
+  EXPECT_TRUE(queue.Finish("id1", 2));
+  EXPECT_TRUE(queue.Finish("id2", 3));
+  EXPECT_EQ(StartAll(&queue), (std::vector<int>{3, 4}));
+  EXPECT_FALSE(queue.Idle());
+  EXPECT_TRUE(queue.Finish("id3", 4));
+  EXPECT_TRUE(queue.Finish("id4", 5));
+  EXPECT_TRUE(queue.Idle());
+  EXPECT_EQ(queue.active(), 0u);
+}
+
+TEST(ResolveQueueTest, SkipsQueuedLookupsThatWereRemoved) {
+  Queue queue(1);
+  queue.Add("a", 1);
+  queue.Add("b", 2);
+  queue.Add("c", 3);
+  std::optional<Queue::Started> a = queue.StartNext();
+  ASSERT_TRUE(a);
+  queue.Remove("b");
+  EXPECT_TRUE(queue.Finish(a->id, a->generation));
+  EXPECT_EQ(StartAll(&queue), (std::vector<int>{3}));
+}
+
+TEST(ResolveQueueTest, ReAddSupersedesARunningLookup) {
+  Queue queue(2);
+  queue.Add("a", 1);
+  std::optional<Queue::Started> first = queue.StartNext();
+  ASSERT_TRUE(first);
+  queue.Add("a", 2);
+  std::optional<Queue::Started> second = queue.StartNext();
+  ASSERT_TRUE(second);
+  EXPECT_EQ(second->job, 2);
+
+  // The first result is stale but still frees its slot
+  EXPECT_FALSE(queue.Finish(first->id, first->generation));
+  EXPECT_EQ(queue.active(), 1u);
+  EXPECT_FALSE(queue.Idle());
+  EXPECT_TRUE(queue.Finish(second->id, second->generation));
+  EXPECT_TRUE(queue.Idle());
+}
+
+TEST(ResolveQueueTest, ReAddWhileQueuedRunsOnlyTheLatest) {
+  Queue queue(1);
+  queue.Add("busy", 0);
+  std::optional<Queue::Started> busy = queue.StartNext();
+  queue.Add("a", 1);
+  queue.Add("a", 2);
+  EXPECT_TRUE(queue.Finish(busy->id, busy->generation));
+  EXPECT_EQ(StartAll(&queue), (std::vector<int>{2}));
+}
+
+TEST(ResolveQueueTest, RemovingARunningLookupMakesTheQueueIdle) {
+  Queue queue(1);
+  queue.Add("a", 1);
+  std::optional<Queue::Started> a = queue.StartNext();
+  queue.Remove("a");
+  EXPECT_TRUE(queue.Idle());
+  EXPECT_FALSE(queue.Finish(a->id, a->generation));
+  EXPECT_EQ(queue.active(), 0u);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,108 @@
+#include "sdp_service_cache.h"
+
+#include <gtest/gtest.h>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+using Choice = SdpServiceCache::Choice;
+
+BdAddr Address(uint64_t n) { return BdAddr(0x001A7DDA0000ull + n); }
+
+Choice Fallback(uint32_t index) { return Choice{false, index}; }
+
+TEST(SdpServiceCacheTest, LookupReturnsTheRecordedChoice) {
+  SdpServiceCache cache(4, 4);
+  Choice choice;
+  EXPECT_FALSE(cache.Lookup(Address(1), &choice));
+
+  cache.Record(Address(1), Fallback(2));
+  ASSERT_TRUE(cache.Lookup(Address(1), &choice));
+  EXPECT_FALSE(choice.serial_port);
+  EXPECT_EQ(choice.fallback_index, 2u);
+
+  cache.Record(Address(1), Choice{true, 0});
+  ASSERT_TRUE(cache.Lookup(Address(1), &choice));
+  EXPECT_TRUE(choice.serial_port);
+}
+
+TEST(SdpServiceCacheTest, EvictsTheLeastRecentlyUsedAtCapacity) {
+  SdpServiceCache cache(3, 4);
+  for (uint64_t n = 1; n <= 3; ++n) {
+    cache.Record(Address(n), Fallback(static_cast<uint32_t>(n)));
+  }
+  // A lookup counts as a use: 2 is now the oldest
+  Choice choice;
+  ASSERT_TRUE(cache.Lookup(Address(1), &choice));
+  cache.Record(Address(4), Fallback(4));
+
+  EXPECT_FALSE(cache.Lookup(Address(2), &choice));
+  EXPECT_TRUE(cache.Lookup(Address(1), &choice));
+  EXPECT_TRUE(cache.Lookup(Address(3), &choice));
+  EXPECT_TRUE(cache.Lookup(Address(4), &choice));
+}
+
+TEST(SdpServiceCacheTest, ForgetDropsTheEntry) {
+  SdpServiceCache cache(3, 4);
+  cache.Record(Address(1), Fallback(1));
+  cache.Record(Address(2), Fallback(2));
+  cache.Forget(Address(1));
+  cache.Forget(Address(9));
+
+  Choice choice;
+  EXPECT_FALSE(cache.Lookup(Address(1), &choice));
+  EXPECT_TRUE(cache.Lookup(Address(2), &choice));
+  // The freed slot is reused without evicting anyone
+  cache.Record(Address(3), Fallback(3));
+  cache.Record(Address(4), Fallback(4));
+  EXPECT_TRUE(cache.Lookup(Address(2), &choice));
+}
+
+TEST(SdpServiceCacheTest, OnlyTheFirstQueuedWarmupStartsAWorker) {
+  SdpServiceCache cache(4, 4);
+  EXPECT_TRUE(cache.QueueWarmup(Address(1)));
+  EXPECT_FALSE(cache.QueueWarmup(Address(2)));
+  EXPECT_FALSE(cache.QueueWarmup(Address(1)));
+
+  BdAddr next;
+  ASSERT_TRUE(cache.NextWarmup(&next));
+  EXPECT_EQ(next, Address(1));
+  // Still draining: a new address joins the running worker
+  EXPECT_FALSE(cache.QueueWarmup(Address(3)));
+  ASSERT_TRUE(cache.NextWarmup(&next));
+  EXPECT_EQ(next, Address(2));
+  ASSERT_TRUE(cache.NextWarmup(&next));
+  EXPECT_EQ(next, Address(3));
+
+  // The worker saw an empty queue and stopped; the next one starts anew
+  EXPECT_FALSE(cache.NextWarmup(&next));
+  EXPECT_TRUE(cache.QueueWarmup(Address(4)));
+}
+
+TEST(SdpServiceCacheTest, SkipsWarmupsForKnownDevices) {
+  SdpServiceCache cache(4, 4);
+  cache.Record(Address(1), Fallback(0));
+  EXPECT_FALSE(cache.QueueWarmup(Address(1)));
+  BdAddr next;
+  EXPECT_FALSE(cache.NextWarmup(&next));
+}
+
+TEST(SdpServiceCacheTest, QueuesAtMostMaxQueuedWarmups) {
+  SdpServiceCache cache(8, 2);
+  EXPECT_TRUE(cache.QueueWarmup(Address(1)));
+  cache.QueueWarmup(Address(2));
+  cache.QueueWarmup(Address(3));
+
+  BdAddr next;
+  ASSERT_TRUE(cache.NextWarmup(&next));
+  EXPECT_EQ(next, Address(1));
+  ASSERT_TRUE(cache.NextWarmup(&next));
+  EXPECT_EQ(next, Address(2));
+  EXPECT_FALSE(cache.NextWarmup(&next));
+
+  // Dropped, not deferred: it can be queued again once there is room
+  EXPECT_TRUE(cache.QueueWarmup(Address(3)));
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
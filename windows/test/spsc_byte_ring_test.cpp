@@ -0,0 +1,234 @@
+#include "spsc_byte_ring.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+std::vector<uint8_t> Bytes(std::initializer_list<int> values) {
+  std::vector<uint8_t> bytes;
+  for (int value : values) {
+    bytes.push_back(static_cast<uint8_t>(value));
+  }
+  return bytes;
+}
+
+std::vector<uint8_t> PeekAll(SpscByteRing& ring) {
+  SpscByteRing::Span span = ring.Peek();
+  return std::vector<uint8_t>(span.data, span.data + span.size);
+}
+
+TEST(SpscByteRingTest, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(SpscByteRing(1).capacity(), 1u);
+  EXPECT_EQ(SpscByteRing(5).capacity(), 8u);
+  EXPECT_EQ(SpscByteRing(64).capacity(), 64u);
+  EXPECT_EQ(SpscByteRing(65).capacity(), 128u);
+}
+
+TEST(SpscByteRingTest, EmptyRingPeeksNothing) {
+  SpscByteRing ring(16);
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_EQ(ring.Peek().size, 0u);
+}
+
+TEST(SpscByteRingTest, ReadsBackWhatWasWritten) {
+  SpscByteRing ring(16);
+  const std::vector<uint8_t> first = Bytes({1, 2, 3});
+  const std::vector<uint8_t> second = Bytes({4, 5});
+  ASSERT_TRUE(ring.TryWrite(first.data(), first.size()));
+  ASSERT_TRUE(ring.TryWrite(second.data(), second.size()));
+  EXPECT_EQ(ring.Size(), 5u);
+
+  // Queued writes come back as one contiguous span
+  EXPECT_EQ(PeekAll(ring), Bytes({1, 2, 3, 4, 5}));
+  ring.Consume(5);
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(SpscByteRingTest, ZeroSizeWriteIsANoOp) {
+  SpscByteRing ring(4);
+  EXPECT_TRUE(ring.TryWrite(nullptr, 0));
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(SpscByteRingTest, AcceptsExactlyCapacity) {
+  SpscByteRing ring(8);
+  const std::vector<uint8_t> data = Bytes({0, 1, 2, 3, 4, 5, 6, 7});
+  ASSERT_TRUE(ring.TryWrite(data.data(), data.size()));
+  EXPECT_EQ(ring.Size(), 8u);
+  EXPECT_EQ(PeekAll(ring), data);
+
+  const uint8_t one = 9;
+  EXPECT_FALSE(ring.TryWrite(&one, 1));
+}
+
+TEST(SpscByteRingTest, RejectsWriteThatDoesNotFitWhole) {
+  SpscByteRing ring(8);
+  const std::vector<uint8_t> six = Bytes({1, 2, 3, 4, 5, 6});
+  const std::vector<uint8_t> three = Bytes({7, 8, 9});
+  ASSERT_TRUE(ring.TryWrite(six.data(), six.size()));
+
+  // All or nothing: two bytes are free, so none of the three are taken
+  EXPECT_FALSE(ring.TryWrite(three.data(), three.size()));
+  EXPECT_EQ(ring.Size(), 6u);
+  ASSERT_TRUE(ring.TryWrite(three.data(), 2));
+  EXPECT_EQ(PeekAll(ring), Bytes({1, 2, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST(SpscByteRingTest, ConsumingFreesSpaceForTheProducer) {
+  SpscByteRing ring(4);
+  const std::vector<uint8_t> data = Bytes({1, 2, 3, 4});
+  ASSERT_TRUE(ring.TryWrite(data.data(), data.size()));
+  const uint8_t five = 5;
+  EXPECT_FALSE(ring.TryWrite(&five, 1));
+  ring.Consume(1);
+  EXPECT_TRUE(ring.TryWrite(&five, 1));
+}
+
+TEST(SpscByteRingTest, PartialConsumeKeepsTheRest) {
+  SpscByteRing ring(16);
+  const std::vector<uint8_t> data = Bytes({1, 2, 3, 4, 5});
+  ASSERT_TRUE(ring.TryWrite(data.data(), data.size()));
+  ring.Consume(2);
+  EXPECT_EQ(ring.Size(), 3u);
+  EXPECT_EQ(PeekAll(ring), Bytes({3, 4, 5}));
+}
+
+TEST(SpscByteRingTest, WrapsAroundInTwoSpans) {
+  SpscByteRing ring(8);
+  const std::vector<uint8_t> fill = Bytes({0, 0, 0, 0, 0, 0});
+  ASSERT_TRUE(ring.TryWrite(fill.data(), fill.size()));
+  ring.Consume(6);
+
+  // Starts at offset 6: two bytes before the end, three after the wrap
+  const std::vector<uint8_t> data = Bytes({1, 2, 3, 4, 5});
+  ASSERT_TRUE(ring.TryWrite(data.data(), data.size()));
+  EXPECT_EQ(ring.Size(), 5u);
+  EXPECT_EQ(PeekAll(ring), Bytes({1, 2}));
+  ring.Consume(2);
+  EXPECT_EQ(PeekAll(ring), Bytes({3, 4, 5}));
+  ring.Consume(3);
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(SpscByteRingTest, FillsAgainAfterWrapping) {
+  SpscByteRing ring(8);
+  std::vector<uint8_t> data(5);
+  for (int round = 0; round < 10; ++round) {
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<uint8_t>(round * 16 + i);
+    }
+    ASSERT_TRUE(ring.TryWrite(data.data(), data.size()));
+    std::vector<uint8_t> read;
+    while (!ring.Empty()) {
+      std::vector<uint8_t> span = PeekAll(ring);
+      read.insert(read.end(), span.begin(), span.end());
+      ring.Consume(span.size());
+    }
+    EXPECT_EQ(read, data) << "round " << round;
+  }
+}
+
+TEST(SpscByteRingTest, ConsumeCountsWritesOnlyWhenAsked) {
+  SpscByteRing ring(16);
+  const std::vector<uint8_t> data = Bytes({1, 2, 3});
+  ASSERT_TRUE(ring.TryWrite(data.data(), data.size()));
+  ring.Peek();
+  EXPECT_EQ(ring.Consume(3), 0u);
+}
+
+TEST(SpscByteRingTest, ConsumeCountsWritesThatEndInsideIt) {
+  SpscByteRing ring(16, /*count_writes=*/true);
+  const std::vector<uint8_t> a = Bytes({1, 2, 3});
+  const std::vector<uint8_t> b = Bytes({4, 5});
+  const std::vector<uint8_t> c = Bytes({6, 7, 8, 9});
+  ASSERT_TRUE(ring.TryWrite(a.data(), a.size()));
+  ASSERT_TRUE(ring.TryWrite(b.data(), b.size()));
+  ASSERT_TRUE(ring.TryWrite(c.data(), c.size()));
+
+  ring.Peek();
+  // a ends at byte 3; b is split and counts once its last byte goes
+  EXPECT_EQ(ring.Consume(4), 1u);
+  EXPECT_EQ(ring.Consume(3), 1u);
+  EXPECT_EQ(ring.Consume(2), 1u);
+  EXPECT_TRUE(ring.Empty());
+}
+
+TEST(SpscByteRingTest, CountsWritesAcrossTheWrap) {
+  SpscByteRing ring(8, /*count_writes=*/true);
+  for (int round = 0; round < 20; ++round) {
+    const std::vector<uint8_t> first = Bytes({1, 2, 3});
+    const std::vector<uint8_t> second = Bytes({4, 5});
+    ASSERT_TRUE(ring.TryWrite(first.data(), first.size()));
+    ASSERT_TRUE(ring.TryWrite(second.data(), second.size()));
+    size_t ended = 0;
+    while (!ring.Empty()) {
+      ended += ring.Consume(ring.Peek().size);
+    }
+    EXPECT_EQ(ended, 2u) << "round " << round;
+  }
+}
+
+// One producer and one consumer hammer a small ring with odd-sized writes
+// and partial consumes, so every boundary (full, empty, wrap) is crossed
+// many times. The byte stream must arrive complete and in order.
+TEST(SpscByteRingTest, ProducerAndConsumerThreadsKeepOrder) {
+  constexpr size_t kTotalBytes = 8 * 1024 * 1024;
+  SpscByteRing ring(64, /*count_writes=*/true);
+  size_t writes = 0;
+
+  std::thread producer([&ring, &writes]() {
+    uint8_t chunk[37];
+    size_t sent = 0;
+    size_t size = 1;
+    while (sent < kTotalBytes) {
+      size = size % sizeof(chunk) + 1;
+      if (size > kTotalBytes - sent) {
+        size = kTotalBytes - sent;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        chunk[i] = static_cast<uint8_t>((sent + i) * 7);
+      }
+      while (!ring.TryWrite(chunk, size)) {
+        std::this_thread::yield();
+      }
+      sent += size;
+      ++writes;
+    }
+  });
+
+  size_t received = 0;
+  size_t mismatches = 0;
+  size_t ended = 0;
+  size_t step = 0;
+  while (received < kTotalBytes) {
+    SpscByteRing::Span span = ring.Peek();
+    if (span.size == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    // Take only part of the span now and then
+    step = step % 5 + 1;
+    const size_t take = span.size > step ? span.size - step / 2 : span.size;
+    for (size_t i = 0; i < take; ++i) {
+      if (span.data[i] != static_cast<uint8_t>((received + i) * 7)) {
+        ++mismatches;
+      }
+    }
+    ended += ring.Consume(take);
+    received += take;
+  }
+  producer.join();
+
+  EXPECT_EQ(mismatches, 0u);
+  EXPECT_EQ(received, kTotalBytes);
+  EXPECT_EQ(ended, writes);
+  EXPECT_TRUE(ring.Empty());
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
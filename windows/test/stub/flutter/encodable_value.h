@@ -0,0 +1,131 @@
+// Test stand-in for the Flutter client wrapper's encodable_value.h, so the
+// native tests build without a Flutter SDK. Same type names, variant layout
+// and ordering as the real header for the parts the plugin uses. Configure
+// with -DFLUTTER_CLIENT_WRAPPER_DIR=<wrapper include dir> to build against
+// the real one instead.
+#ifndef FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_H_
+#define FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_H_
+
+#include <algorithm>
+#include <any>
+#include <functional>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace flutter {
+
+class EncodableValue;
+
+}  // namespace flutter
+
+// Declared before EncodableMap is instantiated, which fixes its comparator.
+template <>
+struct std::less<flutter::EncodableValue> {
+  bool operator()(const flutter::EncodableValue& lhs, const flutter::EncodableValue& rhs) const;
+};
+
+namespace flutter {
+
+using EncodableList = std::vector<EncodableValue>;
+using EncodableMap = std::map<EncodableValue, EncodableValue>;
+
+class CustomEncodableValue {
+ public:
+  explicit CustomEncodableValue(const std::any& value) : value_(value) {}
+
+  operator std::any&() { return value_; }
+  operator const std::any&() const { return value_; }
+
+  // Identity ordering, as in the real wrapper
+  bool operator<(const CustomEncodableValue& other) const { return this < &other; }
+  bool operator==(const CustomEncodableValue& other) const { return this == &other; }
+
+ private:
+  std::any value_;
+};
+
+namespace internal {
+using EncodableValueVariant = std::variant<std::monostate,
+                                           bool,
+                                           int32_t,
+                                           int64_t,
+                                           double,
+                                           std::string,
+                                           std::vector<uint8_t>,
+                                           std::vector<int32_t>,
+                                           std::vector<int64_t>,
+                                           std::vector<double>,
+                                           EncodableList,
+                                           EncodableMap,
+                                           CustomEncodableValue,
+                                           std::vector<float>>;
+}  // namespace internal
+
+class EncodableValue : public internal::EncodableValueVariant {
+ public:
+  using super = internal::EncodableValueVariant;
+  using super::super;
+  using super::operator=;
+
+  EncodableValue() = default;
+
+  // Keeps string literals from converting to bool
+  explicit EncodableValue(const char* string) : super(std::string(string)) {}
+  EncodableValue& operator=(const char* other) {
+    *this = std::string(other);
+    return *this;
+  }
+
+  bool IsNull() const { return std::holds_alternative<std::monostate>(*this); }
+
+  int64_t LongValue() const {
+    if (std::holds_alternative<int32_t>(*this)) {
+      return std::get<int32_t>(*this);
+    }
+    return std::get<int64_t>(*this);
+  }
+
+  // Map-key ordering: type index first, then value. A named function
+  // rather than operator<, because GCC cannot check the C++20 comparison
+  // constraints of a variant that contains itself.
+  static bool Less(const EncodableValue& lhs, const EncodableValue& rhs) {
+    if (lhs.index() != rhs.index()) {
+      return lhs.index() < rhs.index();
+    }
+    return std::visit(
+        [&rhs](const auto& left) -> bool {
+          using T = std::decay_t<decltype(left)>;
+          const T& right = std::get<T>(rhs);
+          if constexpr (std::is_same_v<T, std::monostate>) {
+            return false;
+          } else if constexpr (std::is_same_v<T, EncodableList>) {
+            return std::lexicographical_compare(left.begin(), left.end(), right.begin(),
+                                                right.end(), &EncodableValue::Less);
+          } else if constexpr (std::is_same_v<T, EncodableMap>) {
+            return std::lexicographical_compare(
+                left.begin(), left.end(), right.begin(), right.end(),
+                [](const auto& a, const auto& b) {
+                  return Less(a.first, b.first) ||
+                         (!Less(b.first, a.first) && Less(a.second, b.second));
+                });
+          } else {
+            return left < right;
+          }
+        },
+        static_cast<const super&>(lhs));
+  }
+};
+
+}  // namespace flutter
+
+inline bool std::less<flutter::EncodableValue>::operator()(
+    const flutter::EncodableValue& lhs, const flutter::EncodableValue& rhs) const {
+  return flutter::EncodableValue::Less(lhs, rhs);
+}
+
+#endif  // FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_ENCODABLE_VALUE_H_
@@ -0,0 +1,45 @@
+// Test stand-in for the Flutter client wrapper's event_sink.h (see
+// encodable_value.h). Same interface as the real header.
+#ifndef FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_EVENT_SINK_H_
+#define FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_EVENT_SINK_H_
+
+#include <string>
+
+#include "encodable_value.h"
+
+namespace flutter {
+
+template <typename T = EncodableValue>
+class EventSink {
+ public:
+  EventSink() = default;
+  virtual ~EventSink() = default;
+
+  EventSink(EventSink const&) = delete;
+  EventSink& operator=(EventSink const&) = delete;
+
+  void Success(const T& event) { SuccessInternal(&event); }
+  void Success() { SuccessInternal(nullptr); }
+
+  void Error(const std::string& error_code,
+             const std::string& error_message,
+             const T& error_details) {
+    ErrorInternal(error_code, error_message, &error_details);
+  }
+  void Error(const std::string& error_code, const std::string& error_message = "") {
+    ErrorInternal(error_code, error_message, nullptr);
+  }
+
+  void EndOfStream() { EndOfStreamInternal(); }
+
+ protected:
+  virtual void SuccessInternal(const T* event = nullptr) = 0;
+  virtual void ErrorInternal(const std::string& error_code,
+                             const std::string& error_message,
+                             const T* error_details) = 0;
+  virtual void EndOfStreamInternal() = 0;
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_SHELL_PLATFORM_COMMON_CLIENT_WRAPPER_INCLUDE_FLUTTER_EVENT_SINK_H_
@@ -0,0 +1,177 @@
+// Sustained sendData rate of an RFCOMM link: the drain job on the shared
+// worker pool (WriteQueue, as BluetoothConnection runs it) against a thread
+// created and joined for every write, which is what WriteData did before.
+//
+// The link is a pseudo terminal; a flush is write() plus tcdrain(), standing
+// in for WriteBytes() plus StoreAsync().get(). Each iteration sends a burst
+// of 32-byte messages and waits until every one has completed and the
+// device has read them. Counters: messages per second (items_per_second)
+// and the time the caller spends inside WriteData (caller_us_per_write).
+#include "pty.h"
+#include "worker_pool.h"
+#include "write_queue.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+constexpr size_t kMessageSize = 32;
+constexpr size_t kBurst = 64;
+
+int OpenRawSlave(const Pty& pty) {
+  const int fd = open(pty.slave_path().c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+  termios settings;
+  tcgetattr(fd, &settings);
+  cfmakeraw(&settings);
+  tcsetattr(fd, TCSANOW, &settings);
+  return fd;
+}
+
+bool Flush(int fd, const std::vector<uint8_t>& data) {
+  size_t offset = 0;
+  while (offset < data.size()) {
+    const ssize_t n = write(fd, data.data() + offset, data.size() - offset);
+    if (n <= 0) {
+      return false;
+    }
+    offset += static_cast<size_t>(n);
+  }
+  return tcdrain(fd) == 0;
+}
+
+// Counts completed writes and wakes the benchmark thread.
+class Completions {
+ public:
+  void Add() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++completed_;
+    }
+    cv_.notify_one();
+  }
+
+  void WaitFor(size_t total) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&]() { return completed_ >= total; });
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t completed_ = 0;
+};
+
+// BluetoothConnection's write path with the socket swapped for the pty.
+class DrainJobLink : public std::enable_shared_from_this<DrainJobLink> {
+ public:
+  DrainJobLink(const Pty& pty, WorkerPool* workers)
+      : fd_(OpenRawSlave(pty)), workers_(workers), pending_writes_(TransportOptions()) {}
+  ~DrainJobLink() { close(fd_); }
+
+  void WriteData(const std::vector<uint8_t>& data, WriteQueue::Callback on_complete) {
+    SendQueueBudget::Transition transition;
+    bool schedule_drain = false;
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      if (!pending_writes_.Push(data, std::move(on_complete), &transition, &schedule_drain)) {
+        return;
+      }
+    }
+    if (schedule_drain) {
+      auto self = shared_from_this();
+      workers_->Post([self]() { self->Drain(); });
+    }
+  }
+
+ private:
+  void Drain() {
+    while (true) {
+      std::optional<WriteQueue::Write> next;
+      {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        next = pending_writes_.Pop();
+      }
+      if (!next) {
+        return;
+      }
+      const bool flushed = Flush(fd_, next->data);
+      next->on_complete(flushed, "");
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      pending_writes_.Release(next->data.size());
+    }
+  }
+
+  int fd_;
+  WorkerPool* workers_;
+  std::mutex write_mutex_;
+  WriteQueue pending_writes_;
+};
+
+// The old WriteData: a thread per write, joined before returning.
+class ThreadPerWriteLink {
+ public:
+  explicit ThreadPerWriteLink(const Pty& pty) : fd_(OpenRawSlave(pty)) {}
+  ~ThreadPerWriteLink() { close(fd_); }
+
+  void WriteData(const std::vector<uint8_t>& data, WriteQueue::Callback on_complete) {
+    bool flushed = false;
+    std::thread writer([&]() { flushed = Flush(fd_, data); });
+    writer.join();
+    on_complete(flushed, "");
+  }
+
+ private:
+  int fd_;
+};
+
+template <typename Link>
+void RunSendRate(benchmark::State& state, Link* link, Pty* pty) {
+  const std::vector<uint8_t> message(kMessageSize, 0x5a);
+  Completions completions;
+  size_t sent = 0;
+  double caller_seconds = 0;
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kBurst; ++i) {
+      link->WriteData(message, [&completions](bool, const std::string&) { completions.Add(); });
+    }
+    caller_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sent += kBurst;
+    completions.WaitFor(sent);
+    benchmark::DoNotOptimize(pty->Read(kBurst * kMessageSize));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(sent));
+  state.counters["caller_us_per_write"] = 1e6 * caller_seconds / static_cast<double>(sent);
+}
+
+void BM_SendRate_DrainJob(benchmark::State& state) {
+  Pty pty;
+  WorkerPool workers(WorkerPool::DefaultThreadCount());
+  auto link = std::make_shared<DrainJobLink>(pty, &workers);
+  RunSendRate(state, link.get(), &pty);
+}
+BENCHMARK(BM_SendRate_DrainJob)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+void BM_SendRate_ThreadPerWrite(benchmark::State& state) {
+  Pty pty;
+  ThreadPerWriteLink link(pty);
+  RunSendRate(state, &link, &pty);
+}
+BENCHMARK(BM_SendRate_ThreadPerWrite)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
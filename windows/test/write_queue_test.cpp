@@ -0,0 +1,86 @@
+#include "write_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+TransportOptions SmallBudget() {
+  TransportOptions options;
+  options.send_queue_max_bytes = 8;
+  options.send_queue_high_watermark_bytes = 6;
+  options.send_queue_low_watermark_bytes = 2;
+  return options;
+}
+
+TEST(WriteQueueTest, OnlyTheFirstPushOfABurstStartsADrain) {
+  WriteQueue queue{TransportOptions()};
+  SendQueueBudget::Transition transition;
+  bool start_drain = false;
+  ASSERT_TRUE(queue.Push({1}, nullptr, &transition, &start_drain));
+  EXPECT_TRUE(start_drain);
+  ASSERT_TRUE(queue.Push({2}, nullptr, &transition, &start_drain));
+  EXPECT_FALSE(start_drain);
+
+  EXPECT_EQ(queue.Pop()->data, std::vector<uint8_t>{1});
+  EXPECT_EQ(queue.Pop()->data, std::vector<uint8_t>{2});
+  EXPECT_FALSE(queue.Pop().has_value());
+
+  // The drain job ended with the queue; the next write needs a new one
+  ASSERT_TRUE(queue.Push({3}, nullptr, &transition, &start_drain));
+  EXPECT_TRUE(start_drain);
+}
+
+TEST(WriteQueueTest, EndDrainLetsTheNextPushStartOne) {
+  WriteQueue queue{TransportOptions()};
+  SendQueueBudget::Transition transition;
+  bool start_drain = false;
+  ASSERT_TRUE(queue.Push({1}, nullptr, &transition, &start_drain));
+  queue.EndDrain();
+  ASSERT_TRUE(queue.Push({2}, nullptr, &transition, &start_drain));
+  EXPECT_TRUE(start_drain);
+  EXPECT_EQ(queue.size(), 2u);
+}
+
+TEST(WriteQueueTest, RejectsWritesPastTheBudgetAndReportsWatermarks) {
+  WriteQueue queue(SmallBudget());
+  SendQueueBudget::Transition transition;
+  bool start_drain = false;
+  ASSERT_TRUE(queue.Push({1, 2, 3, 4, 5, 6}, nullptr, &transition, &start_drain));
+  EXPECT_EQ(transition, SendQueueBudget::Transition::kBackpressure);
+  EXPECT_FALSE(queue.Push({1, 2, 3}, nullptr, &transition, &start_drain));
+  EXPECT_EQ(queue.size(), 1u);
+  EXPECT_EQ(queue.queued_bytes(), 6u);
+
+  std::optional<WriteQueue::Write> write = queue.Pop();
+  ASSERT_TRUE(write.has_value());
+  EXPECT_EQ(queue.Release(write->data.size()), SendQueueBudget::Transition::kWritable);
+  EXPECT_EQ(queue.queued_bytes(), 0u);
+}
+
+TEST(WriteQueueTest, TakeAllHandsBackEveryWriteAndKeepsTheDrainScheduled) {
+  WriteQueue queue(SmallBudget());
+  SendQueueBudget::Transition transition;
+  bool start_drain = false;
+  std::vector<std::string> errors;
+  for (uint8_t i = 0; i < 3; ++i) {
+    ASSERT_TRUE(queue.Push({i, i}, [&errors](bool, const std::string& error) { errors.push_back(error); },
+                           &transition, &start_drain));
+  }
+  for (auto& write : queue.TakeAll()) {
+    write.on_complete(false, "DISCONNECTED");
+  }
+  EXPECT_EQ(errors, std::vector<std::string>(3, "DISCONNECTED"));
+  EXPECT_EQ(queue.queued_bytes(), 0u);
+
+  // A failed writer stays scheduled, so nothing starts another drain
+  ASSERT_TRUE(queue.Push({7}, nullptr, &transition, &start_drain));
+  EXPECT_FALSE(start_drain);
+}
+
+}  // namespace
+}  // namespace flutter_bluetooth_classic
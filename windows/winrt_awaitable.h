@@ -0,0 +1,89 @@
+#ifndef FLUTTER_PLUGIN_WINRT_AWAITABLE_H_
+#define FLUTTER_PLUGIN_WINRT_AWAITABLE_H_
+
+#include <winrt/Windows.Foundation.h>
+
+#include <coroutine>
+#include <utility>
+
+#include "async_task.h"
+#include "worker_pool.h"
+
+namespace flutter_bluetooth_classic {
+
+// Suspends a Task on a WinRT IAsyncOperation/IAsyncAction.
+//
+// The coroutine resumes on a pool worker rather than on the WinRT
+// completion thread, and cancelling the token cancels the operation itself,
+// so a cancelled or timed-out chain stops at the step it is waiting on.
+template <typename TAsync>
+class WinRtAwaiter {
+ public:
+  WinRtAwaiter(TAsync operation, WorkerPool* workers, CancellationToken cancel)
+      : operation_(std::move(operation)), workers_(workers), cancel_(std::move(cancel)) {}
+
+  bool await_ready() const {
+    return cancel_.IsCancelled() ||
+           operation_.Status() != winrt::Windows::Foundation::AsyncStatus::Started;
+  }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    // Both callbacks hold their own reference: the frame that owns
+    // operation_ may be gone by the time they return.
+    TAsync operation = operation_;
+    registration_ = cancel_.OnCancel([operation]() { CancelOperation(operation); });
+    WorkerPool* workers = workers_;
+    bool* pool_stopped = &pool_stopped_;
+    operation.Completed([handle, workers, pool_stopped](auto const&,
+                                                         winrt::Windows::Foundation::AsyncStatus) {
+      // A shutting-down pool takes no more jobs; resume here so the task
+      // still completes. The frame, and with it pool_stopped, is alive
+      // until then.
+      if (!workers->Post([handle]() { handle.resume(); })) {
+        *pool_stopped = true;
+        handle.resume();
+      }
+    });
+  }
+
+  auto await_resume() {
+    registration_.Reset();
+    if (pool_stopped_) {
+      throw OperationCancelled("SHUTDOWN");
+    }
+    if (cancel_.IsCancelled()) {
+      // A token cancelled before the await never registered the callback
+      // above, so the operation is cancelled here; a second Cancel on one
+      // that already stopped is harmless.
+      CancelOperation(operation_);
+      cancel_.ThrowIfCancelled();
+    }
+    return operation_.GetResults();
+  }
+
+ private:
+  static void CancelOperation(const TAsync& operation) {
+    try {
+      operation.Cancel();
+    } catch (...) {
+      // Already completed
+    }
+  }
+
+  TAsync operation_;
+  WorkerPool* workers_;
+  CancellationToken cancel_;
+  CancellationRegistration registration_;
+  bool pool_stopped_ = false;
+};
+
+// co_await AwaitWinRt(op, workers, token) inside a Task.
+template <typename TAsync>
+WinRtAwaiter<TAsync> AwaitWinRt(TAsync operation, WorkerPool* workers,
+                                CancellationToken cancel = CancellationToken()) {
+  return WinRtAwaiter<TAsync>(std::move(operation), workers, std::move(cancel));
+}
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_WINRT_AWAITABLE_H_
@@ -0,0 +1,142 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace flutter_bluetooth_classic {
+namespace {
+
+thread_local const WorkerPool* current_worker_pool = nullptr;
+
+}  // namespace
+
+WorkerPool::WorkerPool(size_t thread_count,
+                       std::function<void()> on_thread_start,
+                       std::function<void()> on_thread_stop)
+    : on_thread_start_(std::move(on_thread_start)),
+      on_thread_stop_(std::move(on_thread_stop)) {
+  threads_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back([this]() { WorkerMain(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  Shutdown();
+}
+
+bool WorkerPool::Post(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopping_) {
+      ready_.push_back(std::move(task));
+      cv_.notify_one();
+      return true;
+    }
+  }
+  // Destroy the rejected task outside the lock; it may own the last
+  // reference to an object whose destructor posts again.
+  task = nullptr;
+  return false;
+}
+
+bool WorkerPool::PostAfter(Clock::duration delay, Task task) {
+  const Clock::time_point deadline = Clock::now() + delay;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopping_) {
+      timers_.emplace(deadline, std::move(task));
+      // The earliest deadline may have changed; every idle worker re-arms.
+      cv_.notify_all();
+      return true;
+    }
+  }
+  task = nullptr;
+  return false;
+}
+
+void WorkerPool::Shutdown() {
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ && threads_.empty()) {
+      return;
+    }
+    stopping_ = true;
+  }
+  cv_.notify_all();
+
+  // threads_ is only resized here and in the constructor.
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  std::multimap<Clock::time_point, Task> dropped_timers;
+  std::deque<Task> dropped_tasks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads.swap(threads_);
+    dropped_timers.swap(timers_);
+    dropped_tasks.swap(ready_);
+  }
+}
+
+bool WorkerPool::IsWorkerThread() const {
+  return current_worker_pool == this;
+}
+
+size_t WorkerPool::DefaultThreadCount() {
+  const size_t cores = std::thread::hardware_concurrency();
+  return std::max<size_t>(4, cores);
+}
+
+void WorkerPool::WorkerMain() {
+  current_worker_pool = this;
+  if (on_thread_start_) {
+    on_thread_start_();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    const Clock::time_point now = Clock::now();
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+      ready_.push_back(std::move(timers_.begin()->second));
+      timers_.erase(timers_.begin());
+    }
+
+    if (!ready_.empty()) {
+      Task task = std::move(ready_.front());
+      ready_.pop_front();
+      lock.unlock();
+      try {
+        task();
+      } catch (...) {
+        // A failing job must not take the worker down with it.
+      }
+      task = nullptr;
+      lock.lock();
+      continue;
+    }
+
+    if (stopping_) {
+      break;
+    }
+    if (timers_.empty()) {
+      cv_.wait(lock);
+    } else {
+      // Copied: another worker may erase the timer while this one waits.
+      const Clock::time_point deadline = timers_.begin()->first;
+      cv_.wait_until(lock, deadline);
+    }
+  }
+  lock.unlock();
+
+  if (on_thread_stop_) {
+    on_thread_stop_();
+  }
+  current_worker_pool = nullptr;
+}
+
+}  // namespace flutter_bluetooth_classic
@@ -0,0 +1,80 @@
+#ifndef FLUTTER_PLUGIN_WORKER_POOL_H_
+#define FLUTTER_PLUGIN_WORKER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flutter_bluetooth_classic {
+
+// Fixed set of threads shared by every connection and manager call.
+//
+// Transports post short jobs (drain the send queue, handle a completed
+// read) instead of parking a thread per direction per link, so the thread
+// count follows the core count rather than the number of connections.
+// Tasks awaiting WinRT operations resume here as well instead of blocking
+// a thread per call.
+// Nothing in here is Windows-specific; the owner passes thread hooks to set
+// up the apartment.
+class WorkerPool {
+ public:
+  using Task = std::function<void()>;
+  using Clock = std::chrono::steady_clock;
+
+  // on_thread_start/on_thread_stop run once on every worker, before the
+  // first and after the last task.
+  WorkerPool(size_t thread_count,
+             std::function<void()> on_thread_start = nullptr,
+             std::function<void()> on_thread_stop = nullptr);
+
+  // Calls Shutdown().
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Runs task on some worker as soon as one is free. Once Shutdown has
+  // started the task is destroyed instead and this returns false.
+  bool Post(Task task);
+
+  // Runs task on some worker once delay has elapsed. Same return as Post.
+  bool PostAfter(Clock::duration delay, Task task);
+
+  // Finishes every task that is already runnable, drops pending timers and
+  // joins the workers. Later posts are discarded, including ones made by the
+  // tasks being finished, so a job that reposts itself cannot hold shutdown
+  // up. Must not be called from a worker.
+  void Shutdown();
+
+  // True when the caller is one of this pool's workers. Code that would
+  // block on another pool task checks this first.
+  bool IsWorkerThread() const;
+
+  size_t thread_count() const { return threads_.size(); }
+
+  // Enough workers that a few blocking connects do not starve I/O jobs.
+  static size_t DefaultThreadCount();
+
+ private:
+  void WorkerMain();
+
+  std::function<void()> on_thread_start_;
+  std::function<void()> on_thread_stop_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Task> ready_;
+  // Keyed by deadline; equal deadlines keep their posting order.
+  std::multimap<Clock::time_point, Task> timers_;
+  bool stopping_ = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_WORKER_POOL_H_
@@ -0,0 +1,86 @@
+#ifndef FLUTTER_PLUGIN_WRITE_QUEUE_H_
+#define FLUTTER_PLUGIN_WRITE_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bluetooth_send_queue_budget.h"
+#include "bluetooth_transport_options.h"
+
+namespace flutter_bluetooth_classic {
+
+// Outbound payloads of one link, flushed in order by a single drain job on
+// the worker pool. Tracks the send budget and whether that job is scheduled.
+// Not thread-safe; the owner calls it under its write lock and runs the
+// flush and the callbacks outside of it.
+class WriteQueue {
+ public:
+  // Invoked once the payload has been flushed (or failed).
+  using Callback = std::function<void(bool success, const std::string& error)>;
+
+  struct Write {
+    std::vector<uint8_t> data;
+    Callback on_complete;
+  };
+
+  explicit WriteQueue(const TransportOptions& options) : budget_(options) {}
+
+  // Queues data unless the budget is exhausted. *start_drain is set when no
+  // drain job is scheduled yet; the caller must then post one.
+  bool Push(const std::vector<uint8_t>& data, Callback on_complete,
+            SendQueueBudget::Transition* transition, bool* start_drain) {
+    if (!budget_.TryReserve(data.size(), transition)) {
+      return false;
+    }
+    writes_.push_back(Write{data, std::move(on_complete)});
+    *start_drain = !drain_scheduled_;
+    drain_scheduled_ = true;
+    return true;
+  }
+
+  // The next write for the drain job. Nothing once the queue is empty, and
+  // the job must then end: the next Push schedules a new one.
+  std::optional<Write> Pop() {
+    if (writes_.empty()) {
+      drain_scheduled_ = false;
+      return std::nullopt;
+    }
+    Write next = std::move(writes_.front());
+    writes_.pop_front();
+    return next;
+  }
+
+  // The drain job ends with writes still queued (the link is closing).
+  void EndDrain() { drain_scheduled_ = false; }
+
+  // Accounts for a payload the link has accepted.
+  SendQueueBudget::Transition Release(size_t bytes) { return budget_.Release(bytes); }
+
+  // Removes every queued write so the owner can fail them. A drain job
+  // that is still scheduled stays so; nothing more is flushed after a
+  // write error.
+  std::deque<Write> TakeAll() {
+    std::deque<Write> all;
+    all.swap(writes_);
+    budget_.Reset();
+    return all;
+  }
+
+  size_t queued_bytes() const { return budget_.queued_bytes(); }
+  size_t size() const { return writes_.size(); }
+
+ private:
+  std::deque<Write> writes_;
+  bool drain_scheduled_ = false;
+  SendQueueBudget budget_;
+};
+
+}  // namespace flutter_bluetooth_classic
+
+#endif  // FLUTTER_PLUGIN_WRITE_QUEUE_H_